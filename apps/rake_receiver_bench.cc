@@ -0,0 +1,320 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+/*
+ * Flowgraph-level throughput benchmark:
+ *
+ *   source (null or repeating noise) -> head [-> multipath_channel_cc]
+ *       -> rake_receiver_cc -> null_sink
+ *
+ * Reports sustained MS/s and process CPU time per sample. The same chain
+ * without the RAKE stage is run as a baseline; its CPU cost per sample is
+ * what the scheduler, source and sink take, reported as scheduler overhead.
+ * --instances runs that many independent chains in one top_block; with
+ * --scaling every power of two up to --instances is measured as well, to
+ * show how throughput scales over cores. Output is JSON on stdout.
+ */
+
+#include <gnuradio/blocks/head.h>
+#include <gnuradio/blocks/null_sink.h>
+#include <gnuradio/blocks/null_source.h>
+#include <gnuradio/blocks/vector_source.h>
+#include <gnuradio/rake_receiver/multipath_channel_cc.h>
+#include <gnuradio/rake_receiver/rake_receiver_cc.h>
+#include <gnuradio/top_block.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <exception>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct options {
+    int fingers = 4;
+    std::vector<int> delays;
+    std::vector<float> gains;
+    int pattern_length = 64;
+    std::string source = "noise";
+    uint64_t samples = 20000000;
+    long buffer_items = 0;
+    int instances = 1;
+    bool scaling = false;
+    std::string kernel = "volk";
+    std::string delay_line_mode = "history";
+    int max_delay = 0;
+    float channel_speed = -1.0f;
+};
+
+// Chip rate of the simulated channel, as in UMTS
+constexpr double channel_sample_rate = 3.84e6;
+
+template <typename T>
+std::vector<T> split_numbers(const std::string& list)
+{
+    std::vector<T> values;
+    size_t start = 0;
+    while (start < list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        std::string item = list.substr(start, end - start);
+        values.push_back(static_cast<T>(std::atof(item.c_str())));
+        start = end + 1;
+    }
+    return values;
+}
+
+void usage(const char* program)
+{
+    std::fprintf(stderr,
+                 "usage: %s [--fingers=N] [--delays=D,..] [--gains=G,..]\n"
+                 "          [--pattern-length=N] [--source=noise|null] [--samples=N]\n"
+                 "          [--buffer-size=ITEMS] [--instances=N] [--scaling]\n"
+                 "          [--kernel=volk|scalar|auto]\n"
+                 "          [--delay-line-mode=history|ring|sparse] [--max-delay=N]\n"
+                 "          [--channel-speed=KMH]\n",
+                 program);
+}
+
+bool parse_options(int argc, char** argv, options& opts)
+{
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        std::string key = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? std::string() : arg.substr(eq + 1);
+        if (key == "--fingers") {
+            opts.fingers = std::atoi(value.c_str());
+        } else if (key == "--delays") {
+            opts.delays = split_numbers<int>(value);
+        } else if (key == "--gains") {
+            opts.gains = split_numbers<float>(value);
+        } else if (key == "--pattern-length") {
+            opts.pattern_length = std::atoi(value.c_str());
+        } else if (key == "--source" && (value == "noise" || value == "null")) {
+            opts.source = value;
+        } else if (key == "--samples") {
+            opts.samples = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (key == "--buffer-size") {
+            opts.buffer_items = std::atol(value.c_str());
+        } else if (key == "--instances") {
+            opts.instances = std::atoi(value.c_str());
+        } else if (key == "--scaling") {
+            opts.scaling = true;
+        } else if (key == "--kernel") {
+            opts.kernel = value;
+        } else if (key == "--delay-line-mode") {
+            opts.delay_line_mode = value;
+        } else if (key == "--max-delay") {
+            opts.max_delay = std::atoi(value.c_str());
+        } else if (key == "--channel-speed") {
+            opts.channel_speed = std::atof(value.c_str());
+        } else {
+            usage(argv[0]);
+            return false;
+        }
+    }
+    if (opts.instances < 1 || opts.samples == 0) {
+        usage(argv[0]);
+        return false;
+    }
+    // Ten samples apart and equal gains unless given
+    if (opts.delays.empty()) {
+        for (int f = 0; f < opts.fingers; f++) {
+            opts.delays.push_back(10 * f);
+        }
+    }
+    if (opts.gains.empty()) {
+        opts.gains.assign(opts.fingers, 1.0f / opts.fingers);
+    }
+    return true;
+}
+
+struct measurement {
+    double wall_s;
+    double cpu_s;
+    uint64_t samples;
+};
+
+gr::basic_block_sptr make_source(const options& opts)
+{
+    if (opts.source == "null") {
+        return gr::blocks::null_source::make(sizeof(gr_complex));
+    }
+    // Long enough that the pattern never lines up with the repetition
+    std::mt19937 rng(42);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    std::vector<gr_complex> data(65537);
+    for (auto& x : data) {
+        x = gr_complex(noise(rng), noise(rng));
+    }
+    return gr::blocks::vector_source_c::make(data, true);
+}
+
+gr::basic_block_sptr make_rake(const options& opts)
+{
+    auto rake = gr::rake_receiver::rake_receiver_cc::make(
+        opts.fingers, opts.delays, opts.gains, opts.pattern_length);
+    std::vector<gr_complex> pattern(opts.pattern_length);
+    std::mt19937 rng(7);
+    for (auto& p : pattern) {
+        p = gr_complex(rng() & 1 ? 1.0f : -1.0f, rng() & 1 ? 1.0f : -1.0f);
+    }
+    rake->set_pattern(pattern);
+    rake->set_kernel(opts.kernel);
+    if (opts.delay_line_mode != "history") {
+        rake->set_delay_line_mode(opts.delay_line_mode, opts.max_delay);
+    }
+    if (opts.buffer_items > 0) {
+        rake->set_min_output_buffer(opts.buffer_items);
+    }
+    return rake;
+}
+
+// Fading channel with a tap at every finger delay, 3 dB apart
+gr::basic_block_sptr make_channel(const options& opts)
+{
+    std::vector<float> gains_db;
+    for (size_t f = 0; f < opts.delays.size(); f++) {
+        gains_db.push_back(-3.0f * f);
+    }
+    return gr::rake_receiver::multipath_channel_cc::make(
+        opts.delays, gains_db, {}, channel_sample_rate, 2.0e9, opts.channel_speed);
+}
+
+// Run `instances` independent chains to completion; with_rake false gives the
+// scheduler baseline
+measurement run(const options& opts, int instances, bool with_rake)
+{
+    auto tb = gr::make_top_block("rake_receiver_bench");
+    for (int i = 0; i < instances; i++) {
+        auto source = make_source(opts);
+        auto head = gr::blocks::head::make(sizeof(gr_complex), opts.samples);
+        auto sink = gr::blocks::null_sink::make(sizeof(gr_complex));
+        if (opts.buffer_items > 0) {
+            head->set_min_output_buffer(opts.buffer_items);
+        }
+        tb->connect(source, 0, head, 0);
+        gr::basic_block_sptr last = head;
+        if (opts.channel_speed >= 0.0f) {
+            auto channel = make_channel(opts);
+            tb->connect(last, 0, channel, 0);
+            last = channel;
+        }
+        if (with_rake) {
+            auto rake = make_rake(opts);
+            tb->connect(last, 0, rake, 0);
+            tb->connect(rake, 0, sink, 0);
+        } else {
+            tb->connect(last, 0, sink, 0);
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::clock_t cpu_start = std::clock();
+    tb->run();
+    measurement m;
+    m.cpu_s = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+    m.wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                   .count();
+    m.samples = opts.samples * instances;
+    return m;
+}
+
+void print_numbers(const char* key, const std::vector<int>& values)
+{
+    std::printf("  \"%s\": [", key);
+    for (size_t i = 0; i < values.size(); i++) {
+        std::printf("%s%d", i ? ", " : "", values[i]);
+    }
+    std::printf("],\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    options opts;
+    if (!parse_options(argc, argv, opts)) {
+        return 2;
+    }
+
+    std::vector<int> counts;
+    if (opts.scaling) {
+        for (int n = 1; n < opts.instances; n *= 2) {
+            counts.push_back(n);
+        }
+    }
+    counts.push_back(opts.instances);
+
+    try {
+        // Bad parameters are reported before any output
+        make_rake(opts);
+        if (opts.channel_speed >= 0.0f) {
+            make_channel(opts);
+        }
+
+        std::printf("{\n  \"fingers\": %d,\n", opts.fingers);
+        print_numbers("delays", opts.delays);
+        std::printf("  \"pattern_length\": %d,\n  \"source\": \"%s\",\n"
+                    "  \"kernel\": \"%s\",\n  \"delay_line_mode\": \"%s\",\n"
+                    "  \"channel_speed_kmh\": %g,\n"
+                    "  \"samples_per_instance\": %llu,\n  \"buffer_items\": %ld,\n"
+                    "  \"runs\": [",
+                    opts.pattern_length,
+                    opts.source.c_str(),
+                    opts.kernel.c_str(),
+                    opts.delay_line_mode.c_str(),
+                    opts.channel_speed,
+                    static_cast<unsigned long long>(opts.samples),
+                    opts.buffer_items);
+
+        double single_msps = 0.0;
+        for (size_t i = 0; i < counts.size(); i++) {
+            measurement baseline = run(opts, counts[i], false);
+            measurement m = run(opts, counts[i], true);
+            double msps = m.samples / m.wall_s / 1e6;
+            double cpu_ns = m.cpu_s * 1e9 / m.samples;
+            double overhead_ns = baseline.cpu_s * 1e9 / baseline.samples;
+            if (counts[i] == 1) {
+                single_msps = msps;
+            }
+            std::printf("%s\n    {\"instances\": %d, \"msps\": %.6g, "
+                        "\"msps_per_instance\": %.6g, \"cpu_ns_per_sample\": %.6g, "
+                        "\"scheduler_overhead_ns_per_sample\": %.6g, "
+                        "\"scheduler_overhead_fraction\": %.4g, "
+                        "\"scaling_efficiency\": ",
+                        i ? "," : "",
+                        counts[i],
+                        msps,
+                        msps / counts[i],
+                        cpu_ns,
+                        overhead_ns,
+                        cpu_ns > 0.0 ? overhead_ns / cpu_ns : 0.0);
+            // Relative to one instance, so only known when that was measured
+            if (single_msps > 0.0) {
+                std::printf("%.4g}", msps / (counts[i] * single_msps));
+            } else {
+                std::printf("null}");
+            }
+            std::fflush(stdout);
+        }
+        std::printf("\n  ]\n}\n");
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "rake_receiver_bench: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
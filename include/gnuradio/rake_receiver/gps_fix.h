@@ -0,0 +1,80 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef INCLUDED_RAKE_RECEIVER_GPS_FIX_H
+#define INCLUDED_RAKE_RECEIVER_GPS_FIX_H
+
+#include <gnuradio/rake_receiver/api.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace gr {
+namespace rake_receiver {
+
+/*!
+ * \brief Navigation data carried by a single GPS record
+ * \ingroup rake_receiver
+ *
+ * Each record type carries a different subset of the fields, so every field
+ * has a bit in \p valid; fields whose bit is clear hold no information.
+ */
+struct RAKE_RECEIVER_API gps_fix {
+    //! Bits of \p valid
+    enum field : uint32_t {
+        has_time = 1u << 0,        //!< time is set
+        has_date = 1u << 1,        //!< time is Unix time, not seconds of day
+        has_position = 1u << 2,    //!< latitude_deg and longitude_deg are set
+        has_altitude = 1u << 3,    //!< altitude_m is set
+        has_speed = 1u << 4,       //!< speed_kmh is set
+        has_course = 1u << 5,      //!< course_deg is set
+        has_mode = 1u << 6,        //!< mode is set
+        has_satellites = 1u << 7,  //!< satellites is set
+        has_hdop = 1u << 8,        //!< hdop is set
+        has_speed_error = 1u << 9, //!< speed_error_kmh is set
+    };
+
+    uint32_t valid = 0;           //!< Set of field bits
+    double time = 0.0;            //!< UTC: Unix time with has_date, else seconds of day
+    double latitude_deg = 0.0;    //!< North positive
+    double longitude_deg = 0.0;   //!< East positive
+    double altitude_m = 0.0;      //!< Above mean sea level where the source says so
+    float speed_kmh = 0.0f;       //!< Ground speed
+    float course_deg = 0.0f;      //!< Course over ground, true north
+    int mode = 0;                 //!< 1 no fix, 2 2D fix, 3 3D fix
+    int satellites = 0;           //!< Satellites used in the solution
+    float hdop = 0.0f;            //!< Horizontal dilution of precision
+    float speed_error_kmh = 0.0f; //!< Speed error estimate
+
+    //! True if all of \p fields are set
+    bool has(uint32_t fields) const { return (valid & fields) == fields; }
+};
+
+/*!
+ * \brief Extract all navigation data from one GPS record in a single pass
+ *
+ * Understands NMEA0183 RMC, GGA and VTG sentences (any talker), GPSD TPV
+ * reports and u-blox UBX NAV-PVT frames.
+ *
+ * \param data Record contents
+ * \param length Number of bytes in \p data
+ * \param fix Filled with the fields the record carries
+ * \return True if the record is one of the supported types
+ */
+RAKE_RECEIVER_API bool parse_gps_fix(const char* data, size_t length, gps_fix& fix);
+
+/*!
+ * \brief Extract all navigation data from a record held in a string
+ */
+RAKE_RECEIVER_API bool parse_gps_fix(const std::string& data, gps_fix& fix);
+
+} // namespace rake_receiver
+} // namespace gr
+
+#endif /* INCLUDED_RAKE_RECEIVER_GPS_FIX_H */
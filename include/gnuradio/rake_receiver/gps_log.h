@@ -0,0 +1,74 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef INCLUDED_RAKE_RECEIVER_GPS_LOG_H
+#define INCLUDED_RAKE_RECEIVER_GPS_LOG_H
+
+#include <gnuradio/rake_receiver/api.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gr {
+namespace rake_receiver {
+
+/*!
+ * \brief Time series of GPS fixes extracted from a recorded log
+ * \ingroup rake_receiver
+ *
+ * One entry per speed-bearing record (RMC, VTG, GPSD TPV) in log order.
+ * The three columns always have the same length.
+ */
+struct RAKE_RECEIVER_API gps_log {
+    //! UTC seconds since the Unix epoch; seconds since midnight if the log
+    //! has not supplied a date yet; NaN if no time has been seen
+    std::vector<double> timestamps;
+    //! Speed in km/h, NaN if the record carried none or a negative, NaN or
+    //! out of range one
+    std::vector<float> speeds_kmh;
+    //! 1 if the receiver flagged the fix as valid and its speed is usable
+    std::vector<uint8_t> valid;
+
+    size_t size() const { return timestamps.size(); }
+};
+
+/*!
+ * \brief Parse a buffer of newline separated NMEA0183 and/or GPSD JSON records
+ *
+ * The buffer is scanned once; lines that carry no speed (GGA, SKY, ...) only
+ * update the running time base. Binary u-blox UBX NAV-PVT frames may be
+ * interleaved with the text records; other UBX messages are skipped.
+ *
+ * \param data Pointer to the log contents
+ * \param length Number of bytes in \p data
+ * \return Extracted time series
+ */
+RAKE_RECEIVER_API gps_log parse_gps_log(const char* data, size_t length);
+
+/*!
+ * \brief Parse a log held in a string
+ *
+ * \param data Log contents
+ * \return Extracted time series
+ */
+RAKE_RECEIVER_API gps_log parse_gps_log(const std::string& data);
+
+/*!
+ * \brief Memory-map a log file and parse it
+ *
+ * \param path Path of the log file
+ * \return Extracted time series
+ */
+RAKE_RECEIVER_API gps_log parse_gps_log_file(const std::string& path);
+
+} // namespace rake_receiver
+} // namespace gr
+
+#endif /* INCLUDED_RAKE_RECEIVER_GPS_LOG_H */
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef INCLUDED_RAKE_RECEIVER_MULTIPATH_CHANNEL_CC_H
+#define INCLUDED_RAKE_RECEIVER_MULTIPATH_CHANNEL_CC_H
+
+#include <gnuradio/rake_receiver/api.h>
+#include <gnuradio/sync_block.h>
+#include <gnuradio/gr_complex.h>
+#include <cstdint>
+
+namespace gr {
+namespace rake_receiver {
+
+/*!
+ * \brief Mobile multipath fading channel
+ * \ingroup rake_receiver
+ *
+ * A tapped delay line whose taps fade independently:
+ *
+ *   out[n] = sum_k h_k[n] * in[n - delays[k]]
+ *
+ * Each h_k is Rayleigh (K = 0) or Rician sum-of-sinusoids Jakes fading with
+ * mean power gains_db[k]. The maximum Doppler frequency follows the speed:
+ * f_D = speed / c * carrier_freq. The speed is set by set_speed(), by a
+ * message on the "speed" port (a number, a (speed_kmh . value) pair or a
+ * dict with speed_kmh, all in km/h), or by a replayed GPS log.
+ *
+ * Whenever the speed changes, the block tags the output sample where the new
+ * speed takes effect with "gps_speed" (km/h). A downstream rake_receiver_cc
+ * then adapts to the true speed at the matching sample.
+ *
+ * The fading is computed on a grid of at least 32 points per Doppler period
+ * and linearly interpolated in between, so the cost per sample is one
+ * complex multiply-accumulate per tap.
+ */
+class RAKE_RECEIVER_API multipath_channel_cc : virtual public gr::sync_block
+{
+public:
+    typedef std::shared_ptr<multipath_channel_cc> sptr;
+
+    /*!
+     * \brief Return a shared_ptr to a new instance of rake_receiver::multipath_channel_cc.
+     *
+     * \param delays Delay of each tap (in samples)
+     * \param gains_db Mean power of each tap (dB)
+     * \param k_factors Rician K factor of each tap (linear, 0 for Rayleigh);
+     *        empty for all Rayleigh
+     * \param sample_rate Sample rate (Hz)
+     * \param carrier_freq Carrier frequency (Hz)
+     * \param speed_kmh Initial speed (km/h)
+     * \param num_sinusoids Sinusoids per tap and quadrature branch
+     * \param seed Seed of the fading; 0 picks a random one
+     */
+    static sptr make(const std::vector<int>& delays,
+                     const std::vector<float>& gains_db,
+                     const std::vector<float>& k_factors,
+                     double sample_rate,
+                     double carrier_freq,
+                     float speed_kmh,
+                     int num_sinusoids = 16,
+                     uint32_t seed = 0);
+
+    /*!
+     * \brief Set the speed of the receiver
+     *
+     * Takes effect at the start of the next work() call.
+     *
+     * \param speed_kmh Speed in km/h (finite, >= 0)
+     */
+    virtual void set_speed(float speed_kmh) = 0;
+
+    /*!
+     * \brief Get the speed
+     *
+     * \return Speed in km/h
+     */
+    virtual float speed() const = 0;
+
+    /*!
+     * \brief Get the maximum Doppler frequency at the current speed
+     *
+     * \return Doppler frequency in Hz
+     */
+    virtual double max_doppler() const = 0;
+
+    //! Get the tap delays (in samples)
+    virtual std::vector<int> delays() const = 0;
+
+    /*!
+     * \brief Replay the speeds of a GPS log
+     *
+     * Fixes from an NMEA0183, gpsd JSON or UBX log are applied at the sample
+     * matching their time, (t - start_time) * sample_rate.
+     *
+     * \param path Log file
+     * \param start_time Log time of the first sample (s); negative uses the
+     *        first fix
+     * \return Number of fixes to replay
+     */
+    virtual size_t load_gps_replay(const std::string& path, double start_time = -1.0) = 0;
+
+    //! Stop replaying a GPS log
+    virtual void clear_gps_replay() = 0;
+
+    //! Get the number of replayed fixes not yet applied
+    virtual size_t gps_replay_remaining() const = 0;
+};
+
+} // namespace rake_receiver
+} // namespace gr
+
+#endif /* INCLUDED_RAKE_RECEIVER_MULTIPATH_CHANNEL_CC_H */
@@ -13,6 +13,7 @@
 #include <gnuradio/rake_receiver/api.h>
 #include <gnuradio/sync_block.h>
 #include <gnuradio/gr_complex.h>
+#include <cstdint>
 
 namespace gr {
 namespace rake_receiver {
@@ -25,6 +26,12 @@ namespace rake_receiver {
  * versions of a signal. The number of fingers is configurable (max 5).
  * Each finger correlates the input signal with a known pattern at a
  * specific delay and combines the results.
+ *
+ * While the flowgraph runs, speed-driven parameter changes take effect at
+ * the start of the next work() call and are marked with an "rx_adapt"
+ * stream tag (a dict of the new parameters) on the first affected output.
+ * Input "gps_speed" tags (km/h) apply at their own sample; "rx_time" tags
+ * anchor the stream time used by the speed filter.
  */
 class RAKE_RECEIVER_API rake_receiver_cc : virtual public gr::sync_block
 {
@@ -58,6 +65,20 @@ public:
      */
     virtual void set_gains(const std::vector<float>& gains) = 0;
 
+    /*!
+     * \brief Get the current finger delays
+     *
+     * \return Delay of each configured finger (in samples)
+     */
+    virtual std::vector<int> delays() const = 0;
+
+    /*!
+     * \brief Get the current finger gains
+     *
+     * \return Gain of each configured finger
+     */
+    virtual std::vector<float> gains() const = 0;
+
     /*!
      * \brief Get the current number of fingers
      *
@@ -171,9 +192,561 @@ public:
     virtual bool adaptive_mode() const = 0;
 
     /*!
-     * \brief Parse GPS data from NMEA0183 or GPSD format and update speed
+     * \brief Enable or disable Kalman filtering of GPS speed fixes
+     *
+     * When enabled, fixes feed a speed/acceleration filter and the adaptive
+     * parameters are recomputed from the filtered speed, predicted between
+     * fixes, at most once per adaptation interval instead of on every fix.
+     *
+     * \param enable True to filter GPS speed fixes
+     */
+    virtual void set_speed_filter(bool enable) = 0;
+
+    /*!
+     * \brief Check if GPS speed filtering is enabled
+     *
+     * \return True if speed fixes are filtered
+     */
+    virtual bool speed_filter() const = 0;
+
+    /*!
+     * \brief Set the speed filter noise model
+     *
+     * \param accel_noise Acceleration change per second (km/h/s, default 5)
+     * \param measurement_noise GPS speed fix error (km/h, default 2)
+     */
+    virtual void set_speed_filter_noise(float accel_noise, float measurement_noise) = 0;
+
+    /*!
+     * \brief Set how often filtered speed updates the adaptive parameters
+     *
+     * \param interval_s Adaptation interval in seconds (default 1.0)
+     */
+    virtual void set_adaptation_interval(float interval_s) = 0;
+
+    /*!
+     * \brief Get the adaptation interval
+     *
+     * \return Adaptation interval in seconds
+     */
+    virtual float adaptation_interval() const = 0;
+
+    /*!
+     * \brief Get the filtered speed predicted for the current time
+     *
+     * \return Speed in km/h (the raw GPS speed if filtering is disabled)
+     */
+    virtual float filtered_speed() const = 0;
+
+    /*!
+     * \brief Replace the speed-to-parameter table used in adaptive mode
+     *
+     * Each index is one breakpoint; breakpoints must be in ascending speed
+     * order. Parameters are interpolated between breakpoints and held beyond
+     * the first and last one. The finger count switches at segment midpoints.
+     *
+     * \param speeds_kmh Breakpoint speeds (km/h)
+     * \param path_search_rates Path search rate at each breakpoint (Hz)
+     * \param tracking_bandwidths Tracking bandwidth at each breakpoint (Hz)
+     * \param reassignment_periods Reassignment period at each breakpoint (s)
+     * \param num_fingers Finger count at each breakpoint (1-5)
+     */
+    virtual void set_speed_profile(const std::vector<float>& speeds_kmh,
+                                   const std::vector<float>& path_search_rates,
+                                   const std::vector<float>& tracking_bandwidths,
+                                   const std::vector<float>& reassignment_periods,
+                                   const std::vector<int>& num_fingers) = 0;
+
+    /*!
+     * \brief Load the speed-to-parameter table from a JSON file
+     *
+     * The file holds a "categories" array of objects with speed_kmh,
+     * path_search_rate, tracking_bandwidth, reassignment_period, num_fingers
+     * and an optional name, plus an optional top-level "hysteresis_kmh".
+     *
+     * \param path Path to the JSON profile
+     */
+    virtual void load_speed_profile(const std::string& path) = 0;
+
+    /*!
+     * \brief Restore the built-in five-category speed profile
+     */
+    virtual void reset_speed_profile() = 0;
+
+    /*!
+     * \brief Get the breakpoint speeds of the current speed profile
+     *
+     * \return Breakpoint speeds in km/h, ascending
+     */
+    virtual std::vector<float> speed_profile_breakpoints() const = 0;
+
+    /*!
+     * \brief Set the hysteresis band around finger count switch points
+     *
+     * \param hysteresis_kmh Distance past the midpoint before switching (km/h)
+     */
+    virtual void set_speed_hysteresis(float hysteresis_kmh) = 0;
+
+    /*!
+     * \brief Get the finger switch hysteresis
+     *
+     * \return Hysteresis in km/h
+     */
+    virtual float speed_hysteresis() const = 0;
+
+    /*!
+     * \brief Set the input sample rate
+     *
+     * With a sample rate, the speed filter and adaptation schedule run on
+     * stream time (anchored by rx_time tags) instead of the host clock.
+     *
+     * \param sample_rate Sample rate in samples per second
+     */
+    virtual void set_sample_rate(float sample_rate) = 0;
+
+    /*!
+     * \brief Get the input sample rate
+     *
+     * \return Sample rate, or 0 if not set
+     */
+    virtual float sample_rate() const = 0;
+
+    /*!
+     * \brief Replay a recorded GPS log in step with the sample stream
      *
-     * \param gps_data GPS data string (NMEA0183 or GPSD JSON)
+     * The log (NMEA0183, GPSD JSON or UBX) is memory-mapped and its valid
+     * fixes are indexed by time once. Each fix is then applied like a
+     * "gps_speed" tag at sample (fix time - start_time) * sample_rate.
+     * Requires set_sample_rate() first.
+     *
+     * \param path GPS log file
+     * \param start_time Log time of the first input sample in seconds
+     *        (Unix time, or time of day for logs without a date); a negative
+     *        value aligns the first fix with the first sample
+     * \return Number of fixes indexed
+     */
+    virtual size_t load_gps_replay(const std::string& path, double start_time = -1.0) = 0;
+
+    /*!
+     * \brief Stop replaying a GPS log
+     */
+    virtual void clear_gps_replay() = 0;
+
+    /*!
+     * \brief Get the number of replayed fixes not yet applied
+     *
+     * \return Remaining fixes
+     */
+    virtual size_t gps_replay_remaining() const = 0;
+
+    /*!
+     * \brief Remember finger profiles per position and reuse them
+     *
+     * With the cache enabled, every position update (set_position() or a GPS
+     * record carrying a position) is hashed to a tile. On leaving a tile the
+     * current delays and gains are stored for it; on entering a tile seen
+     * before, its stored profile seeds the fingers. While running, a seed
+     * takes effect at the start of the next work() call, and only if its
+     * delays fit into the current history.
+     *
+     * \param enable True to enable the cache
+     */
+    virtual void set_delay_cache(bool enable) = 0;
+
+    /*!
+     * \brief Check whether the delay profile cache is enabled
+     *
+     * \return True if enabled
+     */
+    virtual bool delay_cache() const = 0;
+
+    /*!
+     * \brief Set the delay cache tile edge length
+     *
+     * Changing the tile size clears the cache.
+     *
+     * \param tile_size_m Tile edge length in metres, at least 1 (default 200)
+     */
+    virtual void set_delay_cache_tile_size(float tile_size_m) = 0;
+
+    /*!
+     * \brief Get the delay cache tile edge length
+     *
+     * \return Tile edge length in metres
+     */
+    virtual float delay_cache_tile_size() const = 0;
+
+    /*!
+     * \brief Set how many tiles the delay cache keeps
+     *
+     * The least recently used tiles are dropped first.
+     *
+     * \param capacity Maximum number of tiles (default 1024)
+     */
+    virtual void set_delay_cache_capacity(int capacity) = 0;
+
+    /*!
+     * \brief Get the number of tiles in the delay cache
+     *
+     * \return Cached tiles
+     */
+    virtual size_t delay_cache_size() const = 0;
+
+    /*!
+     * \brief Replace the delay cache with the profiles saved in a file
+     *
+     * The tile size is taken from the file; a change is logged.
+     *
+     * \param path File written by save_delay_cache()
+     * \return Number of tiles loaded
+     */
+    virtual size_t load_delay_cache(const std::string& path) = 0;
+
+    /*!
+     * \brief Save the delay cache, including the current tile, to a file
+     *
+     * \param path Output file; replaced atomically
+     */
+    virtual void save_delay_cache(const std::string& path) = 0;
+
+    /*!
+     * \brief Report the receiver position to the delay cache
+     *
+     * \param latitude_deg Latitude in decimal degrees, north positive
+     * \param longitude_deg Longitude in decimal degrees, east positive
+     */
+    virtual void set_position(double latitude_deg, double longitude_deg) = 0;
+
+    /*!
+     * \brief Estimate speed from the Doppler spread of the signal itself
+     *
+     * For installations without GPS. Every doppler_decimation() samples the
+     * strongest finger's correlator output is taken as a channel estimate;
+     * the Doppler spread follows from its autocorrelation (Clarke model) and
+     * the carrier frequency gives an equivalent speed. Once per
+     * doppler_update_interval() that speed drives adaptive mode like a GPS
+     * fix would, as long as no GPS speed has been received. Requires
+     * set_sample_rate() and set_carrier_frequency().
+     *
+     * \param enable True to enable the estimator
+     */
+    virtual void set_doppler_estimation(bool enable) = 0;
+
+    /*!
+     * \brief Check whether the Doppler spread estimator is enabled
+     *
+     * \return True if enabled
+     */
+    virtual bool doppler_estimation() const = 0;
+
+    /*!
+     * \brief Set the carrier frequency used to convert Doppler to speed
+     *
+     * \param frequency_hz Carrier frequency in Hz
+     */
+    virtual void set_carrier_frequency(double frequency_hz) = 0;
+
+    /*!
+     * \brief Get the carrier frequency
+     *
+     * \return Carrier frequency in Hz, or 0 if not set
+     */
+    virtual double carrier_frequency() const = 0;
+
+    /*!
+     * \brief Set the spacing of the channel samples taken for the estimator
+     *
+     * The estimator costs one pattern correlation per \p decimation samples.
+     * The largest measurable Doppler spread is about
+     * 0.38 * sample_rate / decimation.
+     *
+     * \param decimation Samples between channel estimates (default 100)
+     */
+    virtual void set_doppler_decimation(int decimation) = 0;
+
+    /*!
+     * \brief Get the spacing of the estimator's channel samples
+     *
+     * \return Samples between channel estimates
+     */
+    virtual int doppler_decimation() const = 0;
+
+    /*!
+     * \brief Set how often the Doppler speed is published
+     *
+     * \param interval_s Averaging and update interval in seconds (default 1)
+     */
+    virtual void set_doppler_update_interval(float interval_s) = 0;
+
+    /*!
+     * \brief Get the Doppler update interval
+     *
+     * \return Interval in seconds
+     */
+    virtual float doppler_update_interval() const = 0;
+
+    /*!
+     * \brief Get the last Doppler spread estimate
+     *
+     * \return Maximum Doppler frequency in Hz, or -1 if none yet
+     */
+    virtual float doppler_spread() const = 0;
+
+    /*!
+     * \brief Get the speed equivalent to the last Doppler spread estimate
+     *
+     * \return Speed in km/h, or -1 if none yet
+     */
+    virtual float doppler_speed() const = 0;
+
+    /*!
+     * \brief Keep the receiver state in a file across flowgraph restarts
+     *
+     * The state (finger delays and gains, active fingers, adaptive
+     * parameters, speed filter estimate and last Doppler estimate) is
+     * restored from \p path right away if the file exists, saved to it on
+     * stop() and restored again on start() if it changed in between. Unusable
+     * files are reported in the log and otherwise ignored.
+     *
+     * \param path State file, or an empty string to disable
+     */
+    virtual void set_state_file(const std::string& path) = 0;
+
+    /*!
+     * \brief Get the state file
+     *
+     * \return State file path, empty if disabled
+     */
+    virtual std::string state_file() const = 0;
+
+    /*!
+     * \brief Save the receiver state to a file
+     *
+     * \param path Output file; replaced atomically
+     */
+    virtual void save_state(const std::string& path) = 0;
+
+    /*!
+     * \brief Restore the receiver state from a file written by save_state()
+     *
+     * While the flowgraph runs, saved delays that need more history than the
+     * block has are not restored. Throws std::invalid_argument if the state
+     * was saved with a different number of fingers or pattern length.
+     *
+     * \param path State file
+     */
+    virtual void load_state(const std::string& path) = 0;
+
+    /*!
+     * \brief Choose how the samples behind the finger delays are stored
+     *
+     * "history" (default) uses the GNU Radio history, which set_delays()
+     * resizes to the largest delay. "ring" keeps an internal power-of-two
+     * ring, mirrored so windows never wrap, sized once for \p max_delay:
+     * history() becomes 1 and delays up to \p max_delay can then change on
+     * any work() call without reallocating buffers. Outputs match history
+     * mode with the largest delay equal to \p max_delay.
+     *
+     * "sparse" is meant for long delays spread thinly over a large
+     * \p max_delay. Each input sample is correlated with the pattern once
+     * and only the correlator outputs are delayed, so a finger costs one read
+     * per output instead of a pattern_length correlation. Outputs match
+     * "ring", also across a pattern change: the buffered correlator outputs
+     * are then recomputed once, max_delay * pattern_length multiply-adds.
+     *
+     * Throws std::runtime_error while the flowgraph runs and
+     * std::invalid_argument for an unknown mode or a \p max_delay below the
+     * current delays.
+     *
+     * \param mode "history", "ring" or "sparse"
+     * \param max_delay Largest delay the ring must serve (samples)
+     */
+    virtual void set_delay_line_mode(const std::string& mode, int max_delay = 0) = 0;
+
+    /*!
+     * \brief Get the delay line mode
+     *
+     * \return "history", "ring" or "sparse"
+     */
+    virtual std::string delay_line_mode() const = 0;
+
+    /*!
+     * \brief Get the largest delay the delay line can serve without resizing
+     *
+     * \return Maximum delay in samples
+     */
+    virtual int max_delay() const = 0;
+
+    /*!
+     * \brief Choose the finger correlation kernel
+     *
+     * "volk" (default) uses the VOLK conjugate dot product, which dispatches
+     * to the fastest SIMD machine for the CPU. "scalar" is the plain loop,
+     * kept as the reference. Outputs agree to within float rounding.
+     *
+     * "auto" times every kernel on synthetic data shaped like the configured
+     * fingers, pattern length and delay line, and uses the fastest. It tunes
+     * at start(), or right away while running, and only when those have
+     * changed. Results are cached per CPU model in the kernel profile, so
+     * later startups read the choice instead of timing.
+     *
+     * Throws std::invalid_argument for an unknown kernel.
+     */
+    virtual void set_kernel(const std::string& name) = 0;
+
+    /*!
+     * \brief Get the correlation kernel
+     *
+     * \return Kernel name, "volk" or "scalar"; with "auto" the one chosen
+     */
+    virtual std::string kernel() const = 0;
+
+    /*!
+     * \brief Check whether the kernel is chosen by set_kernel("auto")
+     *
+     * \return True while autotuning
+     */
+    virtual bool kernel_autotune() const = 0;
+
+    /*!
+     * \brief Set the per-host profile that caches autotuned kernels
+     *
+     * A text file with one line per CPU model, workload, finger count,
+     * pattern length and delay spread. It defaults to $RAKE_RECEIVER_PROFILE,
+     * else rake_receiver_profile in the GNU Radio config directory
+     * (~/.gnuradio). An empty path tunes every time and writes nothing.
+     *
+     * \param path Profile file
+     */
+    virtual void set_kernel_profile(const std::string& path) = 0;
+
+    /*!
+     * \brief Get the kernel profile path
+     *
+     * \return Profile file, empty if caching is off
+     */
+    virtual std::string kernel_profile() const = 0;
+
+    /*!
+     * \brief Cumulative time spent in work()
+     *
+     * The performance counters below are lock-free, can be polled while the
+     * flowgraph runs and are also published through ControlPort when GNU
+     * Radio is built with it.
+     *
+     * \return Seconds
+     */
+    virtual double work_time() const = 0;
+
+    //! Number of work() calls
+    virtual uint64_t work_calls() const = 0;
+
+    //! Number of samples processed by work()
+    virtual uint64_t items_processed() const = 0;
+
+    /*!
+     * \brief Mean power of each finger's correlator output, before its gain
+     *
+     * Sampled once every 64 outputs. A finger disabled by adaptive mode stops
+     * contributing, which lowers its mean.
+     */
+    virtual std::vector<float> finger_energy() const = 0;
+
+    //! Adaptive parameter changes and finger delay/gain updates applied
+    virtual uint64_t reconfigurations() const = 0;
+
+    //! GPS receiver messages that yielded a speed
+    virtual uint64_t gps_fixes_accepted() const = 0;
+
+    //! GPS receiver messages without a usable fix or rejected by the quality gate
+    virtual uint64_t gps_fixes_rejected() const = 0;
+
+    /*!
+     * \brief Cumulative time spent estimating the channel
+     *
+     * Covers Doppler spread estimation and the location-based finger
+     * lookups of the delay cache.
+     *
+     * \return Seconds
+     */
+    virtual double estimator_time() const = 0;
+
+    //! Zero all performance counters
+    virtual void reset_counters() = 0;
+
+    /*!
+     * \brief Publish a statistics dict on the "stats" message port
+     *
+     * Every \p interval_s seconds of stream time (wall time if no sample rate
+     * is set) work() publishes a dict with:
+     *  - delays, gains (vectors)
+     *  - snr_db: per-finger SNR from the normalised pattern correlation rho,
+     *    rho^2 / (1 - rho^2), averaged over the interval; NaN if unknown
+     *  - locked: per finger, rho at or above the lock threshold
+     *  - num_fingers, speed_kmh, speed_category, path_search_rate,
+     *    tracking_bandwidth, reassignment_period
+     *  - items, samples_per_second, work_ns_per_item over the interval
+     *  - group_delay, and the latency percentiles if set_latency_probe() is on
+     *
+     * Per-finger values are sampled once every 64 outputs and the dict is
+     * built only when published.
+     *
+     * \param interval_s Seconds between messages; 0 (default) disables them
+     */
+    virtual void set_stats_interval(float interval_s) = 0;
+
+    /*!
+     * \brief Get the statistics interval
+     *
+     * \return Seconds, 0 if disabled
+     */
+    virtual float stats_interval() const = 0;
+
+    /*!
+     * \brief Measure the latency from input to combined output
+     *
+     * A probe is a "latency_probe" stream tag whose value is a
+     * std::chrono::steady_clock time in nanoseconds as uint64, the clock of
+     * time.monotonic_ns() on Linux. Probes arrive from upstream, or the block
+     * stamps one itself every \p stamp_interval input samples when they enter
+     * work(). A self-stamped probe is also tagged on the output, with the
+     * block alias as srcid, for blocks further down. Upstream probes
+     * propagate to the output too, so no probe is stamped on a sample that
+     * already carries one. A probe on input sample n is matched when output sample
+     * n + group_delay() is produced. The difference from its stamp goes into
+     * a histogram that the stats messages report as latency_p50_us,
+     * latency_p99_us, latency_max_us and latency_count.
+     *
+     * \param enabled Match probes
+     * \param stamp_interval Samples between own probes; 0 only matches upstream
+     *        probes
+     */
+    virtual void set_latency_probe(bool enabled, int stamp_interval = 0) = 0;
+
+    /*!
+     * \brief Get whether latency probes are matched
+     *
+     * \return True if enabled
+     */
+    virtual bool latency_probe() const = 0;
+
+    /*!
+     * \brief Get the algorithmic delay of the combiner
+     *
+     * A pattern whose first chip arrives at input sample s on a path of any
+     * finger delay gives its combined peak at output s + group_delay(). That
+     * is the delay line span plus the pattern length: the largest delay the
+     * history holds in history mode, and the configured maximum delay in ring
+     * and sparse mode.
+     *
+     * \return Delay in samples
+     */
+    virtual int group_delay() const = 0;
+
+    /*!
+     * \brief Parse GPS data from NMEA0183, GPSD or UBX format and update speed
+     *
+     * \param gps_data GPS data string (NMEA0183, GPSD JSON or UBX frames)
      * \return True if parsing successful and speed updated
      */
     virtual bool parse_gps_data(const std::string& gps_data) = 0;
@@ -194,6 +767,50 @@ public:
      */
     virtual bool parse_gpsd(const std::string& gpsd_json) = 0;
 
+    /*!
+     * \brief Parse u-blox UBX frames and update GPS speed from NAV-PVT
+     *
+     * The last NAV-PVT solution in \p ubx_data that passes the fix quality
+     * gate is used; other UBX messages are ignored.
+     *
+     * \param ubx_data One or more binary UBX frames
+     * \return True if a NAV-PVT solution updated the speed
+     */
+    virtual bool parse_ubx(const std::string& ubx_data) = 0;
+
+    /*!
+     * \brief Set the minimum GPSD (or UBX) fix mode accepted for speed updates
+     *
+     * GPSD reports whose "mode" is below this value do not update the speed.
+     * Reports without a "mode" member are always accepted.
+     *
+     * \param mode 2 for a 2D fix (default), 3 for a 3D fix, 0 to accept any
+     */
+    virtual void set_gps_min_mode(int mode) = 0;
+
+    /*!
+     * \brief Get the minimum GPSD fix mode accepted for speed updates
+     *
+     * \return Minimum fix mode
+     */
+    virtual int gps_min_mode() const = 0;
+
+    /*!
+     * \brief Set the largest GPSD speed error estimate accepted (km/h)
+     *
+     * GPSD reports whose "eps" exceeds this value do not update the speed.
+     *
+     * \param error_kmh Maximum speed error in km/h, 0 to disable (default)
+     */
+    virtual void set_gps_max_speed_error(float error_kmh) = 0;
+
+    /*!
+     * \brief Get the largest GPSD speed error estimate accepted
+     *
+     * \return Maximum speed error in km/h, 0 if disabled
+     */
+    virtual float gps_max_speed_error() const = 0;
+
     /*!
      * \brief Set GPS source type
      *
@@ -0,0 +1,267 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+/*
+ * Microbenchmark for the GPS parsers. Times every entry point on typical
+ * receiver traffic and counts heap allocations per sentence through a
+ * replaced global operator new. Prints one JSON document on stdout:
+ *
+ *   bench_gps_parser [--cases=rmc,vtg,tpv,...] [--min-time=0.1]
+ */
+
+#include "gps_parser.h"
+#include <gnuradio/rake_receiver/gps_fix.h>
+#include <gnuradio/rake_receiver/gps_log.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// Counted by the replaced operator new below; the benchmark is single threaded
+uint64_t allocations = 0;
+
+} // namespace
+
+void* operator new(size_t size)
+{
+    allocations++;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+using namespace gr::rake_receiver;
+
+namespace {
+
+const char rmc[] =
+    "$GNRMC,081836.00,A,3751.65123,S,14507.36234,E,045.12,144.80,130998,,,A,V*26\r\n";
+const char vtg[] = "$GNVTG,144.80,T,,M,45.12,N,83.56,K,A*20\r\n";
+const char gga[] =
+    "$GNGGA,081836.00,3751.65123,S,14507.36234,E,1,12,0.78,35.2,M,-1.3,M,,*78\r\n";
+const char tpv[] =
+    "{\"class\":\"TPV\",\"device\":\"/dev/ttyACM0\",\"mode\":3,"
+    "\"time\":\"2024-01-01T12:00:00.500Z\",\"ept\":0.005,\"lat\":48.117300,"
+    "\"lon\":11.516667,\"altMSL\":545.4,\"alt\":545.4,\"epx\":3.1,\"epy\":4.2,"
+    "\"epv\":7.5,\"track\":84.4,\"speed\":12.5,\"climb\":-0.1,\"eps\":0.3,"
+    "\"epc\":15.0}\n";
+
+// NAV-PVT at 36 km/h with a 3D fix, as in qa_gps_fix.cc
+std::string nav_pvt()
+{
+    std::string payload(ubx_nav_pvt_length, '\0');
+    auto put_le = [&](size_t pos, uint32_t value, int bytes) {
+        for (int i = 0; i < bytes; i++) {
+            payload[pos + i] = static_cast<char>(value >> (8 * i));
+        }
+    };
+    put_le(4, 2024, 2);
+    payload[6] = 1;
+    payload[7] = 1;
+    payload[8] = 12;
+    payload[11] = 0x07;
+    payload[20] = 3;
+    payload[21] = 0x01;
+    payload[23] = 9;
+    put_le(24, 115166667, 4);
+    put_le(28, 481173000, 4);
+    put_le(60, 10000, 4);
+
+    std::string frame("\xb5\x62\x01\x07", 4);
+    frame += static_cast<char>(payload.size() & 0xff);
+    frame += static_cast<char>(payload.size() >> 8);
+    frame += payload;
+    unsigned char ck_a = 0, ck_b = 0;
+    for (size_t i = 2; i < frame.size(); i++) {
+        ck_a += static_cast<unsigned char>(frame[i]);
+        ck_b += ck_a;
+    }
+    frame += static_cast<char>(ck_a);
+    frame += static_cast<char>(ck_b);
+    return frame;
+}
+
+// One second of a GNSS receiver: GGA, RMC and VTG, repeated
+std::string nmea_log(int epochs)
+{
+    std::string log;
+    for (int i = 0; i < epochs; i++) {
+        log += gga;
+        log += rmc;
+        log += vtg;
+    }
+    return log;
+}
+
+struct bench_case {
+    std::string name;        //!< reported as "case"
+    std::string entry_point; //!< parser function under test
+    int sentences;           //!< sentences handled by one call
+    std::function<float()> call;
+};
+
+struct options {
+    std::vector<std::string> cases;
+    double min_time_s = 0.1;
+};
+
+std::vector<std::string> split(const std::string& list)
+{
+    std::vector<std::string> items;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        if (end > start) {
+            items.push_back(list.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    return items;
+}
+
+bool parse_options(int argc, char** argv, options& opts)
+{
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        std::string key = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? std::string() : arg.substr(eq + 1);
+        if (key == "--cases") {
+            opts.cases = split(value);
+        } else if (key == "--min-time") {
+            opts.min_time_s = std::atof(value.c_str());
+        } else {
+            std::fprintf(
+                stderr, "usage: %s [--cases=NAME,..] [--min-time=SECONDS]\n", argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+struct result {
+    double seconds;
+    uint64_t calls;
+    uint64_t allocations;
+};
+
+// Repeat the call until min_time_s has passed; the first call warms the
+// caches and is not counted
+result run_case(const bench_case& c, double min_time_s)
+{
+    volatile float sink = c.call();
+
+    using clock = std::chrono::steady_clock;
+    result r{ 0.0, 0, 0 };
+    const uint64_t start_allocations = allocations;
+    const auto start = clock::now();
+    do {
+        // Batches keep the clock reads out of the per-call time
+        for (int i = 0; i < 64; i++) {
+            sink = c.call();
+        }
+        r.calls += 64;
+        r.seconds = std::chrono::duration<double>(clock::now() - start).count();
+    } while (r.seconds < min_time_s);
+    r.allocations = allocations - start_allocations;
+    (void)sink;
+    return r;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    options opts;
+    if (!parse_options(argc, argv, opts)) {
+        return 2;
+    }
+
+    const std::string ubx = nav_pvt();
+    const std::string log = nmea_log(100);
+    const std::string tpv_log = [] {
+        std::string s;
+        for (int i = 0; i < 100; i++) {
+            s += tpv;
+        }
+        return s;
+    }();
+    gps_fix fix;
+    auto fix_speed = [&fix](std::string_view data) {
+        return parse_gps_fix(data.data(), data.size(), fix) ? fix.speed_kmh : -1.0f;
+    };
+
+    const std::vector<bench_case> cases = {
+        { "rmc", "parse_nmea0183_speed", 1, [] { return parse_nmea0183_speed(rmc); } },
+        { "vtg", "parse_nmea0183_speed", 1, [] { return parse_nmea0183_speed(vtg); } },
+        { "tpv", "parse_gpsd_speed", 1, [] { return parse_gpsd_speed(tpv); } },
+        { "ubx", "parse_ubx_speed", 1, [&] { return parse_ubx_speed(ubx); } },
+        { "gps_rmc", "parse_gps_speed", 1, [] { return parse_gps_speed(rmc); } },
+        { "gps_vtg", "parse_gps_speed", 1, [] { return parse_gps_speed(vtg); } },
+        { "gps_tpv", "parse_gps_speed", 1, [] { return parse_gps_speed(tpv); } },
+        { "gps_ubx", "parse_gps_speed", 1, [&] { return parse_gps_speed(ubx); } },
+        { "fix_rmc", "parse_gps_fix", 1, [&] { return fix_speed(rmc); } },
+        { "fix_gga", "parse_gps_fix", 1, [&] { return fix_speed(gga); } },
+        { "fix_tpv", "parse_gps_fix", 1, [&] { return fix_speed(tpv); } },
+        { "fix_ubx", "parse_gps_fix", 1, [&] { return fix_speed(ubx); } },
+        { "log_nmea",
+          "parse_gps_log",
+          300,
+          [&] { return static_cast<float>(parse_gps_log(log).size()); } },
+        { "log_tpv",
+          "parse_gps_log",
+          100,
+          [&] { return static_cast<float>(parse_gps_log(tpv_log).size()); } },
+    };
+
+    std::printf("{\n  \"benchmark\": \"gps_parser\",\n  \"results\": [");
+    bool first = true;
+    for (const bench_case& c : cases) {
+        bool selected = opts.cases.empty();
+        for (const std::string& name : opts.cases) {
+            selected = selected || name == c.name;
+        }
+        if (!selected) {
+            continue;
+        }
+        result r = run_case(c, opts.min_time_s);
+        const double sentences = static_cast<double>(r.calls) * c.sentences;
+        std::printf("%s\n    {\"case\": \"%s\", \"entry_point\": \"%s\", "
+                    "\"sentences_per_call\": %d, \"sentences_per_second\": %.6g, "
+                    "\"ns_per_sentence\": %.6g, \"allocations_per_sentence\": %.6g}",
+                    first ? "" : ",",
+                    c.name.c_str(),
+                    c.entry_point.c_str(),
+                    c.sentences,
+                    sentences / r.seconds,
+                    r.seconds * 1e9 / sentences,
+                    r.allocations / sentences);
+        std::fflush(stdout);
+        first = false;
+    }
+    std::printf("\n  ]\n}\n");
+    return 0;
+}
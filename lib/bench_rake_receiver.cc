@@ -0,0 +1,248 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+/*
+ * Microbenchmark for the finger correlation and combining kernels, run
+ * outside a flowgraph. Sweeps kernel, finger count, pattern length, delay
+ * spread and block size and prints one JSON document on stdout:
+ *
+ *   bench_rake_receiver [--fingers=1,2,3,4,5,8,16] [--pattern-lengths=16,...]
+ *                       [--spreads=0,64,1024,16384] [--blocks=1024,8192]
+ *                       [--kernels=scalar,volk] [--min-time=0.1]
+ */
+
+#include "rake_kernels.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define RAKE_BENCH_HAVE_TSC 1
+#endif
+
+using gr::rake_receiver::rake_kernel;
+
+namespace {
+
+struct options {
+    std::vector<int> fingers = { 1, 2, 3, 4, 5, 8, 16 };
+    std::vector<int> pattern_lengths = { 16, 64, 256, 1024, 4096 };
+    std::vector<int> spreads = { 0, 64, 1024, 16384 };
+    std::vector<int> blocks = { 1024, 8192 };
+    std::vector<std::string> kernels;
+    double min_time_s = 0.1;
+};
+
+std::vector<std::string> split(const std::string& list)
+{
+    std::vector<std::string> items;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        if (end > start) {
+            items.push_back(list.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    return items;
+}
+
+std::vector<int> split_ints(const std::string& list)
+{
+    std::vector<int> values;
+    for (const std::string& item : split(list)) {
+        values.push_back(std::atoi(item.c_str()));
+    }
+    return values;
+}
+
+bool parse_options(int argc, char** argv, options& opts)
+{
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        std::string key = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? std::string() : arg.substr(eq + 1);
+        if (key == "--fingers") {
+            opts.fingers = split_ints(value);
+        } else if (key == "--pattern-lengths") {
+            opts.pattern_lengths = split_ints(value);
+        } else if (key == "--spreads") {
+            opts.spreads = split_ints(value);
+        } else if (key == "--blocks") {
+            opts.blocks = split_ints(value);
+        } else if (key == "--kernels") {
+            opts.kernels = split(value);
+        } else if (key == "--min-time") {
+            opts.min_time_s = std::atof(value.c_str());
+        } else {
+            std::fprintf(stderr,
+                         "usage: %s [--fingers=N,..] [--pattern-lengths=N,..] "
+                         "[--spreads=N,..] [--blocks=N,..] [--kernels=NAME,..] "
+                         "[--min-time=SECONDS]\n",
+                         argv[0]);
+            return false;
+        }
+    }
+    if (opts.kernels.empty()) {
+        for (const rake_kernel& kernel : gr::rake_receiver::rake_kernels()) {
+            opts.kernels.emplace_back(kernel.name);
+        }
+    }
+    return true;
+}
+
+uint64_t timestamp_cycles()
+{
+#ifdef RAKE_BENCH_HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+struct result {
+    double seconds;
+    uint64_t cycles;
+    uint64_t outputs;
+};
+
+// Repeat whole blocks until min_time_s has passed; the first block warms the
+// caches and is not counted
+result run_case(const rake_kernel& kernel,
+                int fingers,
+                int pattern_length,
+                int spread,
+                int block,
+                double min_time_s)
+{
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    std::vector<gr_complex> windows(block + spread + pattern_length - 1);
+    for (auto& x : windows) {
+        x = gr_complex(noise(rng), noise(rng));
+    }
+    std::vector<gr_complex> pattern(pattern_length);
+    for (auto& p : pattern) {
+        // QPSK chips
+        float i_chip = noise(rng) > 0.0f ? 1.0f : -1.0f;
+        float q_chip = noise(rng) > 0.0f ? 1.0f : -1.0f;
+        p = gr_complex(i_chip, q_chip);
+    }
+    std::vector<int> delays(fingers);
+    std::vector<float> gains(fingers, 1.0f / fingers);
+    for (int f = 0; f < fingers; f++) {
+        // Evenly over the spread, first finger at 0 and last at the spread
+        delays[f] =
+            fingers > 1 ? static_cast<int>(int64_t(spread) * f / (fingers - 1)) : 0;
+    }
+    std::vector<gr_complex> out(block);
+
+    auto combine = [&]() {
+        gr::rake_receiver::rake_combine(kernel,
+                                        windows.data(),
+                                        delays.data(),
+                                        gains.data(),
+                                        fingers,
+                                        pattern.data(),
+                                        pattern_length,
+                                        out.data(),
+                                        block);
+    };
+    combine();
+
+    using clock = std::chrono::steady_clock;
+    result r{ 0.0, 0, 0 };
+    const auto start = clock::now();
+    const uint64_t start_cycles = timestamp_cycles();
+    do {
+        combine();
+        r.outputs += block;
+        r.seconds = std::chrono::duration<double>(clock::now() - start).count();
+    } while (r.seconds < min_time_s);
+    r.cycles = timestamp_cycles() - start_cycles;
+    return r;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    options opts;
+    if (!parse_options(argc, argv, opts)) {
+        return 2;
+    }
+
+    std::printf("{\n  \"benchmark\": \"rake_combine\",\n");
+    std::printf("  \"cycle_counter\": \"%s\",\n",
+#ifdef RAKE_BENCH_HAVE_TSC
+                "tsc"
+#else
+                "none"
+#endif
+    );
+    std::printf("  \"results\": [");
+    bool first = true;
+    for (const std::string& name : opts.kernels) {
+        const rake_kernel* kernel = gr::rake_receiver::find_rake_kernel(name);
+        if (!kernel) {
+            std::fprintf(stderr, "Unknown kernel: %s\n", name.c_str());
+            return 2;
+        }
+        for (int fingers : opts.fingers) {
+            for (int pattern_length : opts.pattern_lengths) {
+                for (int spread : opts.spreads) {
+                    for (int block : opts.blocks) {
+                        if (fingers < 1 || pattern_length < 1 || spread < 0 ||
+                            block < 1) {
+                            continue;
+                        }
+                        result r = run_case(*kernel,
+                                            fingers,
+                                            pattern_length,
+                                            spread,
+                                            block,
+                                            opts.min_time_s);
+                        const double taps =
+                            static_cast<double>(r.outputs) * fingers * pattern_length;
+                        std::printf("%s\n    {\"kernel\": \"%s\", \"fingers\": %d, "
+                                    "\"pattern_length\": %d, \"delay_spread\": %d, "
+                                    "\"block_size\": %d, \"samples_per_second\": %.6g, "
+                                    "\"ns_per_output\": %.6g, \"cycles_per_tap\": ",
+                                    first ? "" : ",",
+                                    kernel->name,
+                                    fingers,
+                                    pattern_length,
+                                    spread,
+                                    block,
+                                    r.outputs / r.seconds,
+                                    r.seconds * 1e9 / r.outputs);
+                        if (r.cycles > 0) {
+                            std::printf("%.6g}", r.cycles / taps);
+                        } else {
+                            std::printf("null}");
+                        }
+                        std::fflush(stdout);
+                        first = false;
+                    }
+                }
+            }
+        }
+    }
+    std::printf("\n  ]\n}\n");
+    return 0;
+}
@@ -0,0 +1,261 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "delay_profile_cache.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace gr {
+namespace rake_receiver {
+
+namespace {
+
+constexpr char cache_magic[4] = { 'R', 'K', 'D', 'C' };
+constexpr uint32_t cache_version = 1;
+
+// Metres per degree of latitude
+constexpr double metres_per_degree = 111320.0;
+constexpr double radians_per_degree = 3.14159265358979323846 / 180.0;
+
+struct cache_header {
+    char magic[4];
+    uint32_t version;
+    double tile_size_m;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+struct entry_header {
+    uint64_t tile;
+    uint32_t fingers;
+    uint32_t reserved;
+};
+
+template <typename T>
+void write_raw(std::ofstream& out, const T* values, size_t count)
+{
+    out.write(reinterpret_cast<const char*>(values), sizeof(T) * count);
+}
+
+// Copy the next \p count values out of the mapped file
+template <typename T>
+bool read_raw(const char*& pos, const char* end, T* values, size_t count)
+{
+    size_t bytes = sizeof(T) * count;
+    if (static_cast<size_t>(end - pos) < bytes) {
+        return false;
+    }
+    std::memcpy(values, pos, bytes);
+    pos += bytes;
+    return true;
+}
+
+void check_tile_size(double tile_size_m)
+{
+    // Smaller tiles would number more rows and columns than the key holds
+    if (!(tile_size_m >= delay_profile_cache::min_tile_size_m) ||
+        !std::isfinite(tile_size_m)) {
+        throw std::invalid_argument("Delay cache tile size must be at least 1 m");
+    }
+}
+
+} // namespace
+
+delay_profile_cache::delay_profile_cache(double tile_size_m, size_t capacity)
+    : d_tile_size_m(tile_size_m), d_capacity(capacity)
+{
+    check_tile_size(tile_size_m);
+    if (capacity == 0) {
+        throw std::invalid_argument("Delay cache capacity must be positive");
+    }
+}
+
+bool delay_profile_cache::tile(double latitude_deg,
+                               double longitude_deg,
+                               uint64_t& tile) const
+{
+    // Also false for NaN, which the int32 conversions below cannot take
+    if (!(std::fabs(latitude_deg) <= 90.0 && std::fabs(longitude_deg) <= 180.0)) {
+        return false;
+    }
+    const double tile_deg = d_tile_size_m / metres_per_degree;
+    double row = std::floor(latitude_deg / tile_deg);
+    // Narrow the columns towards the poles so tiles stay roughly square
+    double row_centre = (row + 0.5) * tile_deg * radians_per_degree;
+    double column_deg = tile_deg / std::max(std::cos(row_centre), 1e-6);
+    double column = std::floor(longitude_deg / column_deg);
+
+    auto row_bits = static_cast<uint32_t>(static_cast<int32_t>(row));
+    auto column_bits = static_cast<uint32_t>(static_cast<int32_t>(column));
+    tile = (static_cast<uint64_t>(row_bits) << 32) | column_bits;
+    return true;
+}
+
+void delay_profile_cache::store(uint64_t tile,
+                                const std::vector<int>& delays,
+                                const std::vector<float>& gains)
+{
+    if (delays.size() != gains.size()) {
+        throw std::invalid_argument("Delay cache profile needs one gain per delay");
+    }
+    auto it = d_index.find(tile);
+    if (it != d_index.end()) {
+        it->second->second = profile{ delays, gains };
+        d_entries.splice(d_entries.begin(), d_entries, it->second);
+        return;
+    }
+    d_entries.emplace_front(tile, profile{ delays, gains });
+    d_index[tile] = d_entries.begin();
+    evict();
+}
+
+const delay_profile_cache::profile* delay_profile_cache::find(uint64_t tile)
+{
+    auto it = d_index.find(tile);
+    if (it == d_index.end()) {
+        return nullptr;
+    }
+    d_entries.splice(d_entries.begin(), d_entries, it->second);
+    return &it->second->second;
+}
+
+void delay_profile_cache::set_tile_size(double tile_size_m)
+{
+    check_tile_size(tile_size_m);
+    if (tile_size_m != d_tile_size_m) {
+        d_tile_size_m = tile_size_m;
+        clear();
+    }
+}
+
+void delay_profile_cache::set_capacity(size_t capacity)
+{
+    if (capacity == 0) {
+        throw std::invalid_argument("Delay cache capacity must be positive");
+    }
+    d_capacity = capacity;
+    evict();
+}
+
+void delay_profile_cache::clear()
+{
+    d_entries.clear();
+    d_index.clear();
+}
+
+void delay_profile_cache::evict()
+{
+    while (d_entries.size() > d_capacity) {
+        d_index.erase(d_entries.back().first);
+        d_entries.pop_back();
+    }
+}
+
+void delay_profile_cache::save(const std::string& path) const
+{
+    // Write next to the target and rename, so a crash never leaves a
+    // truncated cache behind
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Cannot write delay cache file: " + tmp_path);
+        }
+
+        cache_header header;
+        std::memcpy(header.magic, cache_magic, sizeof(cache_magic));
+        header.version = cache_version;
+        header.tile_size_m = d_tile_size_m;
+        header.count = static_cast<uint32_t>(d_entries.size());
+        header.reserved = 0;
+        write_raw(out, &header, 1);
+
+        for (const auto& e : d_entries) {
+            const std::vector<int>& delays = e.second.delays;
+            entry_header eh;
+            eh.tile = e.first;
+            eh.fingers = static_cast<uint32_t>(delays.size());
+            eh.reserved = 0;
+            write_raw(out, &eh, 1);
+            for (int delay : delays) {
+                int32_t value = delay;
+                write_raw(out, &value, 1);
+            }
+            write_raw(out, e.second.gains.data(), e.second.gains.size());
+        }
+
+        if (!out.flush()) {
+            throw std::runtime_error("Cannot write delay cache file: " + tmp_path);
+        }
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        throw std::runtime_error("Cannot replace delay cache file: " + path);
+    }
+}
+
+size_t delay_profile_cache::load(const std::string& path)
+{
+    mapped_file file(path);
+    const char* pos = file.data();
+    const char* end = file.data() + file.size();
+    const std::runtime_error malformed("Malformed delay cache file: " + path);
+
+    cache_header header;
+    if (!read_raw(pos, end, &header, 1) ||
+        std::memcmp(header.magic, cache_magic, sizeof(cache_magic)) != 0 ||
+        header.version != cache_version ||
+        !(header.tile_size_m >= min_tile_size_m && std::isfinite(header.tile_size_m))) {
+        throw malformed;
+    }
+
+    // Parse everything before touching the current contents
+    std::list<entry> entries;
+    for (uint32_t i = 0; i < header.count; i++) {
+        entry_header eh;
+        if (!read_raw(pos, end, &eh, 1) ||
+            static_cast<size_t>(end - pos) / (sizeof(int32_t) + sizeof(float)) <
+                eh.fingers) {
+            throw malformed;
+        }
+        std::vector<int32_t> delays(eh.fingers);
+        profile p;
+        p.gains.resize(eh.fingers);
+        read_raw(pos, end, delays.data(), delays.size());
+        read_raw(pos, end, p.gains.data(), p.gains.size());
+        p.delays.assign(delays.begin(), delays.end());
+        entries.emplace_back(eh.tile, std::move(p));
+    }
+
+    d_tile_size_m = header.tile_size_m;
+    d_entries = std::move(entries);
+    d_index.clear();
+    for (auto it = d_entries.begin(); it != d_entries.end();) {
+        // Keep the first, most recent, copy of a duplicated tile
+        if (!d_index.emplace(it->first, it).second) {
+            it = d_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    evict();
+    return d_entries.size();
+}
+
+} // namespace rake_receiver
+} // namespace gr
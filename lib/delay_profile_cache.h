@@ -0,0 +1,112 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef INCLUDED_RAKE_RECEIVER_DELAY_PROFILE_CACHE_H
+#define INCLUDED_RAKE_RECEIVER_DELAY_PROFILE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gr {
+namespace rake_receiver {
+
+/*!
+ * \brief Finger delay/gain profiles remembered per position tile
+ *
+ * Positions are hashed to roughly square tiles: latitude is cut into rows of
+ * tile_size metres and each row into columns of the same width at the row's
+ * centre latitude. Row and column are packed into one 64-bit key. Tiles are
+ * at least min_tile_size_m across, so that both fit in 32 bits.
+ *
+ * The cache holds at most capacity() tiles and evicts the least recently used
+ * one. Profiles can be written to and read back from a binary file:
+ *
+ * \code
+ * header:  char magic[4] = "RKDC", uint32 version = 1, float64 tile_size_m,
+ *          uint32 count, uint32 reserved
+ * entry:   uint64 tile, uint32 fingers, uint32 reserved,
+ *          int32 delays[fingers], float32 gains[fingers]
+ * \endcode
+ *
+ * in host byte order, most recently used tile first.
+ */
+class delay_profile_cache
+{
+public:
+    struct profile {
+        std::vector<int> delays;
+        std::vector<float> gains;
+    };
+
+    static constexpr double min_tile_size_m = 1.0;
+
+    explicit delay_profile_cache(double tile_size_m = 200.0, size_t capacity = 1024);
+
+    /*!
+     * \brief Tile containing a position in decimal degrees
+     *
+     * \return false, leaving \p tile alone, for non-finite or out of range
+     *         coordinates
+     */
+    bool tile(double latitude_deg, double longitude_deg, uint64_t& tile) const;
+
+    //! Insert or replace the profile of \p tile and mark it most recently used
+    void store(uint64_t tile,
+               const std::vector<int>& delays,
+               const std::vector<float>& gains);
+
+    //! Profile of \p tile, or nullptr; a hit marks the tile most recently used
+    const profile* find(uint64_t tile);
+
+    size_t size() const { return d_entries.size(); }
+    size_t capacity() const { return d_capacity; }
+    double tile_size() const { return d_tile_size_m; }
+
+    //! Change the tile size; existing keys no longer apply, so this clears
+    void set_tile_size(double tile_size_m);
+
+    //! Change the capacity, evicting the least recently used tiles if needed
+    void set_capacity(size_t capacity);
+
+    void clear();
+
+    //! Write all profiles to \p path; throws std::runtime_error on failure
+    void save(const std::string& path) const;
+
+    /*!
+     * \brief Replace the contents with the profiles in \p path
+     *
+     * The tile size is taken from the file, as the keys depend on it; compare
+     * tile_size() before and after to notice a change. Throws
+     * std::runtime_error if the file cannot be read or is not a cache file.
+     *
+     * \return Number of profiles loaded
+     */
+    size_t load(const std::string& path);
+
+private:
+    using entry = std::pair<uint64_t, profile>;
+
+    void evict();
+
+    double d_tile_size_m;
+    size_t d_capacity;
+    std::list<entry> d_entries; // most recently used first
+    std::unordered_map<uint64_t, std::list<entry>::iterator> d_index;
+};
+
+} // namespace rake_receiver
+} // namespace gr
+
+#endif /* INCLUDED_RAKE_RECEIVER_DELAY_PROFILE_CACHE_H */
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "doppler_spread_estimator.h"
+#include <cmath>
+
+namespace gr {
+namespace rake_receiver {
+
+namespace {
+
+// First zero of J0; beyond it the correlation no longer identifies f_D
+constexpr double j0_first_zero = 2.404825557695773;
+constexpr double two_pi = 6.283185307179586;
+
+// Power series of J0, accurate to ~1e-12 up to its first zero
+double bessel_j0(double x)
+{
+    const double q = -0.25 * x * x;
+    double term = 1.0;
+    double sum = 1.0;
+    for (int k = 1; k < 16; k++) {
+        term *= q / (static_cast<double>(k) * k);
+        sum += term;
+    }
+    return sum;
+}
+
+} // namespace
+
+double doppler_spread_estimator::inverse_j0(double rho)
+{
+    if (rho >= 1.0) {
+        return 0.0;
+    }
+    if (rho <= 0.0) {
+        return j0_first_zero;
+    }
+    // J0 falls monotonically on [0, first zero]
+    double lo = 0.0;
+    double hi = j0_first_zero;
+    for (int i = 0; i < 48; i++) {
+        double mid = 0.5 * (lo + hi);
+        if (bessel_j0(mid) > rho) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return 0.5 * (lo + hi);
+}
+
+double doppler_spread_estimator::estimate(double spacing_s)
+{
+    // A handful of pairs gives a meaningless correlation
+    const size_t min_pairs = 16;
+    if (d_pairs < min_pairs || !(d_r0 > 0.0) || !(spacing_s > 0.0)) {
+        clear_sums();
+        return -1.0;
+    }
+    double rho = std::abs(d_r1) / d_r0;
+    clear_sums();
+    return inverse_j0(rho) / (two_pi * spacing_s);
+}
+
+} // namespace rake_receiver
+} // namespace gr
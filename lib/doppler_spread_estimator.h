@@ -0,0 +1,93 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef INCLUDED_RAKE_RECEIVER_DOPPLER_SPREAD_ESTIMATOR_H
+#define INCLUDED_RAKE_RECEIVER_DOPPLER_SPREAD_ESTIMATOR_H
+
+#include <gnuradio/gr_complex.h>
+#include <complex>
+#include <cstddef>
+
+namespace gr {
+namespace rake_receiver {
+
+/*!
+ * \brief Doppler spread from the autocorrelation of a channel estimate
+ *
+ * Channel samples h[n] taken at a fixed spacing tau are accumulated into
+ * R0 = E|h|^2 and R1 = E h[n] h*[n-1]. Under the Clarke (Jakes) model
+ * |R1| / R0 = J0(2 pi f_D tau), which is inverted for the maximum Doppler
+ * frequency f_D. Taking the magnitude of R1 makes the estimate insensitive
+ * to a carrier frequency offset.
+ *
+ * f_D is only identifiable while 2 pi f_D tau stays below the first zero of
+ * J0 (2.405), i.e. f_D < 0.38 / tau. Noise lowers the correlation and biases
+ * the estimate upwards.
+ */
+class doppler_spread_estimator
+{
+public:
+    doppler_spread_estimator() { reset(); }
+
+    //! Forget the accumulated correlation and the previous sample
+    void reset()
+    {
+        d_have_prev = false;
+        clear_sums();
+    }
+
+    //! Add the next channel sample
+    void update(gr_complex h)
+    {
+        std::complex<double> x(h);
+        if (d_have_prev) {
+            d_r0 += 0.5 * (std::norm(x) + std::norm(d_prev));
+            d_r1 += x * std::conj(d_prev);
+            d_pairs++;
+        }
+        d_prev = x;
+        d_have_prev = true;
+    }
+
+    //! Number of sample pairs accumulated since the last estimate
+    size_t pairs() const { return d_pairs; }
+
+    /*!
+     * \brief Doppler spread of the accumulated samples
+     *
+     * Starts a new accumulation; the previous sample is kept so the next
+     * estimate continues seamlessly.
+     *
+     * \param spacing_s Time between consecutive channel samples (s)
+     * \return Maximum Doppler frequency in Hz, or -1 without enough data
+     */
+    double estimate(double spacing_s);
+
+    //! x in [0, 2.405] with J0(x) = rho (clamped to that range)
+    static double inverse_j0(double rho);
+
+private:
+    void clear_sums()
+    {
+        d_r0 = 0.0;
+        d_r1 = 0.0;
+        d_pairs = 0;
+    }
+
+    bool d_have_prev;
+    std::complex<double> d_prev;
+    double d_r0;
+    std::complex<double> d_r1;
+    size_t d_pairs;
+};
+
+} // namespace rake_receiver
+} // namespace gr
+
+#endif /* INCLUDED_RAKE_RECEIVER_DOPPLER_SPREAD_ESTIMATOR_H */
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+/*
+ * Fuzz target for the GPS parsers: every entry point that sees receiver
+ * output gets the same bytes. Besides crashes and sanitizer reports, it
+ * aborts when a parser breaks its contract, e.g. a speed that is neither -1
+ * nor a finite non-negative number.
+ *
+ * Built with -fsanitize=fuzzer (RAKE_FUZZ_LIBFUZZER), libFuzzer drives it:
+ *
+ *   fuzz_gps_parser -dict=lib/fuzz_corpus/gps.dict corpus_dir lib/fuzz_corpus/gps
+ *
+ * Otherwise it has its own main() that runs each file given on the command
+ * line, or stdin without arguments. That suits AFL (afl-clang-fast++, input
+ * on stdin) and replaying the seed corpus as a regression test.
+ */
+
+#include "gps_parser.h"
+#include <gnuradio/rake_receiver/gps_fix.h>
+#include <gnuradio/rake_receiver/gps_log.h>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+using namespace gr::rake_receiver;
+
+namespace {
+
+void check(bool condition, const char* what)
+{
+    if (!condition) {
+        std::fprintf(stderr, "fuzz_gps_parser: contract violated: %s\n", what);
+        std::abort();
+    }
+}
+
+void check_speed(float speed_kmh, const char* parser)
+{
+    check(speed_kmh == -1.0f || (std::isfinite(speed_kmh) && speed_kmh >= 0.0f), parser);
+}
+
+void check_fix(bool parsed, const gps_fix& fix, const char* parser)
+{
+    if (!parsed) {
+        return;
+    }
+    if (fix.has(gps_fix::has_speed)) {
+        check(std::isfinite(fix.speed_kmh), parser);
+    }
+    if (fix.has(gps_fix::has_position)) {
+        check(std::isfinite(fix.latitude_deg) && std::isfinite(fix.longitude_deg),
+              parser);
+    }
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    const std::string_view input(reinterpret_cast<const char*>(data), size);
+
+    check_speed(parse_nmea0183_speed(input), "parse_nmea0183_speed");
+    check_speed(parse_gpsd_speed(input), "parse_gpsd_speed");
+    check_speed(parse_ubx_speed(input), "parse_ubx_speed");
+    check_speed(parse_gps_speed(input), "parse_gps_speed");
+
+    gpsd_report report;
+    if (parse_gpsd_report(input, report)) {
+        // Views must stay inside the input
+        for (std::string_view view : { report.time, report.message }) {
+            check(view.empty() || (view.data() >= input.data() &&
+                                   view.data() + view.size() <= input.data() + size),
+                  "parse_gpsd_report view");
+        }
+    }
+
+    gps_fix fix;
+    check_fix(parse_nmea0183_fix(input, fix), fix, "parse_nmea0183_fix");
+    fix = gps_fix();
+    check_fix(parse_gpsd_fix(input, fix), fix, "parse_gpsd_fix");
+    fix = gps_fix();
+    check_fix(parse_gps_fix(reinterpret_cast<const char*>(data), size, fix),
+              fix,
+              "parse_gps_fix");
+
+    size_t pos = 0;
+    std::string_view frame;
+    while (next_ubx_frame(input, pos, frame)) {
+        check(pos <= size, "next_ubx_frame position");
+        ubx_nav_pvt pvt;
+        parse_ubx_nav_pvt(frame, pvt);
+        fix = gps_fix();
+        check_fix(parse_ubx_fix(frame, fix), fix, "parse_ubx_fix");
+    }
+
+    gps_log log = parse_gps_log(reinterpret_cast<const char*>(data), size);
+    check(log.timestamps.size() == log.speeds_kmh.size() &&
+              log.speeds_kmh.size() == log.valid.size(),
+          "parse_gps_log columns");
+    // gps_replay feeds valid entries to the receiver as they are
+    for (size_t i = 0; i < log.size(); i++) {
+        if (log.valid[i]) {
+            check_speed(log.speeds_kmh[i], "parse_gps_log");
+        }
+    }
+    return 0;
+}
+
+#ifndef RAKE_FUZZ_LIBFUZZER
+int main(int argc, char** argv)
+{
+    auto run = [](std::istream& in) {
+        std::string bytes((std::istreambuf_iterator<char>(in)),
+                          std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(bytes.data()),
+                               bytes.size());
+    };
+    if (argc < 2) {
+        run(std::cin);
+        return 0;
+    }
+    for (int i = 1; i < argc; i++) {
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file) {
+            std::fprintf(stderr, "fuzz_gps_parser: cannot read %s\n", argv[i]);
+            return 1;
+        }
+        run(file);
+    }
+    return 0;
+}
+#endif
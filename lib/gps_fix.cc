@@ -0,0 +1,53 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gps_parser.h"
+#include <gnuradio/rake_receiver/gps_fix.h>
+
+namespace gr {
+namespace rake_receiver {
+
+bool parse_gps_fix(const char* data, size_t length, gps_fix& fix)
+{
+    fix = gps_fix();
+    if (data == nullptr || length == 0) {
+        return false;
+    }
+
+    std::string_view record(data, length);
+    if (is_ubx(record)) {
+        size_t pos = 0;
+        std::string_view frame;
+        return next_ubx_frame(record, pos, frame) && parse_ubx_fix(frame, fix);
+    }
+
+    record = trim_gps_data(record);
+    if (record.empty()) {
+        return false;
+    }
+    if (record[0] == '$') {
+        return parse_nmea0183_fix(record, fix);
+    }
+    if (record[0] == '{') {
+        return parse_gpsd_fix(record, fix);
+    }
+    return false;
+}
+
+bool parse_gps_fix(const std::string& data, gps_fix& fix)
+{
+    return parse_gps_fix(data.data(), data.size(), fix);
+}
+
+} // namespace rake_receiver
+} // namespace gr
@@ -0,0 +1,214 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gps_parser.h"
+#include "mapped_file.h"
+#include <gnuradio/rake_receiver/gps_log.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace gr {
+namespace rake_receiver {
+
+namespace {
+
+constexpr size_t max_nmea_fields = 20;
+const double no_time = std::numeric_limits<double>::quiet_NaN();
+const float no_speed = std::numeric_limits<float>::quiet_NaN();
+
+// Running time base shared by consecutive records of one log
+struct log_clock {
+    long day = -1;
+    double time_of_day = no_time;
+
+    void set_time_of_day(double tod)
+    {
+        // GGA/VTG-only stretches can cross midnight without a new date
+        if (day >= 0 && !std::isnan(time_of_day) && tod + 43200.0 < time_of_day) {
+            day++;
+        }
+        time_of_day = tod;
+    }
+
+    double now() const
+    {
+        if (std::isnan(time_of_day)) {
+            return no_time;
+        }
+        return day >= 0 ? day * 86400.0 + time_of_day : time_of_day;
+    }
+};
+
+// Speed column entry: NaN for speeds checked_speed_kmh() rejects
+float log_speed(double speed_kmh)
+{
+    float speed = checked_speed_kmh(speed_kmh);
+    return speed < 0.0f ? no_speed : speed;
+}
+
+// A fix is only valid with a usable speed; gps_replay trusts the flag
+void append(gps_log& log, double t, float speed, bool valid)
+{
+    valid = valid && !std::isnan(speed);
+    log.timestamps.push_back(t);
+    log.speeds_kmh.push_back(speed);
+    log.valid.push_back(valid ? 1 : 0);
+}
+
+void parse_nmea_line(std::string_view line, log_clock& clock, gps_log& log)
+{
+    if (line.size() < 6) {
+        return;
+    }
+    // Talker ID (GP, GN, GL, ...) is not relevant here
+    std::string_view type = line.substr(3, 3);
+    std::string_view fields[max_nmea_fields];
+
+    if (type == "RMC") {
+        size_t count = split_nmea_fields(line, fields, max_nmea_fields);
+        if (count < 8) {
+            return;
+        }
+        double tod;
+        long day;
+        if (count > 9 && parse_nmea_date(fields[9], day)) {
+            clock.day = day;
+        }
+        if (parse_nmea_time(fields[1], tod)) {
+            clock.set_time_of_day(tod);
+        }
+        float knots;
+        bool have_speed = parse_float_field(fields[7], knots);
+        bool valid = fields[2] == "A" && (count < 13 || fields[12] != "N");
+        append(log, clock.now(), have_speed ? log_speed(knots * 1.852) : no_speed, valid);
+    } else if (type == "VTG") {
+        size_t count = split_nmea_fields(line, fields, max_nmea_fields);
+        if (count < 8) {
+            return;
+        }
+        float kmh;
+        bool have_speed = parse_float_field(fields[7], kmh);
+        bool valid = count < 10 || fields[9] != "N";
+        append(log, clock.now(), have_speed ? log_speed(kmh) : no_speed, valid);
+    } else if (type == "GGA" || type == "ZDA") {
+        size_t count = split_nmea_fields(line, fields, max_nmea_fields);
+        double tod;
+        if (count > 1 && parse_nmea_time(fields[1], tod)) {
+            clock.set_time_of_day(tod);
+        }
+    }
+}
+
+void parse_gpsd_line(std::string_view line, log_clock& clock, gps_log& log)
+{
+    gpsd_report report;
+    if (!parse_gpsd_report(line, report)) {
+        return;
+    }
+
+    double t;
+    bool have_time = parse_iso8601_time(report.time, t);
+    if (have_time) {
+        clock.day = static_cast<long>(std::floor(t / 86400.0));
+        clock.time_of_day = t - clock.day * 86400.0;
+    }
+
+    if (report.report_class != gpsd_class::tpv) {
+        return;
+    }
+
+    // mode 0/1 means no fix; a missing speed is NaN and logged as such
+    bool valid = report.mode < 0 || report.mode >= 2;
+    append(log, have_time ? t : clock.now(), log_speed(report.speed * 3.6), valid);
+}
+
+void parse_ubx_record(std::string_view frame, log_clock& clock, gps_log& log)
+{
+    ubx_nav_pvt pvt;
+    if (!parse_ubx_nav_pvt(frame, pvt)) {
+        return;
+    }
+    if (!std::isnan(pvt.unix_time)) {
+        clock.day = static_cast<long>(std::floor(pvt.unix_time / 86400.0));
+        clock.time_of_day = pvt.unix_time - clock.day * 86400.0;
+    }
+    bool valid = pvt.fix_ok && pvt.fix_type >= 2 && pvt.fix_type <= 4;
+    append(log, clock.now(), log_speed(pvt.ground_speed_mps * 3.6), valid);
+}
+
+} // namespace
+
+gps_log parse_gps_log(const char* data, size_t length)
+{
+    gps_log log;
+    if (data == nullptr || length == 0) {
+        return log;
+    }
+
+    // Upper bound on the number of records, so the columns never reallocate:
+    // one per text line, or one per NAV-PVT frame in binary UBX logs
+    size_t records = std::count(data, data + length, '\n') + 1;
+    records = std::max(records, length / (ubx_frame_overhead + ubx_nav_pvt_length));
+    log.timestamps.reserve(records);
+    log.speeds_kmh.reserve(records);
+    log.valid.reserve(records);
+
+    log_clock clock;
+    const char* pos = data;
+    const char* end = data + length;
+    while (pos < end) {
+        // Binary UBX frames carry their own length and may contain '\n'
+        if (is_ubx(std::string_view(pos, end - pos))) {
+            size_t frame_pos = 0;
+            std::string_view frame;
+            if (next_ubx_frame(std::string_view(pos, end - pos), frame_pos, frame) &&
+                frame.data() == pos) {
+                parse_ubx_record(frame, clock, log);
+                pos += frame.size();
+                continue;
+            }
+        }
+
+        const char* eol = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+        if (eol == nullptr) {
+            eol = end;
+        }
+        std::string_view line = trim_gps_data(std::string_view(pos, eol - pos));
+        if (!line.empty()) {
+            if (line[0] == '$') {
+                parse_nmea_line(line, clock, log);
+            } else if (line[0] == '{') {
+                parse_gpsd_line(line, clock, log);
+            }
+        }
+        pos = eol + 1;
+    }
+
+    return log;
+}
+
+gps_log parse_gps_log(const std::string& data)
+{
+    return parse_gps_log(data.data(), data.size());
+}
+
+gps_log parse_gps_log_file(const std::string& path)
+{
+    mapped_file file(path);
+    return parse_gps_log(file.data(), file.size());
+}
+
+} // namespace rake_receiver
+} // namespace gr
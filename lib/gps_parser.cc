@@ -12,157 +12,724 @@
 #endif
 
 #include "gps_parser.h"
-#include <sstream>
+#include "json_scanner.h"
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
 
 namespace gr {
 namespace rake_receiver {
 
-bool is_nmea0183(const std::string& data)
+namespace {
+
+// Number of fields in the longest sentence we look at (GGA has 15)
+constexpr size_t max_nmea_fields = 20;
+
+bool is_space(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+bool starts_with(std::string_view s, std::string_view prefix)
 {
-    if (data.empty()) {
+    return s.size() >= prefix.size() && s.compare(0, prefix.size(), prefix) == 0;
+}
+
+// Parse exactly n decimal digits starting at s[pos]
+bool parse_digits(std::string_view s, size_t pos, size_t n, int& value)
+{
+    if (pos + n > s.size()) {
         return false;
     }
-    return data[0] == '$' || (data.length() > 0 && data.find("$") != std::string::npos);
+    value = 0;
+    for (size_t i = pos; i < pos + n; i++) {
+        if (s[i] < '0' || s[i] > '9') {
+            return false;
+        }
+        value = value * 10 + (s[i] - '0');
+    }
+    return true;
 }
 
-bool is_gpsd_json(const std::string& data)
+// Little-endian fields of a UBX payload
+uint32_t ubx_u4(const unsigned char* p)
 {
-    if (data.empty()) {
+    return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 |
+           uint32_t(p[3]) << 24;
+}
+int32_t ubx_i4(const unsigned char* p) { return static_cast<int32_t>(ubx_u4(p)); }
+uint16_t ubx_u2(const unsigned char* p) { return uint16_t(p[0] | p[1] << 8); }
+
+// Whole JSON numbers in [0, max], such as "mode" and "uSat"
+bool parse_count_field(std::string_view field, int max, int& value)
+{
+    double v;
+    if (!parse_double_field(field, v) || !(v >= 0.0 && v <= max) ||
+        v != std::floor(v)) {
         return false;
     }
-    std::string trimmed = data;
-    trimmed.erase(0, trimmed.find_first_not_of(" \t\n\r"));
-    return trimmed[0] == '{' || trimmed.find("\"class\"") != std::string::npos;
+    value = static_cast<int>(v);
+    return true;
+}
+
+// gpsd reports fewer channels than this; larger "uSat" counts are garbage
+constexpr int max_gpsd_satellites = 255;
+
+bool is_nmea_speed_sentence(std::string_view sentence)
+{
+    return starts_with(sentence, "$GPRMC") || starts_with(sentence, "$GNRMC") ||
+           starts_with(sentence, "$GPVTG") || starts_with(sentence, "$GNVTG");
 }
 
-float parse_nmea0183_speed(const std::string& nmea_message)
+// Speed of a GPS/GNSS RMC or VTG sentence split into fields, or -1
+float nmea_speed_kmh(std::string_view sentence,
+                     const std::string_view* fields,
+                     size_t count)
 {
-    if (nmea_message.empty() || nmea_message[0] != '$') {
+    if (!is_nmea_speed_sentence(sentence)) {
         return -1.0f;
     }
+    // GPRMC format: $GPRMC,time,status,lat,N/S,lon,E/W,speed_knots,course,date,...
+    // GPVTG format: $GPVTG,course1,T,course2,M,speed_knots,N,speed_kmh,K*checksum
+    // Field 7 is the speed in knots for RMC and in km/h for VTG
+    float speed;
+    if (count < 8 || !parse_float_field(fields[7], speed)) {
+        return -1.0f;
+    }
+    if (sentence.substr(3, 3) == "RMC") {
+        // Convert knots to km/h: 1 knot = 1.852 km/h
+        return checked_speed_kmh(speed * 1.852);
+    }
+    return checked_speed_kmh(speed);
+}
+
+constexpr unsigned char ubx_sync1 = 0xB5;
+constexpr unsigned char ubx_sync2 = 0x62;
+constexpr unsigned char ubx_class_nav = 0x01;
+constexpr unsigned char ubx_id_nav_pvt = 0x07;
+
+// NMEA "ddmm.mmmm" / "dddmm.mmmm" with hemisphere letter to signed degrees
+bool parse_nmea_coordinate(std::string_view value, std::string_view hemisphere, double& deg)
+{
+    double raw;
+    if (hemisphere.size() != 1 || !parse_double_field(value, raw)) {
+        return false;
+    }
+    const char h = hemisphere[0];
+    if (h != 'N' && h != 'S' && h != 'E' && h != 'W') {
+        return false;
+    }
+    double degrees = std::floor(raw / 100.0);
+    deg = degrees + (raw - degrees * 100.0) / 60.0;
+    if (!(deg >= 0.0 && deg <= (h == 'N' || h == 'S' ? 90.0 : 180.0))) {
+        return false;
+    }
+    if (h == 'S' || h == 'W') {
+        deg = -deg;
+    }
+    return true;
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date
+long days_from_civil(int y, int m, int d)
+{
+    y -= m <= 2;
+    const long era = (y >= 0 ? y : y - 399) / 400;
+    const long yoe = y - era * 400;
+    const long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
 
-    // Parse GPRMC (Recommended Minimum Course) - contains speed
-    if (nmea_message.find("$GPRMC") == 0 || nmea_message.find("$GNRMC") == 0) {
-        std::vector<std::string> fields;
-        std::stringstream ss(nmea_message);
-        std::string field;
+} // namespace
 
-        while (std::getline(ss, field, ',')) {
-            fields.push_back(field);
+bool is_ubx(std::string_view data)
+{
+    return data.size() >= 2 && static_cast<unsigned char>(data[0]) == ubx_sync1 &&
+           static_cast<unsigned char>(data[1]) == ubx_sync2;
+}
+
+bool next_ubx_frame(std::string_view data, size_t& pos, std::string_view& frame)
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data.data());
+    while (pos + ubx_frame_overhead <= data.size()) {
+        const void* sync = std::memchr(bytes + pos, ubx_sync1, data.size() - pos);
+        if (sync == nullptr) {
+            break;
+        }
+        size_t start = static_cast<const unsigned char*>(sync) - bytes;
+        if (start + ubx_frame_overhead > data.size()) {
+            break;
+        }
+        if (bytes[start + 1] != ubx_sync2) {
+            pos = start + 1;
+            continue;
         }
 
-        // GPRMC format: $GPRMC,time,status,lat,N/S,lon,E/W,speed_knots,course,date,mag_var,E/W*checksum
-        // Field 7 (index 6) is speed in knots
-        if (fields.size() >= 8) {
-            try {
-                float speed_knots = std::stof(fields[7]);
-                // Convert knots to km/h: 1 knot = 1.852 km/h
-                return speed_knots * 1.852f;
-            } catch (...) {
-                return -1.0f;
-            }
+        size_t length = ubx_u2(bytes + start + 4);
+        if (start + ubx_frame_overhead + length > data.size()) {
+            // Truncated frame; a later sync may still be complete
+            pos = start + 1;
+            continue;
+        }
+
+        // 8-bit Fletcher checksum over class, id, length and payload
+        unsigned char ck_a = 0, ck_b = 0;
+        const unsigned char* p = bytes + start + 2;
+        for (size_t i = 0; i < length + 4; i++) {
+            ck_a += p[i];
+            ck_b += ck_a;
         }
+        if (ck_a != p[length + 4] || ck_b != p[length + 5]) {
+            pos = start + 1;
+            continue;
+        }
+
+        frame = data.substr(start, length + ubx_frame_overhead);
+        pos = start + length + ubx_frame_overhead;
+        return true;
+    }
+    pos = data.size();
+    return false;
+}
+
+bool parse_ubx_nav_pvt(std::string_view frame, ubx_nav_pvt& pvt)
+{
+    size_t pos = 0;
+    std::string_view checked;
+    if (frame.size() != ubx_nav_pvt_length + ubx_frame_overhead ||
+        !next_ubx_frame(frame, pos, checked) || checked.size() != frame.size()) {
+        return false;
+    }
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(frame.data());
+    if (bytes[2] != ubx_class_nav || bytes[3] != ubx_id_nav_pvt) {
+        return false;
     }
 
-    // Parse GPVTG (Track Made Good and Ground Speed) - contains speed
-    if (nmea_message.find("$GPVTG") == 0 || nmea_message.find("$GNVTG") == 0) {
-        std::vector<std::string> fields;
-        std::stringstream ss(nmea_message);
-        std::string field;
+    const unsigned char* p = bytes + 6;
+    pvt.itow_ms = ubx_u4(p);
 
-        while (std::getline(ss, field, ',')) {
-            fields.push_back(field);
+    // valid: bit 0 validDate, bit 1 validTime
+    pvt.unix_time = std::numeric_limits<double>::quiet_NaN();
+    if ((p[11] & 0x03) == 0x03) {
+        int month = p[6], day = p[7], hour = p[8], minute = p[9], second = p[10];
+        if (month >= 1 && month <= 12 && day >= 1 && day <= 31 && hour <= 23 &&
+            minute <= 59 && second <= 60) {
+            pvt.unix_time = days_from_civil(ubx_u2(p + 4), month, day) * 86400.0 +
+                            hour * 3600.0 + minute * 60.0 + second +
+                            ubx_i4(p + 16) * 1e-9;
         }
+    }
 
-        // GPVTG format: $GPVTG,course1,T,course2,M,speed_knots,N,speed_kmh,K*checksum
-        // Field 7 (index 6) is speed in km/h
-        if (fields.size() >= 8) {
-            try {
-                return std::stof(fields[7]);
-            } catch (...) {
-                return -1.0f;
-            }
+    pvt.fix_type = p[20];
+    pvt.fix_ok = (p[21] & 0x01) != 0;
+    pvt.num_sv = p[23];
+    pvt.lon_deg = ubx_i4(p + 24) * 1e-7;
+    pvt.lat_deg = ubx_i4(p + 28) * 1e-7;
+    pvt.height_m = ubx_i4(p + 32) * 1e-3;
+    pvt.height_msl_m = ubx_i4(p + 36) * 1e-3;
+    pvt.ground_speed_mps = ubx_i4(p + 60) * 1e-3;
+    pvt.heading_deg = ubx_i4(p + 64) * 1e-5;
+    pvt.speed_accuracy_mps = ubx_u4(p + 68) * 1e-3;
+    pvt.pdop = ubx_u2(p + 76) * 0.01;
+    return true;
+}
+
+float parse_ubx_speed(std::string_view ubx_data)
+{
+    float speed_kmh = -1.0f;
+    size_t pos = 0;
+    std::string_view frame;
+    ubx_nav_pvt pvt;
+    while (next_ubx_frame(ubx_data, pos, frame)) {
+        if (parse_ubx_nav_pvt(frame, pvt) && pvt.fix_ok && pvt.fix_type >= 2 &&
+            pvt.fix_type <= 4) {
+            // UBX ground speed is in mm/s, decoded to m/s
+            speed_kmh = checked_speed_kmh(pvt.ground_speed_mps * 3.6);
         }
     }
+    return speed_kmh;
+}
 
-    return -1.0f;
+std::string_view trim_gps_data(std::string_view data)
+{
+    size_t start = 0;
+    while (start < data.size() && is_space(data[start])) {
+        start++;
+    }
+    size_t end = data.size();
+    while (end > start && is_space(data[end - 1])) {
+        end--;
+    }
+    return data.substr(start, end - start);
 }
 
-float parse_gpsd_speed(const std::string& gpsd_json)
+bool is_nmea0183(std::string_view data)
 {
-    if (gpsd_json.empty()) {
-        return -1.0f;
+    if (data.empty()) {
+        return false;
     }
+    return data[0] == '$' || data.find('$') != std::string_view::npos;
+}
 
-    // Simple JSON parsing for GPSD format
-    // GPSD TPV (Time-Position-Velocity) message format:
-    // {"class":"TPV","device":"/dev/ttyUSB0","time":"2024-01-01T12:00:00.000Z","lat":...,"lon":...,"speed":...}
+bool is_gpsd_json(std::string_view data)
+{
+    std::string_view trimmed = trim_gps_data(data);
+    if (trimmed.empty()) {
+        return false;
+    }
+    return trimmed[0] == '{' || trimmed.find("\"class\"") != std::string_view::npos;
+}
 
-    // Look for "speed" field
-    size_t speed_pos = gpsd_json.find("\"speed\"");
-    if (speed_pos == std::string::npos) {
-        return -1.0f;
+size_t split_nmea_fields(std::string_view sentence,
+                         std::string_view* fields,
+                         size_t max_fields)
+{
+    size_t checksum_pos = sentence.find('*');
+    if (checksum_pos != std::string_view::npos) {
+        sentence = sentence.substr(0, checksum_pos);
     }
 
-    // Find the colon after "speed"
-    size_t colon_pos = gpsd_json.find(':', speed_pos);
-    if (colon_pos == std::string::npos) {
-        return -1.0f;
+    size_t count = 0;
+    size_t start = 0;
+    while (count < max_fields) {
+        size_t comma = sentence.find(',', start);
+        if (comma == std::string_view::npos) {
+            fields[count++] = trim_gps_data(sentence.substr(start));
+            break;
+        }
+        fields[count++] = sentence.substr(start, comma - start);
+        start = comma + 1;
     }
+    return count;
+}
 
-    // Find the value (skip whitespace)
-    size_t value_start = colon_pos + 1;
-    while (value_start < gpsd_json.length() &&
-           (gpsd_json[value_start] == ' ' || gpsd_json[value_start] == '\t')) {
-        value_start++;
+bool parse_double_field(std::string_view field, double& value)
+{
+    // strtod needs a terminated string; numeric fields are short
+    char buf[64];
+    if (field.empty() || field.size() >= sizeof(buf)) {
+        return false;
     }
+    std::memcpy(buf, field.data(), field.size());
+    buf[field.size()] = '\0';
 
-    // Find the end of the value (comma, }, or whitespace)
-    size_t value_end = value_start;
-    while (value_end < gpsd_json.length() && gpsd_json[value_end] != ',' &&
-           gpsd_json[value_end] != '}' && gpsd_json[value_end] != ' ' &&
-           gpsd_json[value_end] != '\t' && gpsd_json[value_end] != '\n') {
-        value_end++;
+    char* end = nullptr;
+    double v = std::strtod(buf, &end);
+    // strtod also accepts "nan", "inf" and overflows to infinity
+    if (end == buf || !std::isfinite(v)) {
+        return false;
     }
+    value = v;
+    return true;
+}
 
-    if (value_end <= value_start) {
+float checked_speed_kmh(double speed_kmh)
+{
+    if (!(speed_kmh >= 0.0 && speed_kmh <= std::numeric_limits<float>::max())) {
         return -1.0f;
     }
+    return static_cast<float>(speed_kmh);
+}
 
-    try {
-        std::string speed_str = gpsd_json.substr(value_start, value_end - value_start);
-        float speed_ms = std::stof(speed_str);
-        // GPSD speed is in m/s, convert to km/h: 1 m/s = 3.6 km/h
-        return speed_ms * 3.6f;
-    } catch (...) {
-        return -1.0f;
+bool parse_float_field(std::string_view field, float& value)
+{
+    double v;
+    if (!parse_double_field(field, v) ||
+        std::fabs(v) > std::numeric_limits<float>::max()) {
+        return false;
+    }
+    value = static_cast<float>(v);
+    return true;
+}
+
+bool parse_nmea_time(std::string_view field, double& seconds_of_day)
+{
+    int hh, mm, ss;
+    if (!parse_digits(field, 0, 2, hh) || !parse_digits(field, 2, 2, mm) ||
+        !parse_digits(field, 4, 2, ss) || hh > 23 || mm > 59 || ss > 60) {
+        return false;
+    }
+    double frac = 0.0;
+    if (field.size() > 6 && field[6] == '.') {
+        double f;
+        if (parse_double_field(field.substr(6), f)) {
+            frac = f;
+        }
+    }
+    seconds_of_day = hh * 3600.0 + mm * 60.0 + ss + frac;
+    return true;
+}
+
+bool parse_nmea_date(std::string_view field, long& days)
+{
+    int dd, mm, yy;
+    if (field.size() != 6 || !parse_digits(field, 0, 2, dd) ||
+        !parse_digits(field, 2, 2, mm) || !parse_digits(field, 4, 2, yy) || dd < 1 ||
+        dd > 31 || mm < 1 || mm > 12) {
+        return false;
     }
+    // NMEA0183 carries a two digit year; 80-99 are last century
+    int year = (yy < 80) ? 2000 + yy : 1900 + yy;
+    days = days_from_civil(year, mm, dd);
+    return true;
 }
 
-float parse_gps_speed(const std::string& gps_data)
+bool parse_iso8601_time(std::string_view text, double& unix_time)
 {
-    if (gps_data.empty()) {
+    // YYYY-MM-DDTHH:MM:SS[.sss]Z
+    int year, month, day, hh, mm, ss;
+    if (!parse_digits(text, 0, 4, year) || text.size() < 19 || text[4] != '-' ||
+        !parse_digits(text, 5, 2, month) || text[7] != '-' ||
+        !parse_digits(text, 8, 2, day) || text[10] != 'T' ||
+        !parse_digits(text, 11, 2, hh) || text[13] != ':' ||
+        !parse_digits(text, 14, 2, mm) || text[16] != ':' ||
+        !parse_digits(text, 17, 2, ss) || month < 1 || month > 12 || day < 1 ||
+        day > 31 || hh > 23 || mm > 59 || ss > 60) {
+        return false;
+    }
+    double frac = 0.0;
+    if (text.size() > 19 && text[19] == '.') {
+        size_t end = 20;
+        while (end < text.size() && text[end] >= '0' && text[end] <= '9') {
+            end++;
+        }
+        double f;
+        if (parse_double_field(text.substr(19, end - 19), f)) {
+            frac = f;
+        }
+    }
+    unix_time = days_from_civil(year, month, day) * 86400.0 + hh * 3600.0 +
+                mm * 60.0 + ss + frac;
+    return true;
+}
+
+float parse_nmea0183_speed(std::string_view nmea_message)
+{
+    // Only RMC and VTG carry a speed; skip splitting everything else
+    if (!is_nmea_speed_sentence(nmea_message)) {
         return -1.0f;
     }
+    std::string_view fields[max_nmea_fields];
+    size_t count = split_nmea_fields(nmea_message, fields, max_nmea_fields);
+    return nmea_speed_kmh(nmea_message, fields, count);
+}
+
+bool parse_nmea0183_fix(std::string_view sentence, gps_fix& fix)
+{
+    float speed_kmh;
+    return parse_nmea0183_fix(sentence, fix, speed_kmh);
+}
+
+bool parse_nmea0183_fix(std::string_view sentence, gps_fix& fix, float& speed_kmh)
+{
+    fix = gps_fix();
+    speed_kmh = -1.0f;
+    if (sentence.size() < 6 || sentence[0] != '$') {
+        return false;
+    }
+    // Talker ID (GP, GN, GL, ...) is not relevant here
+    std::string_view type = sentence.substr(3, 3);
+    if (type != "RMC" && type != "GGA" && type != "VTG") {
+        return false;
+    }
+
+    std::string_view fields[max_nmea_fields];
+    size_t count = split_nmea_fields(sentence, fields, max_nmea_fields);
+    speed_kmh = nmea_speed_kmh(sentence, fields, count);
+    auto field = [&](size_t i) { return i < count ? fields[i] : std::string_view(); };
+    float f;
 
-    // Try NMEA0183 first
-    if (is_nmea0183(gps_data)) {
-        float speed = parse_nmea0183_speed(gps_data);
-        if (speed >= 0.0f) {
-            return speed;
+    if (type == "VTG") {
+        // $GPVTG,course_true,T,course_mag,M,speed_knots,N,speed_kmh,K,mode
+        if (parse_float_field(field(1), f)) {
+            fix.course_deg = f;
+            fix.valid |= gps_fix::has_course;
+        }
+        if (parse_float_field(field(7), f)) {
+            fix.speed_kmh = f;
+            fix.valid |= gps_fix::has_speed;
         }
+        if (field(9) == "N") {
+            fix.mode = 1;
+            fix.valid |= gps_fix::has_mode;
+        }
+        return true;
+    }
+
+    // RMC and GGA both start with the time and the position
+    double tod;
+    if (parse_nmea_time(field(1), tod)) {
+        fix.time = tod;
+        fix.valid |= gps_fix::has_time;
     }
 
-    // Try GPSD JSON
-    if (is_gpsd_json(gps_data)) {
-        float speed = parse_gpsd_speed(gps_data);
-        if (speed >= 0.0f) {
-            return speed;
+    if (type == "RMC") {
+        // $GPRMC,time,status,lat,N/S,lon,E/W,speed_knots,course,date,mag_var,E/W,mode
+        bool active = field(2) == "A" && field(12) != "N";
+        if (active && parse_nmea_coordinate(field(3), field(4), fix.latitude_deg) &&
+            parse_nmea_coordinate(field(5), field(6), fix.longitude_deg)) {
+            fix.valid |= gps_fix::has_position;
         }
+        if (parse_float_field(field(7), f) && std::isfinite(f * 1.852f)) {
+            fix.speed_kmh = f * 1.852f;
+            fix.valid |= gps_fix::has_speed;
+        }
+        if (parse_float_field(field(8), f)) {
+            fix.course_deg = f;
+            fix.valid |= gps_fix::has_course;
+        }
+        long day;
+        if (fix.has(gps_fix::has_time) && parse_nmea_date(field(9), day)) {
+            fix.time += day * 86400.0;
+            fix.valid |= gps_fix::has_date;
+        }
+        if (!active) {
+            fix.mode = 1;
+            fix.valid |= gps_fix::has_mode;
+        }
+        return true;
+    }
+
+    // $GPGGA,time,lat,N/S,lon,E/W,quality,satellites,hdop,altitude,M,...
+    int quality = -1;
+    if (field(6).size() == 1 && field(6)[0] >= '0' && field(6)[0] <= '9') {
+        quality = field(6)[0] - '0';
+    }
+    if (quality > 0 && parse_nmea_coordinate(field(2), field(3), fix.latitude_deg) &&
+        parse_nmea_coordinate(field(4), field(5), fix.longitude_deg)) {
+        fix.valid |= gps_fix::has_position;
+    }
+    if (quality == 0) {
+        fix.mode = 1;
+        fix.valid |= gps_fix::has_mode;
+    }
+    // Satellites in use: "00" to "99", some receivers drop the leading zero
+    int satellites;
+    if ((field(7).size() == 1 || field(7).size() == 2) &&
+        parse_digits(field(7), 0, field(7).size(), satellites)) {
+        fix.satellites = satellites;
+        fix.valid |= gps_fix::has_satellites;
+    }
+    if (parse_float_field(field(8), f)) {
+        fix.hdop = f;
+        fix.valid |= gps_fix::has_hdop;
+    }
+    double altitude;
+    if (quality > 0 && parse_double_field(field(9), altitude)) {
+        fix.altitude_m = altitude;
+        fix.valid |= gps_fix::has_altitude;
+    }
+    return true;
+}
+
+bool parse_gpsd_fix(std::string_view gpsd_json, gps_fix& fix)
+{
+    gpsd_report report;
+    if (!parse_gpsd_report(gpsd_json, report, true)) {
+        fix = gps_fix();
+        return false;
+    }
+    return fix_from_gpsd_report(report, fix);
+}
+
+bool fix_from_gpsd_report(const gpsd_report& report, gps_fix& fix)
+{
+    fix = gps_fix();
+    if (report.report_class != gpsd_class::tpv) {
+        return false;
+    }
+
+    if (parse_iso8601_time(report.time, fix.time)) {
+        fix.valid |= gps_fix::has_time | gps_fix::has_date;
+    }
+    if (!std::isnan(report.lat) && !std::isnan(report.lon)) {
+        fix.latitude_deg = report.lat;
+        fix.longitude_deg = report.lon;
+        fix.valid |= gps_fix::has_position;
+    }
+    if (!std::isnan(report.alt)) {
+        fix.altitude_m = report.alt;
+        fix.valid |= gps_fix::has_altitude;
+    }
+    // GPSD speeds are in m/s
+    if (std::fabs(report.speed * 3.6) <= std::numeric_limits<float>::max()) {
+        fix.speed_kmh = static_cast<float>(report.speed * 3.6);
+        fix.valid |= gps_fix::has_speed;
+    }
+    if (!std::isnan(report.track)) {
+        fix.course_deg = static_cast<float>(report.track);
+        fix.valid |= gps_fix::has_course;
+    }
+    if (!std::isnan(report.eps)) {
+        fix.speed_error_kmh = static_cast<float>(report.eps * 3.6);
+        fix.valid |= gps_fix::has_speed_error;
+    }
+    if (report.mode >= 0) {
+        // mode 0 (unknown) is reported as no fix
+        fix.mode = std::max(report.mode, 1);
+        fix.valid |= gps_fix::has_mode;
+    }
+    return true;
+}
+
+bool parse_ubx_fix(std::string_view frame, gps_fix& fix)
+{
+    ubx_nav_pvt pvt;
+    if (!parse_ubx_nav_pvt(frame, pvt)) {
+        fix = gps_fix();
+        return false;
+    }
+    fix_from_ubx_nav_pvt(pvt, fix);
+    return true;
+}
+
+void fix_from_ubx_nav_pvt(const ubx_nav_pvt& pvt, gps_fix& fix)
+{
+    fix = gps_fix();
+
+    if (!std::isnan(pvt.unix_time)) {
+        fix.time = pvt.unix_time;
+        fix.valid |= gps_fix::has_time | gps_fix::has_date;
+    }
+    // GNSS + dead reckoning counts as 3D; everything without gnssFixOK,
+    // dead reckoning only and time-only solutions as no fix
+    bool usable = pvt.fix_ok && pvt.fix_type >= 2 && pvt.fix_type <= 4;
+    fix.mode = usable ? std::min<int>(pvt.fix_type, 3) : 1;
+    fix.satellites = pvt.num_sv;
+    fix.valid |= gps_fix::has_mode | gps_fix::has_satellites;
+    if (usable) {
+        fix.latitude_deg = pvt.lat_deg;
+        fix.longitude_deg = pvt.lon_deg;
+        // gps_fix altitudes are above mean sea level, as in GGA and gpsd
+        fix.altitude_m = pvt.height_msl_m;
+        fix.course_deg = static_cast<float>(pvt.heading_deg);
+        fix.valid |= gps_fix::has_position | gps_fix::has_altitude | gps_fix::has_course;
     }
+    fix.speed_kmh = static_cast<float>(pvt.ground_speed_mps * 3.6);
+    fix.speed_error_kmh = static_cast<float>(pvt.speed_accuracy_mps * 3.6);
+    fix.valid |= gps_fix::has_speed | gps_fix::has_speed_error;
+}
+
+bool parse_gpsd_report(std::string_view gpsd_json, gpsd_report& report, bool tpv_only)
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    report.report_class = gpsd_class::unknown;
+    report.mode = -1;
+    report.time = std::string_view();
+    report.lat = report.lon = report.alt = nan;
+    report.speed = report.track = report.climb = nan;
+    report.eps = report.epd = report.epc = report.ept = nan;
+    report.hdop = nan;
+    report.satellites_used = -1;
+    report.message = std::string_view();
+
+    // GPSD TPV (Time-Position-Velocity) message format:
+    // {"class":"TPV","device":"/dev/ttyUSB0","mode":3,"time":"2024-01-01T12:00:00.000Z",
+    //  "lat":...,"lon":...,"speed":...,"eps":...}
+    bool rejected = false;
+    bool well_formed = scan_json_object(
+        gpsd_json, [&](std::string_view key, json_type type, std::string_view value) {
+            if (type == json_type::number) {
+                // Look the member up first so only those read are converted
+                if (key == "mode") {
+                    parse_count_field(value, 3, report.mode);
+                    return true;
+                }
+                if (key == "uSat") {
+                    parse_count_field(value, max_gpsd_satellites, report.satellites_used);
+                    return true;
+                }
+                double* member = nullptr;
+                if (key == "speed") {
+                    member = &report.speed;
+                } else if (key == "track") {
+                    member = &report.track;
+                } else if (key == "climb") {
+                    member = &report.climb;
+                } else if (key == "eps") {
+                    member = &report.eps;
+                } else if (key == "epd") {
+                    member = &report.epd;
+                } else if (key == "epc") {
+                    member = &report.epc;
+                } else if (key == "ept") {
+                    member = &report.ept;
+                } else if (key == "hdop") {
+                    member = &report.hdop;
+                } else if (key == "lat") {
+                    member = &report.lat;
+                } else if (key == "lon") {
+                    member = &report.lon;
+                } else if (key == "altMSL" || (key == "alt" && std::isnan(report.alt))) {
+                    // "alt" is the older name of altMSL
+                    member = &report.alt;
+                }
+                if (member) {
+                    parse_double_field(value, *member);
+                }
+            } else if (type == json_type::string) {
+                if (key == "class") {
+                    if (value == "TPV") {
+                        report.report_class = gpsd_class::tpv;
+                    } else if (value == "SKY") {
+                        report.report_class = gpsd_class::sky;
+                    } else if (value == "ERROR") {
+                        report.report_class = gpsd_class::error;
+                    } else {
+                        report.report_class = gpsd_class::other;
+                    }
+                    // "class" comes first in gpsd output, so this rejects
+                    // SKY/ERROR/... reports before touching the rest
+                    if (tpv_only && report.report_class != gpsd_class::tpv) {
+                        rejected = true;
+                        return false;
+                    }
+                } else if (key == "time") {
+                    report.time = value;
+                } else if (key == "message") {
+                    report.message = value;
+                }
+            }
+            return true;
+        });
 
+    return well_formed && !rejected;
+}
+
+float parse_gpsd_speed(std::string_view gpsd_json)
+{
+    gpsd_report report;
+    if (!parse_gpsd_report(gpsd_json, report, true) || std::isnan(report.speed)) {
+        return -1.0f;
+    }
+    // GPSD speed is in m/s, convert to km/h: 1 m/s = 3.6 km/h
+    return checked_speed_kmh(report.speed * 3.6);
+}
+
+float parse_gps_speed(std::string_view gps_data)
+{
+    // Binary frames must be checked before trimming, which could eat payload
+    if (is_ubx(gps_data)) {
+        return parse_ubx_speed(gps_data);
+    }
+
+    std::string_view trimmed = trim_gps_data(gps_data);
+    if (trimmed.empty()) {
+        return -1.0f;
+    }
+
+    // Dispatch on the first character instead of probing every format
+    if (trimmed[0] == '$') {
+        return parse_nmea0183_speed(trimmed);
+    }
+    if (trimmed[0] == '{') {
+        return parse_gpsd_speed(trimmed);
+    }
+
+    // Fall back to the loose checks for data with leading garbage
+    if (is_gpsd_json(trimmed)) {
+        return parse_gpsd_speed(trimmed);
+    }
     return -1.0f;
 }
 
@@ -10,8 +10,10 @@
 #ifndef INCLUDED_RAKE_RECEIVER_GPS_PARSER_H
 #define INCLUDED_RAKE_RECEIVER_GPS_PARSER_H
 
-#include <string>
-#include <vector>
+#include <gnuradio/rake_receiver/gps_fix.h>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
 
 namespace gr {
 namespace rake_receiver {
@@ -22,23 +24,173 @@ namespace rake_receiver {
  * \param nmea_message NMEA0183 message string (e.g., "$GPRMC,...")
  * \return Speed in km/h, or -1.0 if parsing fails or speed not available
  */
-float parse_nmea0183_speed(const std::string& nmea_message);
+float parse_nmea0183_speed(std::string_view nmea_message);
 
 /*!
  * \brief Parse GPSD JSON message and extract speed
  *
+ * Reports with a "class" other than TPV are rejected.
+ *
  * \param gpsd_json GPSD JSON message string
  * \return Speed in km/h, or -1.0 if parsing fails or speed not available
  */
-float parse_gpsd_speed(const std::string& gpsd_json);
+float parse_gpsd_speed(std::string_view gpsd_json);
+
+/*!
+ * \brief Class of a GPSD report
+ */
+enum class gpsd_class { unknown, tpv, sky, error, other };
+
+/*!
+ * \brief Fields of a GPSD TPV, SKY or ERROR report
+ *
+ * Absent numbers are NaN, absent strings are empty. String members are views
+ * into the parsed text and are only valid as long as it is.
+ */
+struct gpsd_report {
+    gpsd_class report_class;  //!< "class" member
+    int mode;                 //!< fix mode: 0 unknown, 1 no fix, 2 2D, 3 3D, -1 absent
+    std::string_view time;    //!< ISO 8601 UTC time
+    double lat;               //!< latitude (degrees)
+    double lon;               //!< longitude (degrees)
+    double alt;               //!< altitude above mean sea level (m)
+    double speed;             //!< ground speed (m/s)
+    double track;             //!< course over ground (degrees)
+    double climb;             //!< vertical speed (m/s)
+    double eps;               //!< speed error estimate (m/s)
+    double epd;               //!< track error estimate (degrees)
+    double epc;               //!< climb error estimate (m/s)
+    double ept;               //!< time error estimate (s)
+    double hdop;              //!< SKY: horizontal dilution of precision
+    int satellites_used;      //!< SKY: satellites used in the fix, -1 if absent
+    std::string_view message; //!< ERROR: error text
+};
+
+/*!
+ * \brief Parse a GPSD JSON report in a single pass without allocating
+ *
+ * Only top-level members are considered, so keys inside nested objects
+ * (e.g. the satellite list of a SKY report) never match.
+ *
+ * \param gpsd_json GPSD JSON object
+ * \param report Filled with the extracted fields
+ * \param tpv_only Stop as soon as a "class" other than TPV is seen
+ * \return True if the object was well formed and, with \p tpv_only, not
+ *         rejected by its class
+ */
+bool parse_gpsd_report(std::string_view gpsd_json,
+                       gpsd_report& report,
+                       bool tpv_only = false);
+
+/*!
+ * \brief Decoded u-blox UBX NAV-PVT (class 0x01, id 0x07) navigation solution
+ */
+struct ubx_nav_pvt {
+    uint32_t itow_ms;          //!< GPS time of week of the solution (ms)
+    double unix_time;          //!< UTC time, NaN unless date and time are valid
+    uint8_t fix_type;          //!< 0 none, 1 dead reckoning, 2 2D, 3 3D, 4 GNSS+DR, 5 time
+    bool fix_ok;               //!< gnssFixOK flag: fix within the configured limits
+    uint8_t num_sv;            //!< satellites used
+    double lat_deg;            //!< latitude (degrees)
+    double lon_deg;            //!< longitude (degrees)
+    double height_m;           //!< height above ellipsoid (m)
+    double height_msl_m;       //!< height above mean sea level (m)
+    double ground_speed_mps;   //!< 2D ground speed (m/s)
+    double heading_deg;        //!< heading of motion (degrees)
+    double speed_accuracy_mps; //!< speed accuracy estimate (m/s)
+    double pdop;               //!< position dilution of precision
+};
+
+//! Bytes in a UBX frame around the payload: sync (2), class, id, length (2), checksum (2)
+constexpr size_t ubx_frame_overhead = 8;
+
+//! Payload length of a NAV-PVT message
+constexpr size_t ubx_nav_pvt_length = 92;
+
+/*!
+ * \brief Check if data starts with the UBX sync characters (0xB5 0x62)
+ */
+bool is_ubx(std::string_view data);
 
 /*!
- * \brief Parse GPS speed from either NMEA0183 or GPSD format
+ * \brief Find the next complete UBX frame with a valid checksum
  *
- * \param gps_data GPS data string (NMEA0183 or GPSD JSON)
+ * Bytes before a sync sequence and frames with a bad checksum are skipped.
+ *
+ * \param data Raw receiver output, possibly mixed with NMEA text
+ * \param pos Search start; on success left just past the returned frame
+ * \param frame View of the whole frame, sync to checksum
+ * \return True if a frame was found
+ */
+bool next_ubx_frame(std::string_view data, size_t& pos, std::string_view& frame);
+
+/*!
+ * \brief Decode a NAV-PVT frame
+ *
+ * \param frame One whole UBX frame, as returned by next_ubx_frame()
+ * \param pvt Filled with the decoded solution
+ * \return True if the frame is a NAV-PVT message of the expected length
+ *         with a valid checksum
+ */
+bool parse_ubx_nav_pvt(std::string_view frame, ubx_nav_pvt& pvt);
+
+/*!
+ * \brief Parse UBX binary data and extract speed from the last NAV-PVT fix
+ *
+ * Solutions without gnssFixOK or without a 2D/3D fix are ignored.
+ *
+ * \param ubx_data One or more UBX frames
+ * \return Speed in km/h, or -1.0 if no usable NAV-PVT frame is present
+ */
+float parse_ubx_speed(std::string_view ubx_data);
+
+/*!
+ * \brief Fill a gps_fix from an NMEA0183 RMC, GGA or VTG sentence
+ *
+ * The sentence is split once; speed-only callers should keep using
+ * parse_nmea0183_speed(), which skips the position and time fields.
+ *
+ * \return True if the sentence is one of the supported types
+ */
+bool parse_nmea0183_fix(std::string_view sentence, gps_fix& fix);
+
+/*!
+ * \brief parse_nmea0183_fix(), also returning parse_nmea0183_speed()
+ *
+ * For callers that need both: the sentence is still split only once.
+ */
+bool parse_nmea0183_fix(std::string_view sentence, gps_fix& fix, float& speed_kmh);
+
+/*!
+ * \brief Fill a gps_fix from a GPSD TPV report
+ *
+ * \return True if the report is a well formed TPV
+ */
+bool parse_gpsd_fix(std::string_view gpsd_json, gps_fix& fix);
+
+//! parse_gpsd_fix() for a report that is already parsed; false unless a TPV
+bool fix_from_gpsd_report(const gpsd_report& report, gps_fix& fix);
+
+/*!
+ * \brief Fill a gps_fix from a UBX NAV-PVT frame
+ *
+ * \return True if the frame is a valid NAV-PVT message
+ */
+bool parse_ubx_fix(std::string_view frame, gps_fix& fix);
+
+//! parse_ubx_fix() for a NAV-PVT solution that is already decoded
+void fix_from_ubx_nav_pvt(const ubx_nav_pvt& pvt, gps_fix& fix);
+
+/*!
+ * \brief Parse GPS speed from NMEA0183, GPSD or UBX format
+ *
+ * UBX is recognised by its sync characters; otherwise the format is detected
+ * once from the first non-whitespace character.
+ *
+ * \param gps_data GPS data (NMEA0183, GPSD JSON or UBX frames)
  * \return Speed in km/h, or -1.0 if parsing fails
  */
-float parse_gps_speed(const std::string& gps_data);
+float parse_gps_speed(std::string_view gps_data);
 
 /*!
  * \brief Check if string is NMEA0183 format
@@ -46,7 +198,7 @@ float parse_gps_speed(const std::string& gps_data);
  * \param data String to check
  * \return True if appears to be NMEA0183 format
  */
-bool is_nmea0183(const std::string& data);
+bool is_nmea0183(std::string_view data);
 
 /*!
  * \brief Check if string is GPSD JSON format
@@ -54,7 +206,65 @@ bool is_nmea0183(const std::string& data);
  * \param data String to check
  * \return True if appears to be GPSD JSON format
  */
-bool is_gpsd_json(const std::string& data);
+bool is_gpsd_json(std::string_view data);
+
+/*!
+ * \brief Strip leading and trailing whitespace (including CR/LF) without copying
+ */
+std::string_view trim_gps_data(std::string_view data);
+
+/*!
+ * \brief Split an NMEA0183 sentence into comma separated fields in place
+ *
+ * The checksum suffix ("*hh") is not part of the last field. Fields are views
+ * into \p sentence; nothing is allocated.
+ *
+ * \param sentence NMEA0183 sentence, starting with '$'
+ * \param fields Output array of field views
+ * \param max_fields Capacity of \p fields
+ * \return Number of fields stored
+ */
+size_t split_nmea_fields(std::string_view sentence,
+                         std::string_view* fields,
+                         size_t max_fields);
+
+/*!
+ * \brief Parse a decimal number from a field view
+ *
+ * \return True if at least one character was consumed and the value is
+ *         finite and in range of the result type
+ */
+bool parse_float_field(std::string_view field, float& value);
+bool parse_double_field(std::string_view field, double& value);
+
+/*!
+ * \brief A speed the receiver can act on
+ *
+ * \return \p speed_kmh as float, or -1.0 if it is negative, NaN or out of
+ *         float range
+ */
+float checked_speed_kmh(double speed_kmh);
+
+/*!
+ * \brief Convert an NMEA "hhmmss.sss" time field to seconds since midnight
+ *
+ * \return True if the field holds a valid time of day
+ */
+bool parse_nmea_time(std::string_view field, double& seconds_of_day);
+
+/*!
+ * \brief Convert an NMEA "ddmmyy" date field to days since 1970-01-01
+ *
+ * \return True if the field holds a valid date
+ */
+bool parse_nmea_date(std::string_view field, long& days);
+
+/*!
+ * \brief Convert an ISO 8601 UTC time ("2024-01-01T12:00:00.000Z") to Unix time
+ *
+ * \return True if the string holds a valid timestamp
+ */
+bool parse_iso8601_time(std::string_view text, double& unix_time);
 
 } // namespace rake_receiver
 } // namespace gr
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gps_replay.h"
+#include <gnuradio/rake_receiver/gps_log.h>
+#include <algorithm>
+#include <cmath>
+
+namespace gr {
+namespace rake_receiver {
+
+gps_replay::gps_replay() : d_start_time(0.0), d_next(0) {}
+
+size_t gps_replay::load(const std::string& path, double start_time)
+{
+    gps_log log = parse_gps_log_file(path);
+
+    // Index only fixes with both a time and a usable speed, in time order
+    std::vector<size_t> order;
+    order.reserve(log.size());
+    for (size_t i = 0; i < log.size(); i++) {
+        if (log.valid[i] && !std::isnan(log.timestamps[i])) {
+            order.push_back(i);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&log](size_t a, size_t b) {
+        return log.timestamps[a] < log.timestamps[b];
+    });
+
+    d_times.resize(order.size());
+    d_speeds.resize(order.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        d_times[i] = log.timestamps[order[i]];
+        d_speeds[i] = log.speeds_kmh[order[i]];
+    }
+    d_next = 0;
+    d_start_time = (start_time >= 0.0 || d_times.empty()) ? start_time : d_times[0];
+    return d_times.size();
+}
+
+void gps_replay::clear()
+{
+    d_times.clear();
+    d_speeds.clear();
+    d_next = 0;
+}
+
+uint64_t gps_replay::offset(size_t index, double sample_rate) const
+{
+    // Fixes logged before sample 0 are due immediately
+    double samples = (d_times[index] - d_start_time) * sample_rate;
+    return samples > 0.0 ? static_cast<uint64_t>(std::llround(samples)) : 0;
+}
+
+} // namespace rake_receiver
+} // namespace gr
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef INCLUDED_RAKE_RECEIVER_GPS_REPLAY_H
+#define INCLUDED_RAKE_RECEIVER_GPS_REPLAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gr {
+namespace rake_receiver {
+
+/*!
+ * \brief Recorded GPS speed fixes scheduled against a sample stream
+ *
+ * A log (NMEA0183, gpsd JSON or UBX) is parsed once into a time-sorted index
+ * of valid fixes. Fix i is due at sample (t_i - start_time) * sample_rate, so
+ * a recording replays in step with IQ captured at the same time.
+ */
+class gps_replay
+{
+public:
+    gps_replay();
+
+    /*!
+     * \brief Index the valid fixes of a log file
+     *
+     * \param path Log file, memory-mapped while it is parsed
+     * \param start_time Log time of sample 0 (s); negative uses the first fix
+     * \return Number of fixes indexed
+     */
+    size_t load(const std::string& path, double start_time);
+
+    void clear();
+    bool loaded() const { return !d_times.empty(); }
+    size_t size() const { return d_times.size(); }
+    size_t remaining() const { return d_times.size() - d_next; }
+
+    //! Sample offset at which fix \p index is due
+    uint64_t offset(size_t index, double sample_rate) const;
+
+    //! True if the next unplayed fix is due before sample \p end
+    bool due_before(uint64_t end, double sample_rate) const
+    {
+        return d_next < d_times.size() && offset(d_next, sample_rate) < end;
+    }
+
+    size_t next() const { return d_next; }
+    float speed(size_t index) const { return d_speeds[index]; }
+    void advance() { d_next++; }
+
+private:
+    double d_start_time;
+    size_t d_next;
+    std::vector<double> d_times;
+    std::vector<float> d_speeds;
+};
+
+} // namespace rake_receiver
+} // namespace gr
+
+#endif /* INCLUDED_RAKE_RECEIVER_GPS_REPLAY_H */
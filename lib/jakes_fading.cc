@@ -0,0 +1,151 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "jakes_fading.h"
+#include <cmath>
+#include <random>
+
+namespace gr {
+namespace rake_receiver {
+
+namespace {
+
+// Rounding lets the phasors drift off the unit circle; rescale this often
+constexpr int normalize_interval = 1024;
+
+void rotate(std::vector<float>& re,
+            std::vector<float>& im,
+            const std::vector<float>& step_re,
+            const std::vector<float>& step_im)
+{
+    const size_t n = re.size();
+    for (size_t i = 0; i < n; i++) {
+        float r = re[i] * step_re[i] - im[i] * step_im[i];
+        float j = re[i] * step_im[i] + im[i] * step_re[i];
+        re[i] = r;
+        im[i] = j;
+    }
+}
+
+void normalize(std::vector<float>& re, std::vector<float>& im)
+{
+    for (size_t i = 0; i < re.size(); i++) {
+        float scale = 1.0f / std::sqrt(re[i] * re[i] + im[i] * im[i]);
+        re[i] *= scale;
+        im[i] *= scale;
+    }
+}
+
+} // namespace
+
+jakes_fading::jakes_fading(const std::vector<float>& powers,
+                           const std::vector<float>& k_factors,
+                           int num_sinusoids,
+                           uint32_t seed)
+    : d_num_sinusoids(num_sinusoids), d_since_normalize(0)
+{
+    const size_t taps = powers.size();
+    const size_t total = taps * num_sinusoids;
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> angle(-M_PI, M_PI);
+
+    d_cos_alpha.resize(total);
+    d_sin_alpha.resize(total);
+    d_i_re.resize(total);
+    d_i_im.resize(total);
+    d_q_re.resize(total);
+    d_q_im.resize(total);
+    for (size_t tap = 0; tap < taps; tap++) {
+        float theta = angle(rng);
+        for (int m = 0; m < num_sinusoids; m++) {
+            size_t i = tap * num_sinusoids + m;
+            float alpha = (2.0f * M_PI * (m + 1) - M_PI + theta) / (4.0f * num_sinusoids);
+            d_cos_alpha[i] = std::cos(alpha);
+            d_sin_alpha[i] = std::sin(alpha);
+            float phi = angle(rng);
+            float psi = angle(rng);
+            d_i_re[i] = std::cos(phi);
+            d_i_im[i] = std::sin(phi);
+            d_q_re[i] = std::cos(psi);
+            d_q_im[i] = std::sin(psi);
+        }
+
+        float k = k_factors[tap];
+        d_scatter_amplitude.push_back(
+            std::sqrt(powers[tap] / (k + 1.0f) / num_sinusoids));
+        d_los_amplitude.push_back(std::sqrt(powers[tap] * k / (k + 1.0f)));
+        d_los.push_back(std::polar(1.0f, angle(rng)));
+        d_los_cos.push_back(std::cos(angle(rng)));
+    }
+
+    d_coefficients.resize(taps);
+    set_doppler(0.0, 1);
+}
+
+void jakes_fading::set_doppler(double max_doppler, int spacing)
+{
+    const double w = 2.0 * M_PI * max_doppler * spacing;
+    const size_t total = d_cos_alpha.size();
+    d_i_step_re.resize(total);
+    d_i_step_im.resize(total);
+    d_q_step_re.resize(total);
+    d_q_step_im.resize(total);
+    for (size_t i = 0; i < total; i++) {
+        d_i_step_re[i] = std::cos(w * d_cos_alpha[i]);
+        d_i_step_im[i] = std::sin(w * d_cos_alpha[i]);
+        d_q_step_re[i] = std::cos(w * d_sin_alpha[i]);
+        d_q_step_im[i] = std::sin(w * d_sin_alpha[i]);
+    }
+    d_los_step.resize(d_los.size());
+    for (size_t tap = 0; tap < d_los.size(); tap++) {
+        d_los_step[tap] = std::polar(1.0f, static_cast<float>(w * d_los_cos[tap]));
+    }
+    update_coefficients();
+}
+
+void jakes_fading::advance()
+{
+    rotate(d_i_re, d_i_im, d_i_step_re, d_i_step_im);
+    rotate(d_q_re, d_q_im, d_q_step_re, d_q_step_im);
+    for (size_t tap = 0; tap < d_los.size(); tap++) {
+        d_los[tap] *= d_los_step[tap];
+    }
+    if (++d_since_normalize == normalize_interval) {
+        normalize(d_i_re, d_i_im);
+        normalize(d_q_re, d_q_im);
+        for (auto& los : d_los) {
+            los /= std::abs(los);
+        }
+        d_since_normalize = 0;
+    }
+    update_coefficients();
+}
+
+void jakes_fading::update_coefficients()
+{
+    for (size_t tap = 0; tap < d_los.size(); tap++) {
+        const size_t first = tap * d_num_sinusoids;
+        float i_sum = 0.0f;
+        float q_sum = 0.0f;
+        for (int m = 0; m < d_num_sinusoids; m++) {
+            i_sum += d_i_re[first + m];
+            q_sum += d_q_re[first + m];
+        }
+        d_coefficients[tap] =
+            d_los_amplitude[tap] * d_los[tap] +
+            d_scatter_amplitude[tap] * gr_complex(i_sum, q_sum);
+    }
+}
+
+} // namespace rake_receiver
+} // namespace gr
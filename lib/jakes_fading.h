@@ -0,0 +1,97 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef INCLUDED_RAKE_RECEIVER_JAKES_FADING_H
+#define INCLUDED_RAKE_RECEIVER_JAKES_FADING_H
+
+#include <gnuradio/gr_complex.h>
+#include <cstdint>
+#include <vector>
+
+namespace gr {
+namespace rake_receiver {
+
+/*!
+ * \brief Sum-of-sinusoids Rayleigh/Rician fading for a set of taps
+ *
+ * Each tap follows the Zheng-Xiao variant of Jakes' model:
+ *
+ *   h = sqrt(P) * ( sqrt(K/(K+1)) e^{j(w_d cos(theta0) t + phi0)}
+ *                 + sqrt(1/(K+1)) sqrt(1/M) sum_m [cos(w_d cos(a_m) t + phi_m)
+ *                                               + j cos(w_d sin(a_m) t + psi_m)] )
+ *
+ * with a_m = (2 pi m - pi + theta) / (4 M) and random theta, phi_m, psi_m
+ * per tap, so E|h|^2 = P and the autocorrelation approaches J0(w_d tau).
+ * K = 0 is Rayleigh fading.
+ *
+ * The coefficients are produced on a grid of points a fixed number of
+ * samples apart. Every sinusoid is a unit phasor turned by a precomputed
+ * step once per point, so a point costs a complex multiply per sinusoid and
+ * no trigonometry. The phasors of all taps sit in flat arrays, which the
+ * compiler vectorizes.
+ */
+class jakes_fading
+{
+public:
+    /*!
+     * \param powers Mean power of each tap (linear)
+     * \param k_factors Rician K of each tap (linear), 0 for Rayleigh
+     * \param num_sinusoids Sinusoids per quadrature branch (M)
+     * \param seed Seed of the random angles and phases
+     */
+    jakes_fading(const std::vector<float>& powers,
+                 const std::vector<float>& k_factors,
+                 int num_sinusoids,
+                 uint32_t seed);
+
+    /*!
+     * \brief Set the Doppler rate and the grid spacing
+     *
+     * Keeps the current phases, so the fading continues without a jump.
+     *
+     * \param max_doppler Maximum Doppler frequency in cycles per sample
+     * \param spacing Samples between grid points
+     */
+    void set_doppler(double max_doppler, int spacing);
+
+    size_t num_taps() const { return d_los.size(); }
+
+    //! Coefficients at the current grid point
+    const std::vector<gr_complex>& coefficients() const { return d_coefficients; }
+
+    //! Move to the next grid point
+    void advance();
+
+private:
+    void update_coefficients();
+
+    int d_num_sinusoids;
+    std::vector<float> d_cos_alpha;
+    std::vector<float> d_sin_alpha;
+    std::vector<float> d_scatter_amplitude;
+
+    // Phasors of the in-phase and quadrature sinusoids, taps one after the
+    // other, and the per-point steps that turn them
+    std::vector<float> d_i_re, d_i_im, d_q_re, d_q_im;
+    std::vector<float> d_i_step_re, d_i_step_im, d_q_step_re, d_q_step_im;
+
+    // Line of sight per tap: amplitude, direction and unit phasor
+    std::vector<float> d_los_amplitude;
+    std::vector<float> d_los_cos;
+    std::vector<gr_complex> d_los;
+    std::vector<gr_complex> d_los_step;
+
+    std::vector<gr_complex> d_coefficients;
+    int d_since_normalize;
+};
+
+} // namespace rake_receiver
+} // namespace gr
+
+#endif /* INCLUDED_RAKE_RECEIVER_JAKES_FADING_H */
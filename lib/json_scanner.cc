@@ -0,0 +1,117 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "json_scanner.h"
+
+namespace gr {
+namespace rake_receiver {
+
+namespace {
+
+// Position just past the string whose opening quote is at json[pos]
+bool skip_json_string(std::string_view json, size_t& pos)
+{
+    for (pos++; pos < json.size(); pos++) {
+        if (json[pos] == '\\') {
+            pos++;
+        } else if (json[pos] == '"') {
+            pos++;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+void skip_json_space(std::string_view json, size_t& pos)
+{
+    while (pos < json.size() && (json[pos] == ' ' || json[pos] == '\t' ||
+                                 json[pos] == '\n' || json[pos] == '\r')) {
+        pos++;
+    }
+}
+
+bool scan_json_value(std::string_view json,
+                     size_t& pos,
+                     json_type& type,
+                     std::string_view& value)
+{
+    skip_json_space(json, pos);
+    if (pos >= json.size()) {
+        return false;
+    }
+
+    size_t start = pos;
+    char c = json[pos];
+
+    if (c == '"') {
+        if (!skip_json_string(json, pos)) {
+            return false;
+        }
+        type = json_type::string;
+        value = json.substr(start + 1, pos - start - 2);
+        return true;
+    }
+
+    if (c == '{' || c == '[') {
+        // Skip the whole container, honouring strings that contain brackets
+        int depth = 0;
+        while (pos < json.size()) {
+            char d = json[pos];
+            if (d == '"') {
+                if (!skip_json_string(json, pos)) {
+                    return false;
+                }
+                continue;
+            }
+            if (d == '{' || d == '[') {
+                depth++;
+            } else if (d == '}' || d == ']') {
+                if (--depth == 0) {
+                    pos++;
+                    type = (c == '{') ? json_type::object : json_type::array;
+                    value = json.substr(start, pos - start);
+                    return true;
+                }
+            }
+            pos++;
+        }
+        return false;
+    }
+
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        while (pos < json.size() &&
+               ((json[pos] >= '0' && json[pos] <= '9') || json[pos] == '-' ||
+                json[pos] == '+' || json[pos] == '.' || json[pos] == 'e' ||
+                json[pos] == 'E')) {
+            pos++;
+        }
+        type = json_type::number;
+        value = json.substr(start, pos - start);
+        return true;
+    }
+
+    for (std::string_view literal : { "true", "false", "null" }) {
+        if (json.compare(pos, literal.size(), literal) == 0) {
+            pos += literal.size();
+            type = json_type::literal;
+            value = literal;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace rake_receiver
+} // namespace gr
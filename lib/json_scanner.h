@@ -0,0 +1,133 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef INCLUDED_RAKE_RECEIVER_JSON_SCANNER_H
+#define INCLUDED_RAKE_RECEIVER_JSON_SCANNER_H
+
+#include <cstddef>
+#include <string_view>
+
+namespace gr {
+namespace rake_receiver {
+
+enum class json_type { string, number, object, array, literal };
+
+/*!
+ * \brief Scan one JSON value starting at \p pos (leading whitespace allowed)
+ *
+ * Nothing is decoded or allocated: \p value is a view into \p json holding the
+ * string contents without quotes (escapes left as-is), or the raw text of a
+ * number, literal, object or array. On success \p pos is left just past the
+ * value.
+ *
+ * \return False if the input is not a well-formed value
+ */
+bool scan_json_value(std::string_view json,
+                     size_t& pos,
+                     json_type& type,
+                     std::string_view& value);
+
+//! Advance \p pos past JSON whitespace
+void skip_json_space(std::string_view json, size_t& pos);
+
+/*!
+ * \brief Walk the members of a JSON object in a single pass, SAX style
+ *
+ * Calls \p on_member(key, type, value) for each top-level member; nested
+ * objects and arrays are handed over as raw views and not descended into.
+ * The walk stops early when the handler returns false.
+ *
+ * \return False if the object is malformed before the walk stopped
+ */
+template <typename Handler>
+bool scan_json_object(std::string_view json, Handler&& on_member)
+{
+    size_t pos = 0;
+    skip_json_space(json, pos);
+    if (pos >= json.size() || json[pos] != '{') {
+        return false;
+    }
+    pos++;
+    skip_json_space(json, pos);
+    if (pos < json.size() && json[pos] == '}') {
+        return true;
+    }
+
+    while (pos < json.size()) {
+        json_type key_type, type;
+        std::string_view key, value;
+        if (!scan_json_value(json, pos, key_type, key) || key_type != json_type::string) {
+            return false;
+        }
+        skip_json_space(json, pos);
+        if (pos >= json.size() || json[pos] != ':') {
+            return false;
+        }
+        pos++;
+        if (!scan_json_value(json, pos, type, value)) {
+            return false;
+        }
+        if (!on_member(key, type, value)) {
+            return true;
+        }
+        skip_json_space(json, pos);
+        if (pos < json.size() && json[pos] == ',') {
+            pos++;
+            continue;
+        }
+        return pos < json.size() && json[pos] == '}';
+    }
+    return false;
+}
+
+/*!
+ * \brief Walk the elements of a JSON array in a single pass
+ *
+ * Calls \p on_element(type, value) for each element; stops early when the
+ * handler returns false.
+ *
+ * \return False if the array is malformed before the walk stopped
+ */
+template <typename Handler>
+bool scan_json_array(std::string_view json, Handler&& on_element)
+{
+    size_t pos = 0;
+    skip_json_space(json, pos);
+    if (pos >= json.size() || json[pos] != '[') {
+        return false;
+    }
+    pos++;
+    skip_json_space(json, pos);
+    if (pos < json.size() && json[pos] == ']') {
+        return true;
+    }
+
+    while (pos < json.size()) {
+        json_type type;
+        std::string_view value;
+        if (!scan_json_value(json, pos, type, value)) {
+            return false;
+        }
+        if (!on_element(type, value)) {
+            return true;
+        }
+        skip_json_space(json, pos);
+        if (pos < json.size() && json[pos] == ',') {
+            pos++;
+            continue;
+        }
+        return pos < json.size() && json[pos] == ']';
+    }
+    return false;
+}
+
+} // namespace rake_receiver
+} // namespace gr
+
+#endif /* INCLUDED_RAKE_RECEIVER_JSON_SCANNER_H */
@@ -0,0 +1,266 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "kernel_autotune.h"
+#include <gnuradio/sys_paths.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+
+namespace gr {
+namespace rake_receiver {
+
+namespace {
+
+const char profile_header[] =
+    "# rake_receiver kernel profile, written by set_kernel(\"auto\")\n"
+    "# cpu_model<TAB>workload<TAB>fingers<TAB>pattern_length<TAB>spread<TAB>kernel\n"
+    "# Delete a line, or the file, to tune again\n";
+
+// Shortest timed run per kernel and round
+constexpr double min_round_s = 2e-3;
+constexpr int rounds = 3;
+
+int spread_bucket(int spread)
+{
+    int bucket = 1;
+    while (bucket < spread && bucket < (1 << 30)) {
+        bucket <<= 1;
+    }
+    return spread > 0 ? bucket : 0;
+}
+
+std::vector<std::string> read_lines(const std::string& path)
+{
+    std::vector<std::string> lines;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+// Entry lines are "key<TAB>kernel"; comments and blank lines match nothing
+bool split_entry(const std::string& line, std::string& key, std::string& kernel)
+{
+    if (line.empty() || line[0] == '#') {
+        return false;
+    }
+    size_t tab = line.rfind('\t');
+    if (tab == std::string::npos) {
+        return false;
+    }
+    key = line.substr(0, tab);
+    kernel = line.substr(tab + 1);
+    return true;
+}
+
+} // namespace
+
+std::string autotune_key::to_string() const
+{
+    return cpu_model + '\t' + workload + '\t' + std::to_string(fingers) + '\t' +
+           std::to_string(pattern_length) + '\t' + std::to_string(spread);
+}
+
+autotune_key make_autotune_key(bool sparse, int fingers, int pattern_length, int spread)
+{
+    // The sparse delay line runs one correlation whatever the fingers
+    if (sparse) {
+        return { host_cpu_model(), "correlate", 1, pattern_length, 0 };
+    }
+    return {
+        host_cpu_model(), "combine", fingers, pattern_length, spread_bucket(spread)
+    };
+}
+
+const std::string& host_cpu_model()
+{
+    static const std::string model = [] {
+        std::ifstream in("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.compare(0, 10, "model name") != 0) {
+                continue;
+            }
+            size_t colon = line.find(':');
+            size_t start = line.find_first_not_of(" \t", colon + 1);
+            if (colon == std::string::npos || start == std::string::npos) {
+                break;
+            }
+            std::string name = line.substr(start);
+            // Tabs separate the profile fields
+            std::replace(name.begin(), name.end(), '\t', ' ');
+            return name;
+        }
+        return std::string("unknown");
+    }();
+    return model;
+}
+
+std::string default_kernel_profile()
+{
+    if (const char* path = std::getenv("RAKE_RECEIVER_PROFILE")) {
+        return path;
+    }
+    return (std::filesystem::path(gr::paths::userconf()) / "rake_receiver_profile")
+        .string();
+}
+
+std::vector<kernel_timing> time_kernels(const autotune_key& key)
+{
+    const bool correlate = key.workload == "correlate";
+    const int fingers = std::max(key.fingers, 1);
+    const int pattern_length = std::max(key.pattern_length, 1);
+    // About a million taps per run, so long patterns stay quick to time
+    const int block = std::clamp((1 << 20) / (fingers * pattern_length), 64, 4096);
+
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    std::vector<gr_complex> windows(block + key.spread + pattern_length - 1);
+    for (auto& x : windows) {
+        x = gr_complex(noise(rng), noise(rng));
+    }
+    std::vector<gr_complex> pattern(pattern_length);
+    for (auto& p : pattern) {
+        // QPSK chips
+        float i_chip = noise(rng) > 0.0f ? 1.0f : -1.0f;
+        float q_chip = noise(rng) > 0.0f ? 1.0f : -1.0f;
+        p = gr_complex(i_chip, q_chip);
+    }
+    std::vector<int> delays(fingers);
+    for (int f = 0; f < fingers; f++) {
+        delays[f] =
+            fingers > 1 ? static_cast<int>(int64_t(key.spread) * f / (fingers - 1)) : 0;
+    }
+    std::vector<float> gains(fingers, 1.0f / fingers);
+    std::vector<gr_complex> out(block);
+
+    auto run = [&](const rake_kernel& kernel) {
+        if (correlate) {
+            rake_correlate(kernel,
+                           windows.data(),
+                           pattern.data(),
+                           pattern_length,
+                           out.data(),
+                           block);
+        } else {
+            rake_combine(kernel,
+                         windows.data(),
+                         delays.data(),
+                         gains.data(),
+                         fingers,
+                         pattern.data(),
+                         pattern_length,
+                         out.data(),
+                         block);
+        }
+    };
+
+    std::vector<kernel_timing> timings;
+    for (const rake_kernel& kernel : rake_kernels()) {
+        // Warms the caches and VOLK's dispatcher
+        run(kernel);
+        timings.push_back({ &kernel, std::numeric_limits<double>::infinity() });
+    }
+
+    using clock = std::chrono::steady_clock;
+    for (int round = 0; round < rounds; round++) {
+        for (kernel_timing& timing : timings) {
+            int runs = 0;
+            double seconds = 0.0;
+            const auto start = clock::now();
+            do {
+                run(*timing.kernel);
+                runs++;
+                seconds = std::chrono::duration<double>(clock::now() - start).count();
+            } while (seconds < min_round_s);
+            timing.ns_per_output =
+                std::min(timing.ns_per_output, seconds * 1e9 / (double(runs) * block));
+        }
+    }
+
+    std::stable_sort(timings.begin(),
+                     timings.end(),
+                     [](const kernel_timing& a, const kernel_timing& b) {
+                         return a.ns_per_output < b.ns_per_output;
+                     });
+    return timings;
+}
+
+const rake_kernel* lookup_kernel_profile(const std::string& path,
+                                         const autotune_key& key)
+{
+    const std::string wanted = key.to_string();
+    const rake_kernel* found = nullptr;
+    std::string entry_key, kernel;
+    for (const std::string& line : read_lines(path)) {
+        // A later line wins, like a later store would
+        if (split_entry(line, entry_key, kernel) && entry_key == wanted) {
+            found = find_rake_kernel(kernel);
+        }
+    }
+    return found;
+}
+
+void store_kernel_profile(const std::string& path,
+                          const autotune_key& key,
+                          const rake_kernel& kernel)
+{
+    // Blocks in one flowgraph tune at the same start()
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const std::string wanted = key.to_string();
+    std::string contents = profile_header;
+    std::string entry_key, entry_kernel;
+    for (const std::string& line : read_lines(path)) {
+        if (split_entry(line, entry_key, entry_kernel) && entry_key != wanted) {
+            contents += line + '\n';
+        }
+    }
+    contents += wanted + '\t' + kernel.name + '\n';
+
+    const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    std::error_code ec;
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, ec);
+    }
+
+    // Write next to the target and rename, so readers never see half a file
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::trunc);
+        out << contents;
+        out.close();
+        if (!out) {
+            std::remove(tmp_path.c_str());
+            throw std::runtime_error("Cannot write kernel profile: " + tmp_path);
+        }
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        throw std::runtime_error("Cannot replace kernel profile: " + path);
+    }
+}
+
+} // namespace rake_receiver
+} // namespace gr
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef INCLUDED_RAKE_RECEIVER_KERNEL_AUTOTUNE_H
+#define INCLUDED_RAKE_RECEIVER_KERNEL_AUTOTUNE_H
+
+#include "rake_kernels.h"
+#include <string>
+#include <vector>
+
+namespace gr {
+namespace rake_receiver {
+
+/*!
+ * \brief What a kernel choice was tuned for
+ *
+ * "combine" is rake_combine() over all fingers (history and ring delay line),
+ * "correlate" the single correlation of the sparse delay line. The spread is
+ * rounded up to a power of two so that small delay changes share an entry.
+ */
+struct autotune_key {
+    std::string cpu_model;
+    std::string workload;
+    int fingers;
+    int pattern_length;
+    int spread;
+
+    //! One profile line without the kernel: fields separated by tabs
+    std::string to_string() const;
+};
+
+autotune_key make_autotune_key(bool sparse, int fingers, int pattern_length, int spread);
+
+//! "model name" from /proc/cpuinfo, or "unknown"
+const std::string& host_cpu_model();
+
+//! $RAKE_RECEIVER_PROFILE, else rake_receiver_profile in the GNU Radio config dir
+std::string default_kernel_profile();
+
+struct kernel_timing {
+    const rake_kernel* kernel;
+    double ns_per_output;
+};
+
+/*!
+ * \brief Time every kernel on synthetic data shaped like \p key
+ *
+ * QPSK pattern, Gaussian input, fingers spread evenly over the spread.
+ * Each kernel gets the best of three short runs, interleaved so that clock
+ * changes hit all of them alike. Fastest first.
+ */
+std::vector<kernel_timing> time_kernels(const autotune_key& key);
+
+/*!
+ * \brief Kernel stored for \p key in the profile at \p path
+ *
+ * \return nullptr if the file, the entry or the named kernel is missing
+ */
+const rake_kernel* lookup_kernel_profile(const std::string& path,
+                                         const autotune_key& key);
+
+/*!
+ * \brief Record \p kernel for \p key, replacing an older entry
+ *
+ * The file is re-read first so entries written by other blocks survive, and
+ * replaced by rename. Throws std::runtime_error if it cannot be written.
+ */
+void store_kernel_profile(const std::string& path,
+                          const autotune_key& key,
+                          const rake_kernel& kernel);
+
+} // namespace rake_receiver
+} // namespace gr
+
+#endif /* INCLUDED_RAKE_RECEIVER_KERNEL_AUTOTUNE_H */
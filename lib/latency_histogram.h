@@ -0,0 +1,84 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef INCLUDED_RAKE_RECEIVER_LATENCY_HISTOGRAM_H
+#define INCLUDED_RAKE_RECEIVER_LATENCY_HISTOGRAM_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace gr {
+namespace rake_receiver {
+
+/*!
+ * \brief Log-spaced histogram of latencies in nanoseconds
+ *
+ * Eight bins per octave from 1 ns to about 18 minutes, so a percentile is
+ * reported to within 9% with a fixed 2.5 kB and no allocation. The maximum
+ * is kept exactly.
+ */
+class latency_histogram
+{
+public:
+    static constexpr int bins_per_octave = 8;
+    static constexpr int num_bins = 40 * bins_per_octave;
+
+    latency_histogram() { reset(); }
+
+    void reset()
+    {
+        d_bins.fill(0);
+        d_count = 0;
+        d_max_ns = 0;
+    }
+
+    void add(uint64_t latency_ns)
+    {
+        int bin = latency_ns > 1
+                      ? static_cast<int>(bins_per_octave *
+                                         std::log2(static_cast<double>(latency_ns)))
+                      : 0;
+        d_bins[std::min(bin, num_bins - 1)]++;
+        d_count++;
+        d_max_ns = std::max(d_max_ns, latency_ns);
+    }
+
+    uint64_t count() const { return d_count; }
+    uint64_t max_ns() const { return d_max_ns; }
+
+    //! Upper edge of the bin holding quantile \p q (0-1), capped at the maximum
+    double quantile_ns(double q) const
+    {
+        if (d_count == 0) {
+            return 0.0;
+        }
+        const double rank = std::max(1.0, std::ceil(q * d_count));
+        uint64_t seen = 0;
+        for (int bin = 0; bin < num_bins; bin++) {
+            seen += d_bins[bin];
+            if (seen >= rank) {
+                double edge = std::exp2(static_cast<double>(bin + 1) / bins_per_octave);
+                return std::min(edge, static_cast<double>(d_max_ns));
+            }
+        }
+        return static_cast<double>(d_max_ns);
+    }
+
+private:
+    std::array<uint64_t, num_bins> d_bins;
+    uint64_t d_count;
+    uint64_t d_max_ns;
+};
+
+} // namespace rake_receiver
+} // namespace gr
+
+#endif /* INCLUDED_RAKE_RECEIVER_LATENCY_HISTOGRAM_H */
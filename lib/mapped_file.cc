@@ -0,0 +1,72 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "mapped_file.h"
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gr {
+namespace rake_receiver {
+
+mapped_file::mapped_file(const std::string& path)
+    : d_data(nullptr), d_size(0), d_mapped(false)
+{
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* addr =
+            ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            d_data = static_cast<const char*>(addr);
+            d_size = static_cast<size_t>(st.st_size);
+            d_mapped = true;
+        }
+    }
+    ::close(fd);
+    if (d_mapped || (::stat(path.c_str(), &st) == 0 && st.st_size == 0)) {
+        return;
+    }
+#endif
+    // No mmap (or it failed): read the file into memory instead
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    d_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    d_data = d_buffer.data();
+    d_size = d_buffer.size();
+}
+
+mapped_file::~mapped_file()
+{
+#ifndef _WIN32
+    if (d_mapped) {
+        ::munmap(const_cast<char*>(d_data), d_size);
+    }
+#endif
+}
+
+} // namespace rake_receiver
+} // namespace gr
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef INCLUDED_RAKE_RECEIVER_MAPPED_FILE_H
+#define INCLUDED_RAKE_RECEIVER_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace gr {
+namespace rake_receiver {
+
+/*!
+ * \brief Read-only view of a whole file, memory-mapped where the platform allows
+ *
+ * Falls back to reading the file into memory when mmap is not available.
+ * Throws std::runtime_error if the file cannot be opened.
+ */
+class mapped_file
+{
+public:
+    explicit mapped_file(const std::string& path);
+    ~mapped_file();
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    const char* data() const { return d_data; }
+    size_t size() const { return d_size; }
+
+private:
+    const char* d_data;
+    size_t d_size;
+    bool d_mapped;
+    std::vector<char> d_buffer;
+};
+
+} // namespace rake_receiver
+} // namespace gr
+
+#endif /* INCLUDED_RAKE_RECEIVER_MAPPED_FILE_H */
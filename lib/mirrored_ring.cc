@@ -0,0 +1,54 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "mirrored_ring.h"
+#include <algorithm>
+
+namespace gr {
+namespace rake_receiver {
+
+void mirrored_ring::resize(size_t samples)
+{
+    size_t capacity = 1;
+    while (capacity < samples) {
+        capacity <<= 1;
+    }
+    d_mask = capacity - 1;
+    d_write = 0;
+    d_buffer.assign(2 * capacity, gr_complex(0.0f, 0.0f));
+}
+
+void mirrored_ring::clear()
+{
+    std::fill(d_buffer.begin(), d_buffer.end(), gr_complex(0.0f, 0.0f));
+    d_write = 0;
+}
+
+void mirrored_ring::push(const gr_complex* samples, size_t count)
+{
+    const size_t capacity = d_mask + 1;
+    size_t pos = d_write & d_mask;
+    // At most two runs: up to the end of the ring, then from its start
+    while (count > 0) {
+        size_t run = std::min(count, capacity - pos);
+        std::copy(samples, samples + run, &d_buffer[pos]);
+        std::copy(samples, samples + run, &d_buffer[pos + capacity]);
+        samples += run;
+        count -= run;
+        d_write += run;
+        pos = 0;
+    }
+}
+
+} // namespace rake_receiver
+} // namespace gr
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef INCLUDED_RAKE_RECEIVER_MIRRORED_RING_H
+#define INCLUDED_RAKE_RECEIVER_MIRRORED_RING_H
+
+#include <gnuradio/gr_complex.h>
+#include <cstddef>
+#include <vector>
+
+namespace gr {
+namespace rake_receiver {
+
+/*!
+ * \brief Power-of-two circular sample buffer with a mirrored second half
+ *
+ * Every sample is stored twice, at i and i + capacity(), so the most recent
+ * capacity() samples can always be read as one contiguous array without
+ * wrap checks.
+ */
+class mirrored_ring
+{
+public:
+    mirrored_ring() : d_mask(0), d_write(0) {}
+
+    //! Allocate room for at least \p samples samples and zero the contents
+    void resize(size_t samples);
+
+    //! Zero the contents, keeping the capacity
+    void clear();
+
+    size_t capacity() const { return d_mask + 1; }
+    bool empty() const { return d_buffer.empty(); }
+
+    //! Append \p count samples; \p count must not exceed capacity()
+    void push(const gr_complex* samples, size_t count);
+
+    /*!
+     * \brief The last \p count samples pushed, oldest first
+     *
+     * The pointer stays valid until the next push(); \p count must not
+     * exceed capacity().
+     */
+    const gr_complex* last(size_t count) const
+    {
+        return &d_buffer[(d_write - count) & d_mask];
+    }
+
+private:
+    size_t d_mask;
+    size_t d_write;
+    std::vector<gr_complex> d_buffer;
+};
+
+} // namespace rake_receiver
+} // namespace gr
+
+#endif /* INCLUDED_RAKE_RECEIVER_MIRRORED_RING_H */
@@ -0,0 +1,319 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/io_signature.h>
+#include <pmt/pmt.h>
+#include "multipath_channel_cc_impl.h"
+#include "gps_parser.h"
+#include "speed_message.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+namespace gr {
+namespace rake_receiver {
+
+namespace {
+
+constexpr double speed_of_light = 299792458.0;
+
+// Grid points per Doppler period; linear interpolation between them is
+// within 0.5% of the fading
+constexpr double points_per_period = 32.0;
+constexpr int max_spacing = 4096;
+
+// Speeds that give a finite Doppler frequency
+bool usable_speed(float speed_kmh) { return checked_speed_kmh(speed_kmh) >= 0.0f; }
+
+const pmt::pmt_t gps_speed_key()
+{
+    static const pmt::pmt_t k = pmt::mp("gps_speed");
+    return k;
+}
+
+const pmt::pmt_t speed_kmh_key()
+{
+    static const pmt::pmt_t k = pmt::mp("speed_kmh");
+    return k;
+}
+
+// Checks the tap description and returns the K factor of every tap
+std::vector<float> tap_k_factors(const std::vector<int>& delays,
+                                 const std::vector<float>& gains_db,
+                                 const std::vector<float>& k_factors)
+{
+    if (delays.empty()) {
+        throw std::invalid_argument("The channel needs at least one tap");
+    }
+    if (gains_db.size() != delays.size()) {
+        throw std::invalid_argument("Number of gains must match number of delays");
+    }
+    if (!k_factors.empty() && k_factors.size() != delays.size()) {
+        throw std::invalid_argument(
+            "Number of K factors must match number of delays, or be zero");
+    }
+    for (int delay : delays) {
+        if (delay < 0) {
+            throw std::invalid_argument("Tap delays must not be negative");
+        }
+    }
+    for (float k : k_factors) {
+        if (!(k >= 0.0f)) {
+            throw std::invalid_argument("Rician K factors must not be negative");
+        }
+    }
+    return k_factors.empty() ? std::vector<float>(delays.size(), 0.0f) : k_factors;
+}
+
+std::vector<float> tap_powers(const std::vector<float>& gains_db)
+{
+    std::vector<float> powers;
+    for (float gain_db : gains_db) {
+        powers.push_back(std::pow(10.0f, gain_db / 10.0f));
+    }
+    return powers;
+}
+
+} // namespace
+
+multipath_channel_cc::sptr multipath_channel_cc::make(const std::vector<int>& delays,
+                                                      const std::vector<float>& gains_db,
+                                                      const std::vector<float>& k_factors,
+                                                      double sample_rate,
+                                                      double carrier_freq,
+                                                      float speed_kmh,
+                                                      int num_sinusoids,
+                                                      uint32_t seed)
+{
+    return gnuradio::make_block_sptr<multipath_channel_cc_impl>(delays,
+                                                                gains_db,
+                                                                k_factors,
+                                                                sample_rate,
+                                                                carrier_freq,
+                                                                speed_kmh,
+                                                                num_sinusoids,
+                                                                seed);
+}
+
+multipath_channel_cc_impl::multipath_channel_cc_impl(const std::vector<int>& delays,
+                                                     const std::vector<float>& gains_db,
+                                                     const std::vector<float>& k_factors,
+                                                     double sample_rate,
+                                                     double carrier_freq,
+                                                     float speed_kmh,
+                                                     int num_sinusoids,
+                                                     uint32_t seed)
+    : gr::sync_block("multipath_channel_cc",
+                     gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                     gr::io_signature::make(1, 1, sizeof(gr_complex))),
+      d_delays(delays),
+      d_max_delay(0),
+      d_sample_rate(sample_rate),
+      d_carrier_freq(carrier_freq),
+      d_fading(tap_powers(gains_db),
+               tap_k_factors(delays, gains_db, k_factors),
+               std::max(num_sinusoids, 1),
+               seed ? seed : std::random_device()()),
+      d_speed_kmh(speed_kmh),
+      d_speed_changed(true),
+      d_spacing(1),
+      d_h(delays.size()),
+      d_slope(delays.size()),
+      d_remaining(0)
+{
+    if (!(sample_rate > 0.0)) {
+        throw std::invalid_argument("Sample rate must be positive");
+    }
+    if (!(carrier_freq >= 0.0)) {
+        throw std::invalid_argument("Carrier frequency must not be negative");
+    }
+    if (!usable_speed(speed_kmh)) {
+        throw std::invalid_argument("Speed must be finite and not negative");
+    }
+    if (num_sinusoids < 1) {
+        throw std::invalid_argument("Number of sinusoids must be at least 1");
+    }
+
+    d_max_delay = *std::max_element(d_delays.begin(), d_delays.end());
+    set_history(d_max_delay + 1);
+    // Tagged by the first work() call
+    update_doppler();
+
+    message_port_register_in(pmt::mp("speed"));
+    set_msg_handler(pmt::mp("speed"),
+                    [this](pmt::pmt_t msg) { this->handle_speed_message(msg); });
+}
+
+multipath_channel_cc_impl::~multipath_channel_cc_impl() {}
+
+void multipath_channel_cc_impl::set_speed(float speed_kmh)
+{
+    if (!usable_speed(speed_kmh)) {
+        throw std::invalid_argument("Speed must be finite and not negative");
+    }
+    gr::thread::scoped_lock guard(d_setlock);
+    d_speed_kmh = speed_kmh;
+    d_speed_changed = true;
+}
+
+float multipath_channel_cc_impl::speed() const { return d_speed_kmh; }
+
+double multipath_channel_cc_impl::max_doppler() const
+{
+    return d_speed_kmh / 3.6 / speed_of_light * d_carrier_freq;
+}
+
+std::vector<int> multipath_channel_cc_impl::delays() const { return d_delays; }
+
+size_t multipath_channel_cc_impl::load_gps_replay(const std::string& path,
+                                                  double start_time)
+{
+    gps_replay replay;
+    size_t fixes = replay.load(path, start_time);
+
+    gr::thread::scoped_lock guard(d_setlock);
+    d_gps_replay = std::move(replay);
+    return fixes;
+}
+
+void multipath_channel_cc_impl::clear_gps_replay()
+{
+    gr::thread::scoped_lock guard(d_setlock);
+    d_gps_replay.clear();
+}
+
+size_t multipath_channel_cc_impl::gps_replay_remaining() const
+{
+    return d_gps_replay.remaining();
+}
+
+void multipath_channel_cc_impl::handle_speed_message(pmt::pmt_t msg)
+{
+    float speed_kmh;
+    if (pmt::is_pair(msg) && pmt::is_symbol(pmt::car(msg)) &&
+        pmt::eq(pmt::car(msg), speed_kmh_key())) {
+        msg = pmt::cdr(msg);
+    } else if (pmt::is_dict(msg) && pmt::is_pair(msg) && pmt::is_pair(pmt::car(msg))) {
+        msg = pmt::dict_ref(msg, speed_kmh_key(), pmt::PMT_NIL);
+    }
+    if (!pmt_speed(msg, speed_kmh)) {
+        d_logger->warn("Ignoring speed message without a speed in km/h");
+        return;
+    }
+    set_speed(speed_kmh);
+}
+
+void multipath_channel_cc_impl::update_doppler()
+{
+    // The current segment keeps its slope; the new rate starts at the next
+    // grid point
+    const double doppler = max_doppler();
+    d_spacing = max_spacing;
+    if (doppler > 0.0) {
+        d_spacing = static_cast<int>(std::clamp(
+            d_sample_rate / (points_per_period * doppler), 1.0, double(max_spacing)));
+    }
+    d_fading.set_doppler(doppler / d_sample_rate, d_spacing);
+}
+
+void multipath_channel_cc_impl::apply_speed(uint64_t offset)
+{
+    // Caller holds d_setlock
+    update_doppler();
+    add_item_tag(
+        0, offset, gps_speed_key(), pmt::from_double(d_speed_kmh), pmt::mp(alias()));
+    d_speed_changed = false;
+}
+
+void multipath_channel_cc_impl::start_segment()
+{
+    const std::vector<gr_complex>& h = d_fading.coefficients();
+    std::copy(h.begin(), h.end(), d_h.begin());
+    d_fading.advance();
+    const float scale = 1.0f / d_spacing;
+    for (size_t tap = 0; tap < d_h.size(); tap++) {
+        d_slope[tap] = (h[tap] - d_h[tap]) * scale;
+    }
+    d_remaining = d_spacing;
+}
+
+void multipath_channel_cc_impl::process_span(const gr_complex* in,
+                                             gr_complex* out,
+                                             int count)
+{
+    // in[i + max_delay] is the input at output i
+    int done = 0;
+    while (done < count) {
+        if (d_remaining == 0) {
+            start_segment();
+        }
+        const int n = std::min(d_remaining, count - done);
+        float* o = reinterpret_cast<float*>(out + done);
+        std::fill(o, o + 2 * n, 0.0f);
+        for (size_t tap = 0; tap < d_h.size(); tap++) {
+            const float* x =
+                reinterpret_cast<const float*>(in + done + d_max_delay - d_delays[tap]);
+            const float h_re = d_h[tap].real();
+            const float h_im = d_h[tap].imag();
+            const float s_re = d_slope[tap].real();
+            const float s_im = d_slope[tap].imag();
+            // Written out in floats so the loop vectorizes
+            for (int i = 0; i < n; i++) {
+                const float c_re = h_re + s_re * i;
+                const float c_im = h_im + s_im * i;
+                o[2 * i] += c_re * x[2 * i] - c_im * x[2 * i + 1];
+                o[2 * i + 1] += c_re * x[2 * i + 1] + c_im * x[2 * i];
+            }
+            d_h[tap] += d_slope[tap] * static_cast<float>(n);
+        }
+        d_remaining -= n;
+        done += n;
+    }
+}
+
+int multipath_channel_cc_impl::work(int noutput_items,
+                                    gr_vector_const_void_star& input_items,
+                                    gr_vector_void_star& output_items)
+{
+    const gr_complex* in = (const gr_complex*)input_items[0];
+    gr_complex* out = (gr_complex*)output_items[0];
+    const uint64_t first = nitems_written(0);
+
+    gr::thread::scoped_lock guard(d_setlock);
+    if (d_speed_changed) {
+        apply_speed(first);
+    }
+
+    // Replayed fixes take effect at their own sample
+    int done = 0;
+    while (d_gps_replay.loaded() &&
+           d_gps_replay.due_before(first + noutput_items, d_sample_rate)) {
+        size_t fix = d_gps_replay.next();
+        uint64_t offset = std::max(d_gps_replay.offset(fix, d_sample_rate), first);
+        int boundary = static_cast<int>(offset - first);
+        process_span(in + done, out + done, boundary - done);
+        done = boundary;
+        if (usable_speed(d_gps_replay.speed(fix))) {
+            d_speed_kmh = d_gps_replay.speed(fix);
+            apply_speed(offset);
+        }
+        d_gps_replay.advance();
+    }
+    process_span(in + done, out + done, noutput_items - done);
+
+    return noutput_items;
+}
+
+} // namespace rake_receiver
+} // namespace gr
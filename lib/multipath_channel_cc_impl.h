@@ -0,0 +1,75 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef INCLUDED_RAKE_RECEIVER_MULTIPATH_CHANNEL_CC_IMPL_H
+#define INCLUDED_RAKE_RECEIVER_MULTIPATH_CHANNEL_CC_IMPL_H
+
+#include <gnuradio/rake_receiver/multipath_channel_cc.h>
+#include "gps_replay.h"
+#include "jakes_fading.h"
+#include <vector>
+
+namespace gr {
+namespace rake_receiver {
+
+class multipath_channel_cc_impl : public multipath_channel_cc
+{
+private:
+    std::vector<int> d_delays;
+    int d_max_delay;
+    double d_sample_rate;
+    double d_carrier_freq;
+    jakes_fading d_fading;
+
+    float d_speed_kmh;
+    bool d_speed_changed;
+    gps_replay d_gps_replay;
+
+    // The current grid segment: coefficients at its start, their change per
+    // sample, and the samples left until the next grid point
+    int d_spacing;
+    std::vector<gr_complex> d_h;
+    std::vector<gr_complex> d_slope;
+    int d_remaining;
+
+    void update_doppler();
+    void apply_speed(uint64_t offset);
+    void start_segment();
+    void process_span(const gr_complex* in, gr_complex* out, int count);
+    void handle_speed_message(pmt::pmt_t msg);
+
+public:
+    multipath_channel_cc_impl(const std::vector<int>& delays,
+                              const std::vector<float>& gains_db,
+                              const std::vector<float>& k_factors,
+                              double sample_rate,
+                              double carrier_freq,
+                              float speed_kmh,
+                              int num_sinusoids,
+                              uint32_t seed);
+    ~multipath_channel_cc_impl() override;
+
+    void set_speed(float speed_kmh) override;
+    float speed() const override;
+    double max_doppler() const override;
+    std::vector<int> delays() const override;
+
+    size_t load_gps_replay(const std::string& path, double start_time) override;
+    void clear_gps_replay() override;
+    size_t gps_replay_remaining() const override;
+
+    int work(int noutput_items,
+             gr_vector_const_void_star& input_items,
+             gr_vector_void_star& output_items) override;
+};
+
+} // namespace rake_receiver
+} // namespace gr
+
+#endif /* INCLUDED_RAKE_RECEIVER_MULTIPATH_CHANNEL_CC_IMPL_H */
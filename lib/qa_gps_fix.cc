@@ -0,0 +1,211 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/attributes.h>
+#include <gnuradio/rake_receiver/gps_fix.h>
+#include <boost/test/unit_test.hpp>
+#include <cstdint>
+#include <string>
+
+namespace gr {
+namespace rake_receiver {
+
+namespace {
+
+void put_le(std::string& payload, size_t offset, uint32_t value, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; i++) {
+        payload[offset + i] = static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+}
+
+// UBX NAV-PVT frame for 2024-01-01T12:00:00Z at 48.1173N 11.5167E
+std::string make_nav_pvt(uint8_t fix_type, bool fix_ok)
+{
+    std::string payload(92, '\0');
+    put_le(payload, 4, 2024, 2);
+    payload[6] = 1;
+    payload[7] = 1;
+    payload[8] = 12;
+    payload[11] = 0x07; // validDate | validTime | fullyResolved
+    payload[20] = static_cast<char>(fix_type);
+    payload[21] = fix_ok ? 0x01 : 0x00;
+    payload[23] = 9;
+    put_le(payload, 24, 115166667, 4);
+    put_le(payload, 28, 481173000, 4);
+    // Ellipsoid height, then height above mean sea level
+    put_le(payload, 32, 592300, 4);
+    put_le(payload, 36, 545400, 4);
+    put_le(payload, 60, 10000, 4);
+    put_le(payload, 64, 8440000, 4);
+    put_le(payload, 68, 250, 4);
+
+    std::string frame("\xb5\x62\x01\x07", 4);
+    frame += static_cast<char>(payload.size() & 0xff);
+    frame += static_cast<char>(payload.size() >> 8);
+    frame += payload;
+    unsigned char ck_a = 0, ck_b = 0;
+    for (size_t i = 2; i < frame.size(); i++) {
+        ck_a += static_cast<unsigned char>(frame[i]);
+        ck_b += ck_a;
+    }
+    frame += static_cast<char>(ck_a);
+    frame += static_cast<char>(ck_b);
+    return frame;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_gps_fix_rmc)
+{
+    gps_fix fix;
+    BOOST_REQUIRE(parse_gps_fix(
+        "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A", fix));
+
+    BOOST_CHECK(fix.has(gps_fix::has_time | gps_fix::has_date | gps_fix::has_position |
+                        gps_fix::has_speed | gps_fix::has_course));
+    BOOST_CHECK(!fix.has(gps_fix::has_altitude));
+    BOOST_CHECK(!fix.has(gps_fix::has_mode));
+    // 1994-03-23T12:35:19Z
+    BOOST_CHECK_CLOSE(fix.time, 764426119.0, 1e-9);
+    BOOST_CHECK_CLOSE(fix.latitude_deg, 48.1173, 1e-6);
+    BOOST_CHECK_CLOSE(fix.longitude_deg, 11.516667, 1e-4);
+    BOOST_CHECK_CLOSE(fix.speed_kmh, 41.4848f, 0.1f);
+    BOOST_CHECK_CLOSE(fix.course_deg, 84.4f, 1e-4f);
+
+    // Southern / western hemisphere, other talker, void status
+    BOOST_REQUIRE(parse_gps_fix("$GNRMC,000001,A,3351.000,S,15112.000,W,0,,010100,,", fix));
+    BOOST_CHECK_CLOSE(fix.latitude_deg, -33.85, 1e-6);
+    BOOST_CHECK_CLOSE(fix.longitude_deg, -151.2, 1e-6);
+    BOOST_CHECK(!fix.has(gps_fix::has_course));
+
+    BOOST_REQUIRE(parse_gps_fix("$GPRMC,123520,V,,,,,,,230394,,*6A", fix));
+    BOOST_CHECK(!fix.has(gps_fix::has_position));
+    BOOST_CHECK(!fix.has(gps_fix::has_speed));
+    BOOST_CHECK(fix.has(gps_fix::has_mode));
+    BOOST_CHECK_EQUAL(fix.mode, 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_gps_fix_gga_vtg)
+{
+    gps_fix fix;
+    BOOST_REQUIRE(parse_gps_fix(
+        "$GPGGA,123518,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n", fix));
+    BOOST_CHECK(fix.has(gps_fix::has_time | gps_fix::has_position |
+                        gps_fix::has_altitude | gps_fix::has_satellites |
+                        gps_fix::has_hdop));
+    // GGA carries no date
+    BOOST_CHECK(!fix.has(gps_fix::has_date));
+    BOOST_CHECK_CLOSE(fix.time, 12 * 3600.0 + 35 * 60.0 + 18.0, 1e-9);
+    BOOST_CHECK_CLOSE(fix.altitude_m, 545.4, 1e-9);
+    BOOST_CHECK_EQUAL(fix.satellites, 8);
+    BOOST_CHECK_CLOSE(fix.hdop, 0.9f, 1e-4f);
+
+    BOOST_REQUIRE(parse_gps_fix("$GPGGA,123518,,,,,0,00,,,M,,M,,*66", fix));
+    BOOST_CHECK(!fix.has(gps_fix::has_position));
+    BOOST_CHECK_EQUAL(fix.mode, 1);
+
+    BOOST_REQUIRE(parse_gps_fix("$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48", fix));
+    BOOST_CHECK_EQUAL(fix.valid, gps_fix::has_speed | gps_fix::has_course);
+    BOOST_CHECK_CLOSE(fix.speed_kmh, 10.2f, 1e-4f);
+    BOOST_CHECK_CLOSE(fix.course_deg, 54.7f, 1e-4f);
+
+    BOOST_CHECK(!parse_gps_fix("$GPGSV,3,1,11,03,03,111,00*74", fix));
+    BOOST_CHECK_EQUAL(fix.valid, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_gps_fix_gpsd)
+{
+    gps_fix fix;
+    BOOST_REQUIRE(parse_gps_fix(
+        "{\"class\":\"TPV\",\"mode\":3,\"time\":\"2024-01-01T12:00:00.500Z\","
+        "\"lat\":48.1173,\"lon\":11.516667,\"alt\":520.0,\"altMSL\":545.4,"
+        "\"track\":84.4,\"speed\":12.5,\"eps\":0.5}",
+        fix));
+    BOOST_CHECK(fix.has(gps_fix::has_time | gps_fix::has_date | gps_fix::has_position |
+                        gps_fix::has_altitude | gps_fix::has_speed |
+                        gps_fix::has_course | gps_fix::has_mode |
+                        gps_fix::has_speed_error));
+    BOOST_CHECK_CLOSE(fix.time, 1704110400.5, 1e-9);
+    BOOST_CHECK_CLOSE(fix.latitude_deg, 48.1173, 1e-9);
+    BOOST_CHECK_CLOSE(fix.longitude_deg, 11.516667, 1e-9);
+    // altMSL wins over the legacy alt key
+    BOOST_CHECK_CLOSE(fix.altitude_m, 545.4, 1e-9);
+    BOOST_CHECK_CLOSE(fix.speed_kmh, 45.0f, 1e-4f);
+    BOOST_CHECK_CLOSE(fix.speed_error_kmh, 1.8f, 1e-4f);
+    BOOST_CHECK_EQUAL(fix.mode, 3);
+
+    BOOST_CHECK(!parse_gps_fix("{\"class\":\"SKY\",\"hdop\":0.9}", fix));
+    BOOST_CHECK(!parse_gps_fix("{\"class\":\"TPV\",\"mode\":3", fix));
+}
+
+BOOST_AUTO_TEST_CASE(test_gps_fix_ubx)
+{
+    gps_fix fix;
+    std::string frame = make_nav_pvt(3, true);
+    BOOST_REQUIRE(parse_gps_fix(frame.data(), frame.size(), fix));
+    BOOST_CHECK(fix.has(gps_fix::has_time | gps_fix::has_date | gps_fix::has_position |
+                        gps_fix::has_altitude | gps_fix::has_speed |
+                        gps_fix::has_course | gps_fix::has_speed_error));
+    BOOST_CHECK_CLOSE(fix.time, 1704110400.0, 1e-9);
+    BOOST_CHECK_CLOSE(fix.latitude_deg, 48.1173, 1e-6);
+    BOOST_CHECK_CLOSE(fix.longitude_deg, 11.5166667, 1e-6);
+    BOOST_CHECK_CLOSE(fix.altitude_m, 545.4, 1e-6);
+    BOOST_CHECK_CLOSE(fix.speed_kmh, 36.0f, 1e-4f);
+    BOOST_CHECK_CLOSE(fix.course_deg, 84.4f, 1e-4f);
+    BOOST_CHECK_CLOSE(fix.speed_error_kmh, 0.9f, 1e-3f);
+    BOOST_CHECK_EQUAL(fix.mode, 3);
+    BOOST_CHECK_EQUAL(fix.satellites, 9);
+
+    // Without gnssFixOK the position is not trusted
+    frame = make_nav_pvt(3, false);
+    BOOST_REQUIRE(parse_gps_fix(frame.data(), frame.size(), fix));
+    BOOST_CHECK(!fix.has(gps_fix::has_position));
+    BOOST_CHECK_EQUAL(fix.mode, 1);
+
+    frame[frame.size() - 1] ^= 0x55;
+    BOOST_CHECK(!parse_gps_fix(frame.data(), frame.size(), fix));
+    BOOST_CHECK(!parse_gps_fix(nullptr, 0, fix));
+}
+
+BOOST_AUTO_TEST_CASE(test_gps_fix_out_of_range)
+{
+    // Found by fuzz_gps_parser: strtod takes "nan" and "inf" and overflows
+    // to infinity, none of which is a speed or a position
+    gps_fix fix;
+    BOOST_REQUIRE(parse_gps_fix("$GPVTG,054.7,T,034.4,M,005.5,N,nan,K*00", fix));
+    BOOST_CHECK(!fix.has(gps_fix::has_speed));
+    BOOST_REQUIRE(parse_gps_fix("$GPVTG,054.7,T,034.4,M,005.5,N,1e39,K*00", fix));
+    BOOST_CHECK(!fix.has(gps_fix::has_speed));
+    BOOST_REQUIRE(parse_gps_fix(
+        "$GPRMC,123519,A,1e308,N,01131.000,E,inf,084.4,230394,003.1,W*00", fix));
+    BOOST_CHECK(!fix.has(gps_fix::has_position));
+    BOOST_CHECK(!fix.has(gps_fix::has_speed));
+    BOOST_REQUIRE(parse_gps_fix("{\"class\":\"TPV\",\"mode\":3,\"speed\":1e308}", fix));
+    BOOST_CHECK(!fix.has(gps_fix::has_speed));
+    // Counts outside their range are dropped rather than cast
+    BOOST_REQUIRE(parse_gps_fix("{\"class\":\"TPV\",\"mode\":1e300,\"speed\":1.0}", fix));
+    BOOST_CHECK(!fix.has(gps_fix::has_mode));
+    BOOST_CHECK(fix.has(gps_fix::has_speed));
+    BOOST_REQUIRE(parse_gps_fix("{\"class\":\"TPV\",\"mode\":4,\"speed\":1.0}", fix));
+    BOOST_CHECK(!fix.has(gps_fix::has_mode));
+    BOOST_REQUIRE(parse_gps_fix(
+        "$GPGGA,123519,4807.038,N,01131.000,E,1,1e30,0.9,545.4,M,46.9,M,,*00", fix));
+    BOOST_CHECK(!fix.has(gps_fix::has_satellites));
+    BOOST_REQUIRE(parse_gps_fix(
+        "$GPGGA,123519,4807.038,N,01131.000,E,1,100,0.9,545.4,M,46.9,M,,*00", fix));
+    BOOST_CHECK(!fix.has(gps_fix::has_satellites));
+}
+
+} /* namespace rake_receiver */
+} /* namespace gr */
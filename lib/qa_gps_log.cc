@@ -0,0 +1,161 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/attributes.h>
+#include <gnuradio/rake_receiver/gps_log.h>
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+namespace gr {
+namespace rake_receiver {
+
+namespace {
+
+void put_le(std::string& payload, size_t offset, uint32_t value, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; i++) {
+        payload[offset + i] = static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+}
+
+// UBX NAV-PVT frame for 2024-01-01T12:00:00Z
+std::string make_nav_pvt(int32_t ground_speed_mm_s, uint8_t fix_type, bool fix_ok)
+{
+    std::string payload(92, '\0');
+    put_le(payload, 4, 2024, 2);
+    payload[6] = 1;
+    payload[7] = 1;
+    payload[8] = 12;
+    payload[11] = 0x07; // validDate | validTime | fullyResolved
+    payload[20] = static_cast<char>(fix_type);
+    payload[21] = fix_ok ? 0x01 : 0x00;
+    put_le(payload, 60, static_cast<uint32_t>(ground_speed_mm_s), 4);
+    put_le(payload, 68, 100, 4);
+
+    std::string frame = "\xb5\x62\x01\x07";
+    frame += static_cast<char>(payload.size() & 0xff);
+    frame += static_cast<char>(payload.size() >> 8);
+    frame += payload;
+    unsigned char ck_a = 0, ck_b = 0;
+    for (size_t i = 2; i < frame.size(); i++) {
+        ck_a += static_cast<unsigned char>(frame[i]);
+        ck_b += ck_a;
+    }
+    frame += static_cast<char>(ck_a);
+    frame += static_cast<char>(ck_b);
+    return frame;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_gps_log_nmea)
+{
+    std::string log =
+        "$GPGGA,123518,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n"
+        "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n"
+        "$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48\r\n"
+        "$GPRMC,123520,V,,,,,,,230394,,*6A\r\n";
+
+    gps_log result = parse_gps_log(log);
+    BOOST_REQUIRE_EQUAL(result.size(), 3);
+    BOOST_REQUIRE_EQUAL(result.speeds_kmh.size(), 3);
+    BOOST_REQUIRE_EQUAL(result.valid.size(), 3);
+
+    // 1994-03-23T12:35:19Z
+    BOOST_CHECK_CLOSE(result.timestamps[0], 764426119.0, 1e-9);
+    BOOST_CHECK_CLOSE(result.speeds_kmh[0], 41.4848f, 0.1f);
+    BOOST_CHECK_EQUAL(result.valid[0], 1);
+
+    // VTG carries no time and inherits the RMC timestamp
+    BOOST_CHECK_CLOSE(result.timestamps[1], 764426119.0, 1e-9);
+    BOOST_CHECK_CLOSE(result.speeds_kmh[1], 10.2f, 0.1f);
+    BOOST_CHECK_EQUAL(result.valid[1], 1);
+
+    // Status 'V' with an empty speed field
+    BOOST_CHECK_CLOSE(result.timestamps[2], 764426120.0, 1e-9);
+    BOOST_CHECK(std::isnan(result.speeds_kmh[2]));
+    BOOST_CHECK_EQUAL(result.valid[2], 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_gps_log_gpsd)
+{
+    std::string log =
+        "{\"class\":\"SKY\",\"time\":\"2024-01-01T11:59:59.000Z\"}\n"
+        "{\"class\":\"TPV\",\"mode\":3,\"time\":\"2024-01-01T12:00:00.500Z\","
+        "\"speed\":12.5}\n"
+        "{\"class\":\"TPV\",\"mode\":1,\"speed\":0.0}\n";
+
+    gps_log result = parse_gps_log(log);
+    BOOST_REQUIRE_EQUAL(result.size(), 2);
+
+    BOOST_CHECK_CLOSE(result.timestamps[0], 1704110400.5, 1e-9);
+    BOOST_CHECK_CLOSE(result.speeds_kmh[0], 45.0f, 0.1f);
+    BOOST_CHECK_EQUAL(result.valid[0], 1);
+
+    // mode 1 means no fix
+    BOOST_CHECK_EQUAL(result.valid[1], 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_gps_log_ubx)
+{
+    std::string log = make_nav_pvt(10000, 3, true);
+    log += "$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48\r\n";
+    // 2570 mm/s is 0x0a0a: '\n' bytes in a payload must not split the frame
+    log += make_nav_pvt(2570, 1, false);
+    std::string corrupt = make_nav_pvt(5000, 3, true);
+    corrupt[corrupt.size() - 1] ^= 0x55;
+    log += corrupt;
+
+    gps_log result = parse_gps_log(log);
+    BOOST_REQUIRE_EQUAL(result.size(), 3);
+
+    BOOST_CHECK_CLOSE(result.timestamps[0], 1704110400.0, 1e-9);
+    BOOST_CHECK_CLOSE(result.speeds_kmh[0], 36.0f, 0.1f);
+    BOOST_CHECK_EQUAL(result.valid[0], 1);
+
+    BOOST_CHECK_CLOSE(result.timestamps[1], 1704110400.0, 1e-9);
+    BOOST_CHECK_CLOSE(result.speeds_kmh[1], 10.2f, 0.1f);
+
+    // Dead reckoning without gnssFixOK
+    BOOST_CHECK_CLOSE(result.speeds_kmh[2], 9.252f, 0.1f);
+    BOOST_CHECK_EQUAL(result.valid[2], 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_gps_log_unusable_speed)
+{
+    // Replay trusts valid, so these must not be valid: a negative speed,
+    // knots that overflow float once converted, and a float-overflowing TPV
+    std::string log = "$GPVTG,054.7,T,034.4,M,005.5,N,-10.2,K*00\r\n"
+                      "$GPRMC,123519,A,4807.038,N,01131.000,E,3e38,084.4,230394,,*00\r\n"
+                      "{\"class\":\"TPV\",\"mode\":3,\"speed\":1e300}\n";
+    log += make_nav_pvt(-5000, 3, true);
+
+    gps_log result = parse_gps_log(log);
+    BOOST_REQUIRE_EQUAL(result.size(), 4);
+    for (size_t i = 0; i < result.size(); i++) {
+        BOOST_CHECK(std::isnan(result.speeds_kmh[i]));
+        BOOST_CHECK_EQUAL(result.valid[i], 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_gps_log_empty)
+{
+    BOOST_CHECK_EQUAL(parse_gps_log(std::string()).size(), 0);
+    BOOST_CHECK_EQUAL(parse_gps_log("garbage\n\n", 10).size(), 0);
+    BOOST_CHECK_THROW(parse_gps_log_file("/nonexistent/gps.log"), std::runtime_error);
+}
+
+} /* namespace rake_receiver */
+} /* namespace gr */
@@ -0,0 +1,221 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/attributes.h>
+#include <gnuradio/rake_receiver/multipath_channel_cc.h>
+#include <gnuradio/blocks/vector_sink.h>
+#include <gnuradio/blocks/vector_source.h>
+#include <gnuradio/top_block.h>
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace gr {
+namespace rake_receiver {
+
+namespace {
+
+std::vector<gr_complex> run_channel(multipath_channel_cc::sptr channel,
+                                    const std::vector<gr_complex>& input,
+                                    std::vector<tag_t>* tags = nullptr)
+{
+    auto source = blocks::vector_source_c::make(input, false);
+    auto sink = blocks::vector_sink_c::make();
+    auto tb = gr::make_top_block("test");
+    tb->connect(source, 0, channel, 0);
+    tb->connect(channel, 0, sink, 0);
+    tb->run();
+    if (tags) {
+        *tags = sink->tags();
+    }
+    return sink->data();
+}
+
+struct power_stats {
+    double mean;
+    double variance;
+    double crossings_per_second;
+};
+
+// Power statistics of a single tap driven by a constant input
+power_stats tap_statistics(float k_factor, float speed_kmh)
+{
+    const double sample_rate = 10000.0;
+    auto channel = multipath_channel_cc::make(
+        { 0 }, { 0.0f }, { k_factor }, sample_rate, 2.0e9, speed_kmh, 16, 7);
+    auto output =
+        run_channel(channel, std::vector<gr_complex>(400000, gr_complex(1.0f, 0.0f)));
+
+    power_stats stats{ 0.0, 0.0, 0.0 };
+    size_t upward = 0;
+    for (size_t n = 0; n < output.size(); n++) {
+        double power = std::norm(output[n]);
+        stats.mean += power;
+        stats.variance += power * power;
+        if (n > 0 && std::norm(output[n - 1]) < 1.0 && power >= 1.0) {
+            upward++;
+        }
+    }
+    stats.mean /= output.size();
+    stats.variance = stats.variance / output.size() - stats.mean * stats.mean;
+    stats.crossings_per_second = upward * sample_rate / output.size();
+    return stats;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_multipath_channel_cc_make)
+{
+    auto channel = multipath_channel_cc::make(
+        { 0, 5, 17 }, { 0.0f, -3.0f, -6.0f }, {}, 1.0e6, 2.0e9, 36.0f);
+    BOOST_CHECK_EQUAL(channel->delays().size(), 3u);
+    BOOST_CHECK_EQUAL(channel->speed(), 36.0f);
+    // 10 m/s at 2 GHz
+    BOOST_CHECK_CLOSE(channel->max_doppler(), 66.71, 0.01);
+    BOOST_CHECK_EQUAL(channel->history(), 18u);
+
+    channel->set_speed(72.0f);
+    BOOST_CHECK_CLOSE(channel->max_doppler(), 133.43, 0.01);
+    BOOST_CHECK_THROW(channel->set_speed(-1.0f), std::invalid_argument);
+    BOOST_CHECK_THROW(channel->set_speed(INFINITY), std::invalid_argument);
+    BOOST_CHECK_THROW(channel->set_speed(NAN), std::invalid_argument);
+    BOOST_CHECK_EQUAL(channel->speed(), 72.0f);
+
+    BOOST_CHECK_THROW(multipath_channel_cc::make({}, {}, {}, 1.0e6, 2.0e9, 0.0f),
+                      std::invalid_argument);
+    BOOST_CHECK_THROW(
+        multipath_channel_cc::make({ 0, 1 }, { 0.0f }, {}, 1.0e6, 2.0e9, 0.0f),
+        std::invalid_argument);
+    BOOST_CHECK_THROW(
+        multipath_channel_cc::make({ 0 }, { 0.0f }, { 1.0f, 2.0f }, 1.0e6, 2.0e9, 0.0f),
+        std::invalid_argument);
+    BOOST_CHECK_THROW(
+        multipath_channel_cc::make({ -1 }, { 0.0f }, {}, 1.0e6, 2.0e9, 0.0f),
+        std::invalid_argument);
+    BOOST_CHECK_THROW(
+        multipath_channel_cc::make({ 0 }, { 0.0f }, { -1.0f }, 1.0e6, 2.0e9, 0.0f),
+        std::invalid_argument);
+    BOOST_CHECK_THROW(multipath_channel_cc::make({ 0 }, { 0.0f }, {}, 0.0, 2.0e9, 0.0f),
+                      std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_multipath_channel_cc_impulse_response)
+{
+    // Standing still the taps are constant, so an impulse shows the delays
+    std::vector<int> delays = { 0, 7, 30 };
+    auto channel = multipath_channel_cc::make(
+        delays, { 0.0f, -3.0f, -10.0f }, {}, 1.0e6, 2.0e9, 0.0f, 16, 3);
+    std::vector<gr_complex> input(100, 0.0f);
+    input[10] = 1.0f;
+    input[60] = 1.0f;
+    auto output = run_channel(channel, input);
+    BOOST_REQUIRE_EQUAL(output.size(), input.size());
+
+    for (size_t n = 0; n < output.size(); n++) {
+        bool tap = false;
+        for (int d : delays) {
+            tap = tap || n == size_t(10 + d) || n == size_t(60 + d);
+        }
+        if (tap) {
+            BOOST_CHECK_GT(std::abs(output[n]), 0.0f);
+        } else {
+            BOOST_CHECK_EQUAL(std::abs(output[n]), 0.0f);
+        }
+    }
+    // Same coefficients for both impulses
+    for (int d : delays) {
+        BOOST_CHECK_SMALL(std::abs(output[10 + d] - output[60 + d]), 1e-5f);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_multipath_channel_cc_rayleigh_statistics)
+{
+    // 100 km/h at 2 GHz: f_D = 185 Hz, so 20 s hold ~3700 Doppler periods
+    const double doppler = 100.0 / 3.6 / 299792458.0 * 2.0e9;
+    power_stats rayleigh = tap_statistics(0.0f, 100.0f);
+    BOOST_CHECK_CLOSE(rayleigh.mean, 1.0, 10.0);
+    // Exponential power: variance equals mean squared
+    BOOST_CHECK_CLOSE(rayleigh.variance, 1.0, 20.0);
+    // Level crossing rate at the RMS level, sqrt(2 pi) f_D / e
+    BOOST_CHECK_CLOSE(
+        rayleigh.crossings_per_second, std::sqrt(2.0 * M_PI) * doppler / M_E, 15.0);
+
+    // Rician K = 10: (1 + 2K) / (K + 1)^2
+    power_stats rician = tap_statistics(10.0f, 100.0f);
+    BOOST_CHECK_CLOSE(rician.mean, 1.0, 10.0);
+    BOOST_CHECK_CLOSE(rician.variance, 21.0 / 121.0, 25.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_multipath_channel_cc_speed_tags)
+{
+    auto channel =
+        multipath_channel_cc::make({ 0, 3 }, { 0.0f, -3.0f }, {}, 1.0e4, 2.0e9, 50.0f);
+    std::vector<tag_t> tags;
+    run_channel(channel, std::vector<gr_complex>(1000, 1.0f), &tags);
+
+    // The initial speed is announced on the first sample
+    int speed_tags = 0;
+    for (const tag_t& tag : tags) {
+        if (pmt::eq(tag.key, pmt::mp("gps_speed"))) {
+            BOOST_CHECK_EQUAL(tag.offset, 0u);
+            BOOST_CHECK_CLOSE(pmt::to_double(tag.value), 50.0, 1e-6);
+            speed_tags++;
+        }
+    }
+    BOOST_CHECK_EQUAL(speed_tags, 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_multipath_channel_cc_gps_replay)
+{
+    auto channel =
+        multipath_channel_cc::make({ 0, 3 }, { 0.0f, -3.0f }, {}, 1.0e3, 2.0e9, 50.0f);
+
+    // One fix per second: 10 m/s, an overflowing speed, then 20 m/s
+    std::string path =
+        (std::filesystem::temp_directory_path() / "qa_multipath_channel_replay.json")
+            .string();
+    {
+        std::ofstream file(path);
+        file << "{\"class\":\"TPV\",\"mode\":3,"
+                "\"time\":\"2024-01-01T12:00:00.000Z\",\"speed\":10.0}\n"
+                "{\"class\":\"TPV\",\"mode\":3,"
+                "\"time\":\"2024-01-01T12:00:01.000Z\",\"speed\":1e300}\n"
+                "{\"class\":\"TPV\",\"mode\":3,"
+                "\"time\":\"2024-01-01T12:00:02.000Z\",\"speed\":20.0}\n";
+    }
+    BOOST_CHECK_EQUAL(channel->load_gps_replay(path, -1.0), 2u);
+    std::filesystem::remove(path);
+
+    std::vector<tag_t> tags;
+    auto output = run_channel(channel, std::vector<gr_complex>(3000, 1.0f), &tags);
+    for (const gr_complex& y : output) {
+        BOOST_REQUIRE(std::isfinite(y.real()) && std::isfinite(y.imag()));
+    }
+
+    std::vector<double> speeds;
+    for (const tag_t& tag : tags) {
+        if (pmt::eq(tag.key, pmt::mp("gps_speed"))) {
+            speeds.push_back(pmt::to_double(tag.value));
+        }
+    }
+    BOOST_REQUIRE_EQUAL(speeds.size(), 3u);
+    BOOST_CHECK_CLOSE(speeds[1], 36.0, 1e-4);
+    BOOST_CHECK_CLOSE(speeds[2], 72.0, 1e-4);
+    BOOST_CHECK_CLOSE(channel->speed(), 72.0f, 1e-4);
+    BOOST_CHECK_EQUAL(channel->gps_replay_remaining(), 0u);
+}
+
+} /* namespace rake_receiver */
+} /* namespace gr */
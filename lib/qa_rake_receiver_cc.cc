@@ -13,16 +13,69 @@
 
 #include <gnuradio/attributes.h>
 #include <gnuradio/rake_receiver/rake_receiver_cc.h>
+#include <gnuradio/blocks/message_debug.h>
 #include <gnuradio/blocks/vector_source.h>
 #include <gnuradio/blocks/vector_sink.h>
 #include <gnuradio/top_block.h>
 #include <boost/test/unit_test.hpp>
-#include <vector>
+#include <chrono>
+#include <cmath>
 #include <complex>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <utility>
+#include <vector>
 
 namespace gr {
 namespace rake_receiver {
 
+namespace {
+
+// Minimal UBX NAV-PVT frame with ground speed, fix and speed accuracy set
+std::string make_nav_pvt(uint32_t ground_speed_mm_s, uint8_t fix_type, uint32_t s_acc_mm_s)
+{
+    std::string payload(92, '\0');
+    payload[20] = static_cast<char>(fix_type);
+    payload[21] = 0x01; // gnssFixOK
+    for (int i = 0; i < 4; i++) {
+        payload[60 + i] = static_cast<char>((ground_speed_mm_s >> (8 * i)) & 0xff);
+        payload[68 + i] = static_cast<char>((s_acc_mm_s >> (8 * i)) & 0xff);
+    }
+
+    std::string frame = std::string("\xb5\x62\x01\x07\x5c\x00", 6) + payload;
+    unsigned char ck_a = 0, ck_b = 0;
+    for (size_t i = 2; i < frame.size(); i++) {
+        ck_a += static_cast<unsigned char>(frame[i]);
+        ck_b += ck_a;
+    }
+    frame += static_cast<char>(ck_a);
+    frame += static_cast<char>(ck_b);
+    return frame;
+}
+
+// Rayleigh fading with maximum Doppler fd_hz: a sum of equal-power rays
+// arriving from evenly spread angles (Clarke model)
+std::vector<gr_complex> make_fading(double fd_hz, double sample_rate, size_t samples)
+{
+    const int rays = 64;
+    const double two_pi = 6.283185307179586;
+    std::vector<gr_complex> h(samples);
+    for (int r = 0; r < rays; r++) {
+        double angle = two_pi * (r + 0.37) / rays;
+        double phase = two_pi * std::fmod(r * 0.618034, 1.0);
+        double w = two_pi * fd_hz * std::cos(angle) / sample_rate;
+        for (size_t n = 0; n < samples; n++) {
+            double p = w * static_cast<double>(n) + phase;
+            h[n] += gr_complex(std::cos(p), std::sin(p)) / std::sqrt(float(rays));
+        }
+    }
+    return h;
+}
+
+} // namespace
+
 BOOST_AUTO_TEST_CASE(test_rake_receiver_cc_make)
 {
     int num_fingers = 3;
@@ -322,5 +375,1014 @@ BOOST_AUTO_TEST_CASE(test_rake_receiver_cc_gps_data_auto_parse)
     BOOST_CHECK_CLOSE(rake->gps_speed(), 36.0f, 0.1f); // 10 m/s = 36 km/h
 }
 
+BOOST_AUTO_TEST_CASE(test_rake_receiver_cc_gpsd_quality_gate)
+{
+    int num_fingers = 4;
+    std::vector<int> delays = {0, 10, 20, 30};
+    std::vector<float> gains = {1.0f, 0.8f, 0.6f, 0.4f};
+    int pattern_length = 42;
+
+    auto rake = rake_receiver_cc::make(num_fingers, delays, gains, pattern_length);
+    BOOST_REQUIRE(rake != nullptr);
+
+    BOOST_CHECK_EQUAL(rake->gps_min_mode(), 2);
+    BOOST_CHECK_EQUAL(rake->gps_max_speed_error(), 0.0f);
+
+    // Non-TPV reports never update the speed, even with a nested "speed" key
+    BOOST_CHECK(!rake->parse_gpsd(
+        "{\"class\":\"SKY\",\"satellites\":[{\"PRN\":1,\"speed\":99.0}]}"));
+    BOOST_CHECK(!rake->parse_gpsd("{\"class\":\"ERROR\",\"message\":\"no fix\"}"));
+    BOOST_CHECK_EQUAL(rake->gps_speed(), -1.0f);
+
+    // No fix (mode 1) is rejected, a 2D fix is accepted
+    BOOST_CHECK(!rake->parse_gpsd("{\"class\":\"TPV\",\"mode\":1,\"speed\":10.0}"));
+    BOOST_CHECK(rake->parse_gpsd("{\"class\":\"TPV\",\"mode\":2,\"speed\":10.0}"));
+    BOOST_CHECK_CLOSE(rake->gps_speed(), 36.0f, 0.1f);
+
+    // Require a 3D fix
+    rake->set_gps_min_mode(3);
+    BOOST_CHECK(!rake->parse_gps_data("{\"class\":\"TPV\",\"mode\":2,\"speed\":5.0}"));
+    BOOST_CHECK_CLOSE(rake->gps_speed(), 36.0f, 0.1f);
+
+    // Speed error gate: eps 2 m/s = 7.2 km/h
+    rake->set_gps_max_speed_error(5.0f);
+    BOOST_CHECK(!rake->parse_gpsd(
+        "{\"class\":\"TPV\",\"mode\":3,\"speed\":5.0,\"eps\":2.0}"));
+    BOOST_CHECK(rake->parse_gpsd(
+        "{\"class\":\"TPV\",\"mode\":3,\"speed\":5.0,\"eps\":1.0}"));
+    BOOST_CHECK_CLOSE(rake->gps_speed(), 18.0f, 0.1f);
+
+    // Negative and float-overflowing speeds are rejected like parse_gpsd_speed()
+    BOOST_CHECK(!rake->parse_gpsd("{\"class\":\"TPV\",\"mode\":3,\"speed\":-1.0}"));
+    BOOST_CHECK(!rake->parse_gpsd("{\"class\":\"TPV\",\"mode\":3,\"speed\":1e300}"));
+    BOOST_CHECK_CLOSE(rake->gps_speed(), 18.0f, 0.1f);
+}
+
+BOOST_AUTO_TEST_CASE(test_rake_receiver_cc_speed_filter)
+{
+    int num_fingers = 4;
+    std::vector<int> delays = {0, 10, 20, 30};
+    std::vector<float> gains = {1.0f, 0.8f, 0.6f, 0.4f};
+    int pattern_length = 42;
+
+    auto rake = rake_receiver_cc::make(num_fingers, delays, gains, pattern_length);
+    BOOST_REQUIRE(rake != nullptr);
+
+    BOOST_CHECK(!rake->speed_filter());
+    BOOST_CHECK_EQUAL(rake->adaptation_interval(), 1.0f);
+    BOOST_CHECK_THROW(rake->set_adaptation_interval(-1.0f), std::invalid_argument);
+    BOOST_CHECK_THROW(rake->set_speed_filter_noise(0.0f, 2.0f), std::invalid_argument);
+
+    rake->set_adaptive_mode(true);
+    rake->set_speed_filter(true);
+    rake->set_adaptation_interval(0.0f);
+
+    // A single outlier after a run of steady fixes is mostly rejected
+    for (int i = 0; i < 20; i++) {
+        rake->set_gps_speed(60.0f);
+    }
+    rake->set_gps_speed(120.0f);
+    BOOST_CHECK_EQUAL(rake->gps_speed(), 120.0f);
+    BOOST_CHECK_LT(rake->filtered_speed(), 100.0f);
+    BOOST_CHECK_GT(rake->path_search_rate(), 20.0f);
+    BOOST_CHECK_LT(rake->path_search_rate(), 50.0f);
+
+    // With a long interval, new fixes do not retune the block
+    float rate = rake->path_search_rate();
+    rake->set_adaptation_interval(3600.0f);
+    for (int i = 0; i < 20; i++) {
+        rake->set_gps_speed(2.0f);
+    }
+    BOOST_CHECK_EQUAL(rake->path_search_rate(), rate);
+    BOOST_CHECK_LT(rake->filtered_speed(), 60.0f);
+}
+
+BOOST_AUTO_TEST_CASE(test_rake_receiver_cc_speed_profile)
+{
+    int num_fingers = 4;
+    std::vector<int> delays = {0, 10, 20, 30};
+    std::vector<float> gains = {1.0f, 0.8f, 0.6f, 0.4f};
+    int pattern_length = 42;
+
+    auto rake = rake_receiver_cc::make(num_fingers, delays, gains, pattern_length);
+    BOOST_REQUIRE(rake != nullptr);
+    rake->set_adaptive_mode(true);
+
+    // Default table matches the built-in categories
+    std::vector<float> expected = {5.0f, 15.0f, 60.0f, 120.0f, 200.0f};
+    std::vector<float> breakpoints = rake->speed_profile_breakpoints();
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        breakpoints.begin(), breakpoints.end(), expected.begin(), expected.end());
+    rake->set_gps_speed(10.0f);
+    BOOST_CHECK_CLOSE(rake->path_search_rate(), 7.5f, 0.1f);
+    rake->set_gps_speed(300.0f);
+    BOOST_CHECK_CLOSE(rake->path_search_rate(), 100.0f, 0.1f);
+
+    // Two-point rail profile
+    rake->set_speed_profile({0.0f, 300.0f},
+                            {10.0f, 130.0f},
+                            {100.0f, 400.0f},
+                            {1.0f, 0.2f},
+                            {2, 4});
+    BOOST_CHECK_CLOSE(rake->path_search_rate(), 130.0f, 0.1f);
+    rake->set_gps_speed(150.0f);
+    BOOST_CHECK_CLOSE(rake->path_search_rate(), 70.0f, 0.1f);
+    BOOST_CHECK_CLOSE(rake->tracking_bandwidth(), 250.0f, 0.1f);
+    BOOST_CHECK_EQUAL(rake->num_fingers(), 4);
+
+    // Hysteresis keeps the finger count just below the midpoint
+    rake->set_speed_hysteresis(10.0f);
+    rake->set_gps_speed(145.0f);
+    BOOST_CHECK_EQUAL(rake->num_fingers(), 4);
+    rake->set_gps_speed(130.0f);
+    BOOST_CHECK_EQUAL(rake->num_fingers(), 2);
+    rake->set_gps_speed(155.0f);
+    BOOST_CHECK_EQUAL(rake->num_fingers(), 2);
+    rake->set_gps_speed(161.0f);
+    BOOST_CHECK_EQUAL(rake->num_fingers(), 4);
+
+    BOOST_CHECK_THROW(rake->set_speed_profile({10.0f, 5.0f},
+                                              {1.0f, 1.0f},
+                                              {1.0f, 1.0f},
+                                              {1.0f, 1.0f},
+                                              {3, 3}),
+                      std::invalid_argument);
+    BOOST_CHECK_THROW(rake->set_speed_hysteresis(-1.0f), std::invalid_argument);
+
+    // JSON profile, categories in any order
+    std::string path =
+        (std::filesystem::temp_directory_path() / "qa_rake_receiver_profile.json")
+            .string();
+    {
+        std::ofstream file(path);
+        file << "{\"hysteresis_kmh\": 1.5, \"categories\": ["
+                "{\"name\": \"walk\", \"speed_kmh\": 20, \"path_search_rate\": 40,"
+                " \"tracking_bandwidth\": 150, \"reassignment_period\": 0.5,"
+                " \"num_fingers\": 3},"
+                "{\"name\": \"still\", \"speed_kmh\": 0, \"path_search_rate\": 2,"
+                " \"tracking_bandwidth\": 20, \"reassignment_period\": 4,"
+                " \"num_fingers\": 2}]}";
+    }
+    rake->load_speed_profile(path);
+    std::filesystem::remove(path);
+    breakpoints = rake->speed_profile_breakpoints();
+    BOOST_REQUIRE_EQUAL(breakpoints.size(), 2u);
+    BOOST_CHECK_EQUAL(breakpoints[0], 0.0f);
+    BOOST_CHECK_CLOSE(rake->speed_hysteresis(), 1.5f, 0.1f);
+    rake->set_gps_speed(10.0f);
+    BOOST_CHECK_CLOSE(rake->path_search_rate(), 21.0f, 0.1f);
+
+    BOOST_CHECK_THROW(rake->load_speed_profile("/nonexistent/profile.json"),
+                      std::runtime_error);
+    {
+        std::ofstream file(path);
+        file << "{\"categories\": [{\"speed_kmh\": 0, \"path_search_rate\": 2,"
+                " \"tracking_bandwidth\": 20, \"reassignment_period\": 4,"
+                " \"num_fingers\": 1e30}]}";
+    }
+    BOOST_CHECK_THROW(rake->load_speed_profile(path), std::invalid_argument);
+    std::filesystem::remove(path);
+
+    rake->reset_speed_profile();
+    BOOST_CHECK_EQUAL(rake->speed_profile_breakpoints().size(), 5u);
+}
+
+BOOST_AUTO_TEST_CASE(test_rake_receiver_cc_speed_tags)
+{
+    int num_fingers = 4;
+    std::vector<int> delays = {0, 10, 20, 30};
+    std::vector<float> gains = {1.0f, 0.8f, 0.6f, 0.4f};
+    int pattern_length = 8;
+
+    auto rake = rake_receiver_cc::make(num_fingers, delays, gains, pattern_length);
+    BOOST_REQUIRE(rake != nullptr);
+    rake->set_adaptive_mode(true);
+
+    std::vector<gr_complex> input_data(1000);
+    for (size_t n = 0; n < input_data.size(); n++) {
+        input_data[n] = gr_complex(std::cos(0.1f * n), std::sin(0.03f * n));
+    }
+
+    // Stationary (3 fingers) from sample 300, high speed (4 fingers) from 700;
+    // the infinite and float-overflowing speeds after that are ignored
+    std::vector<tag_t> tags(4);
+    tags[0].offset = 300;
+    tags[0].key = pmt::mp("gps_speed");
+    tags[0].value = pmt::from_double(2.0);
+    tags[1].offset = 700;
+    tags[1].key = pmt::mp("gps_speed");
+    tags[1].value = pmt::from_double(100.0);
+    tags[2].offset = 800;
+    tags[2].key = pmt::mp("gps_speed");
+    tags[2].value = pmt::from_double(std::numeric_limits<double>::infinity());
+    tags[3].offset = 900;
+    tags[3].key = pmt::mp("gps_speed");
+    tags[3].value = pmt::from_double(1e300);
+    for (auto& tag : tags) {
+        tag.srcid = pmt::PMT_F;
+    }
+
+    auto source = blocks::vector_source_c::make(input_data, false, 1, tags);
+    auto sink = blocks::vector_sink_c::make();
+    auto tb = gr::make_top_block("test");
+    tb->connect(source, 0, rake, 0);
+    tb->connect(rake, 0, sink, 0);
+    tb->run();
+
+    std::vector<uint64_t> adapt_offsets;
+    std::vector<long> adapt_fingers;
+    for (const auto& tag : sink->tags()) {
+        if (pmt::eq(tag.key, pmt::mp("rx_adapt"))) {
+            adapt_offsets.push_back(tag.offset);
+            adapt_fingers.push_back(pmt::to_long(
+                pmt::dict_ref(tag.value, pmt::mp("num_fingers"), pmt::PMT_NIL)));
+        }
+    }
+    std::vector<uint64_t> expected_offsets = {300, 700};
+    std::vector<long> expected_fingers = {3, 4};
+    BOOST_CHECK_EQUAL_COLLECTIONS(adapt_offsets.begin(),
+                                  adapt_offsets.end(),
+                                  expected_offsets.begin(),
+                                  expected_offsets.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(adapt_fingers.begin(),
+                                  adapt_fingers.end(),
+                                  expected_fingers.begin(),
+                                  expected_fingers.end());
+    BOOST_CHECK_EQUAL(rake->gps_speed(), 100.0f);
+
+    // Every output uses all taps of the active fingers
+    auto output = sink->data();
+    BOOST_REQUIRE_EQUAL(output.size(), input_data.size());
+    const long lead = 30 + pattern_length;
+    for (long n = 0; n < static_cast<long>(output.size()); n++) {
+        int active = (n >= 300 && n < 700) ? 3 : 4;
+        gr_complex expected(0.0f, 0.0f);
+        for (int f = 0; f < active; f++) {
+            for (int j = 0; j < pattern_length; j++) {
+                long idx = n - lead + delays[f] + j;
+                if (idx >= 0) {
+                    expected += gains[f] * input_data[idx];
+                }
+            }
+        }
+        BOOST_CHECK_SMALL(std::abs(output[n] - expected), 1e-4f);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_rake_receiver_cc_finger_tags)
+{
+    std::vector<int> delays = {0, 10, 20, 30};
+    std::vector<float> gains = {1.0f, 0.8f, 0.6f, 0.4f};
+    int pattern_length = 8;
+
+    std::vector<gr_complex> input_data(1000);
+    for (size_t n = 0; n < input_data.size(); n++) {
+        input_data[n] = gr_complex(std::cos(0.1f * n), std::sin(0.03f * n));
+    }
+
+    // New delays at 300, gains at 500 and pattern at 700; the delays at 800
+    // do not fit the delay line and are dropped
+    std::vector<int> new_delays = { 5, 15, 25, 30 };
+    std::vector<float> new_gains = { 0.5f, -0.5f, 0.25f, 1.0f };
+    std::vector<gr_complex> new_pattern(pattern_length);
+    for (int j = 0; j < pattern_length; j++) {
+        new_pattern[j] = gr_complex(j % 2 ? -1.0f : 1.0f, 0.5f);
+    }
+    std::vector<tag_t> tags(4);
+    tags[0].offset = 300;
+    tags[0].key = pmt::mp("rake_delays");
+    tags[0].value = pmt::init_s32vector(new_delays.size(), new_delays);
+    tags[1].offset = 500;
+    tags[1].key = pmt::mp("rake_gains");
+    tags[1].value = pmt::init_f32vector(new_gains.size(), new_gains);
+    tags[2].offset = 700;
+    tags[2].key = pmt::mp("rake_pattern");
+    tags[2].value = pmt::init_c32vector(new_pattern.size(), new_pattern);
+    tags[3].offset = 800;
+    tags[3].key = pmt::mp("rake_delays");
+    tags[3].value = pmt::init_s32vector(4, std::vector<int>{ 0, 10, 20, 31 });
+    for (auto& tag : tags) {
+        tag.srcid = pmt::PMT_F;
+    }
+
+    // The sparse delay line recorrelates its buffered outputs, so the new
+    // pattern applies from its tag on there too
+    const std::pair<const char*, const char*> runs[] = {
+        { "history", "scalar" },
+        { "history", "volk" },
+        { "sparse", "scalar" },
+        { "sparse", "volk" },
+    };
+    for (const auto& [mode, kernel] : runs) {
+        auto rake = rake_receiver_cc::make(4, delays, gains, pattern_length);
+        BOOST_CHECK_THROW(rake->set_kernel("fft"), std::invalid_argument);
+        rake->set_kernel(kernel);
+        BOOST_CHECK_EQUAL(rake->kernel(), kernel);
+        rake->set_delay_line_mode(mode, 30);
+
+        auto source = blocks::vector_source_c::make(input_data, false, 1, tags);
+        auto sink = blocks::vector_sink_c::make();
+        auto tb = gr::make_top_block("test");
+        tb->connect(source, 0, rake, 0);
+        tb->connect(rake, 0, sink, 0);
+        tb->run();
+
+        auto output = sink->data();
+        BOOST_REQUIRE_EQUAL(output.size(), input_data.size());
+        const long lead = 30 + pattern_length;
+        for (long n = 0; n < static_cast<long>(output.size()); n++) {
+            const std::vector<int>& d = n >= 300 ? new_delays : delays;
+            const std::vector<float>& g = n >= 500 ? new_gains : gains;
+            gr_complex expected(0.0f, 0.0f);
+            for (int f = 0; f < 4; f++) {
+                for (int j = 0; j < pattern_length; j++) {
+                    long idx = n - lead + d[f] + j;
+                    gr_complex p = n >= 700 ? new_pattern[j] : gr_complex(1.0f, 0.0f);
+                    if (idx >= 0) {
+                        expected += g[f] * input_data[idx] * std::conj(p);
+                    }
+                }
+            }
+            BOOST_CHECK_SMALL(std::abs(output[n] - expected), 1e-4f);
+        }
+        std::vector<int> final_delays = rake->delays();
+        BOOST_CHECK_EQUAL_COLLECTIONS(final_delays.begin(),
+                                      final_delays.end(),
+                                      new_delays.begin(),
+                                      new_delays.end());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_rake_receiver_cc_ubx)
+{
+    int num_fingers = 4;
+    std::vector<int> delays = {0, 10, 20, 30};
+    std::vector<float> gains = {1.0f, 0.8f, 0.6f, 0.4f};
+    int pattern_length = 42;
+
+    auto rake = rake_receiver_cc::make(num_fingers, delays, gains, pattern_length);
+    BOOST_REQUIRE(rake != nullptr);
+
+    // 15 m/s, 3D fix
+    BOOST_CHECK(rake->parse_ubx(make_nav_pvt(15000, 3, 200)));
+    BOOST_CHECK_CLOSE(rake->gps_speed(), 54.0f, 0.1f);
+
+    // Auto-detected, also with a NAV-PVT preceded by another UBX message
+    std::string ack("\xb5\x62\x05\x01\x02\x00\x06\x01\x0f\x38", 10);
+    BOOST_CHECK(rake->parse_gps_data(ack + make_nav_pvt(5000, 2, 200)));
+    BOOST_CHECK_CLOSE(rake->gps_speed(), 18.0f, 0.1f);
+
+    // Bad checksum, time-only fix and too large a speed error are rejected
+    std::string corrupt = make_nav_pvt(20000, 3, 200);
+    corrupt[70] ^= 0x01;
+    BOOST_CHECK(!rake->parse_gps_data(corrupt));
+    BOOST_CHECK(!rake->parse_ubx(make_nav_pvt(20000, 5, 200)));
+    rake->set_gps_max_speed_error(1.0f);
+    BOOST_CHECK(!rake->parse_ubx(make_nav_pvt(20000, 3, 500)));
+    BOOST_CHECK_CLOSE(rake->gps_speed(), 18.0f, 0.1f);
+
+    // GNSS + dead reckoning counts as a 3D fix
+    rake->set_gps_min_mode(3);
+    BOOST_CHECK(rake->parse_ubx(make_nav_pvt(25000, 4, 100)));
+    BOOST_CHECK_CLOSE(rake->gps_speed(), 90.0f, 0.1f);
+
+    // A negative gSpeed skips its frame, not the good one before it
+    const uint32_t negative_mm_s = static_cast<uint32_t>(-1000);
+    BOOST_CHECK(rake->parse_ubx(make_nav_pvt(10000, 3, 100) +
+                                make_nav_pvt(negative_mm_s, 3, 100)));
+    BOOST_CHECK_CLOSE(rake->gps_speed(), 36.0f, 0.1f);
+    BOOST_CHECK(!rake->parse_ubx(make_nav_pvt(negative_mm_s, 3, 100)));
+}
+
+BOOST_AUTO_TEST_CASE(test_rake_receiver_cc_gps_replay)
+{
+    int num_fingers = 4;
+    std::vector<int> delays = {0, 10, 20, 30};
+    std::vector<float> gains = {1.0f, 0.8f, 0.6f, 0.4f};
+    int pattern_length = 8;
+
+    auto rake = rake_receiver_cc::make(num_fingers, delays, gains, pattern_length);
+    BOOST_REQUIRE(rake != nullptr);
+    rake->set_adaptive_mode(true);
+
+    // One fix per second: 1 knot, 54 knots (100 km/h), then 1 knot again
+    std::string path =
+        (std::filesystem::temp_directory_path() / "qa_rake_receiver_replay.nmea").string();
+    {
+        std::ofstream file(path);
+        file << "$GPRMC,120000,A,4807.038,N,01131.000,E,001.0,084.4,010124,,*00\r\n"
+                "$GPRMC,120001,A,4807.038,N,01131.000,E,054.0,084.4,010124,,*00\r\n"
+                "$GPRMC,120001,V,4807.038,N,01131.000,E,200.0,084.4,010124,,*00\r\n"
+                "$GPRMC,120002,A,4807.038,N,01131.000,E,001.0,084.4,010124,,*00\r\n";
+    }
+    BOOST_CHECK_THROW(rake->load_gps_replay(path), std::invalid_argument);
+    rake->set_sample_rate(1000.0f);
+    BOOST_CHECK_EQUAL(rake->load_gps_replay(path), 3u);
+    std::filesystem::remove(path);
+    BOOST_CHECK_EQUAL(rake->gps_replay_remaining(), 3u);
+
+    std::vector<gr_complex> input_data(3000, gr_complex(1.0f, 0.0f));
+    auto source = blocks::vector_source_c::make(input_data, false);
+    auto sink = blocks::vector_sink_c::make();
+    auto tb = gr::make_top_block("test");
+    tb->connect(source, 0, rake, 0);
+    tb->connect(rake, 0, sink, 0);
+    tb->run();
+
+    std::vector<uint64_t> adapt_offsets;
+    std::vector<long> adapt_fingers;
+    for (const auto& tag : sink->tags()) {
+        if (pmt::eq(tag.key, pmt::mp("rx_adapt"))) {
+            adapt_offsets.push_back(tag.offset);
+            adapt_fingers.push_back(pmt::to_long(
+                pmt::dict_ref(tag.value, pmt::mp("num_fingers"), pmt::PMT_NIL)));
+        }
+    }
+    std::vector<uint64_t> expected_offsets = {0, 1000, 2000};
+    std::vector<long> expected_fingers = {3, 4, 3};
+    BOOST_CHECK_EQUAL_COLLECTIONS(adapt_offsets.begin(),
+                                  adapt_offsets.end(),
+                                  expected_offsets.begin(),
+                                  expected_offsets.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(adapt_fingers.begin(),
+                                  adapt_fingers.end(),
+                                  expected_fingers.begin(),
+                                  expected_fingers.end());
+    BOOST_CHECK_EQUAL(rake->gps_replay_remaining(), 0u);
+    BOOST_CHECK_CLOSE(rake->gps_speed(), 1.852f, 0.1f);
+}
+
+BOOST_AUTO_TEST_CASE(test_rake_receiver_cc_delay_cache)
+{
+    int num_fingers = 3;
+    std::vector<int> home_delays = {0, 4, 9};
+    std::vector<float> home_gains = {1.0f, 0.5f, 0.25f};
+    int pattern_length = 8;
+
+    auto rake =
+        rake_receiver_cc::make(num_fingers, home_delays, home_gains, pattern_length);
+    BOOST_REQUIRE(rake != nullptr);
+    BOOST_CHECK(!rake->delay_cache());
+    BOOST_CHECK_THROW(rake->set_delay_cache_tile_size(0.0f), std::invalid_argument);
+    BOOST_CHECK_THROW(rake->set_delay_cache_capacity(0), std::invalid_argument);
+    // Finer tiles would not fit the 32-bit row and column of a key
+    BOOST_CHECK_THROW(rake->set_delay_cache_tile_size(0.001f), std::invalid_argument);
+    rake->set_delay_cache(true);
+
+    // Two spots about 1 km apart, well outside one 200 m tile
+    rake->set_position(48.1173, 11.5167);
+    BOOST_CHECK_EQUAL(rake->delay_cache_size(), 0u);
+
+    std::vector<int> away_delays = {0, 2, 17};
+    std::vector<float> away_gains = {0.9f, 0.7f, 0.1f};
+    rake->parse_gps_data(
+        "$GPGGA,120000,4807.578,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47");
+    BOOST_CHECK_EQUAL(rake->delay_cache_size(), 1u);
+    rake->set_delays(away_delays);
+    rake->set_gains(away_gains);
+
+    // Coming back seeds the fingers from the first visit
+    rake->set_position(48.1173, 11.5167);
+    BOOST_CHECK_EQUAL(rake->delay_cache_size(), 2u);
+    std::vector<int> delays = rake->delays();
+    std::vector<float> gains = rake->gains();
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        delays.begin(), delays.end(), home_delays.begin(), home_delays.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        gains.begin(), gains.end(), home_gains.begin(), home_gains.end());
+
+    // A fix without a usable position does not move the tile
+    rake->parse_gps_data("$GPGGA,120001,4807.578,N,01131.000,E,0,00,,,M,,M,,*47");
+    BOOST_CHECK_EQUAL(rake->delay_cache_size(), 2u);
+    // Nor does a position that is no place on Earth
+    rake->set_position(std::nan(""), 11.5167);
+    rake->set_position(48.1263, 1e300);
+    BOOST_CHECK_EQUAL(rake->delay_cache_size(), 2u);
+
+    std::string path =
+        (std::filesystem::temp_directory_path() / "qa_rake_receiver_delays.bin").string();
+    rake->save_delay_cache(path);
+
+    // A fresh receiver warm-starts from the saved cache
+    auto restarted =
+        rake_receiver_cc::make(num_fingers, home_delays, home_gains, pattern_length);
+    restarted->set_delay_cache(true);
+    BOOST_CHECK_EQUAL(restarted->load_delay_cache(path), 2u);
+    std::filesystem::remove(path);
+    restarted->set_position(48.1263, 11.5167);
+    delays = restarted->delays();
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        delays.begin(), delays.end(), away_delays.begin(), away_delays.end());
+
+    // Least recently used tiles are dropped first
+    restarted->set_delay_cache_capacity(1);
+    BOOST_CHECK_EQUAL(restarted->delay_cache_size(), 1u);
+
+    std::string bogus =
+        (std::filesystem::temp_directory_path() / "qa_rake_receiver_bogus.bin").string();
+    {
+        std::ofstream file(bogus);
+        file << "not a cache";
+    }
+    BOOST_CHECK_THROW(restarted->load_delay_cache(bogus), std::runtime_error);
+    std::filesystem::remove(bogus);
+    BOOST_CHECK_EQUAL(restarted->delay_cache_size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(test_rake_receiver_cc_doppler_speed)
+{
+    std::vector<int> delays = {0, 3};
+    std::vector<float> gains = {1.0f, 0.2f};
+    auto rake = rake_receiver_cc::make(2, delays, gains, 1);
+    BOOST_REQUIRE(rake != nullptr);
+    BOOST_CHECK_THROW(rake->set_carrier_frequency(0.0), std::invalid_argument);
+    BOOST_CHECK_THROW(rake->set_doppler_decimation(0), std::invalid_argument);
+    BOOST_CHECK_THROW(rake->set_doppler_update_interval(0.0f), std::invalid_argument);
+
+    // 100 km/h at 1 GHz: f_D = 92.7 Hz
+    const double sample_rate = 100e3;
+    const double carrier = 1e9;
+    const double fd = 100.0 / 3.6 * carrier / 299792458.0;
+    rake->set_sample_rate(sample_rate);
+    rake->set_carrier_frequency(carrier);
+    rake->set_doppler_decimation(50);
+    rake->set_doppler_update_interval(1.0f);
+    rake->set_doppler_estimation(true);
+    rake->set_adaptive_mode(true);
+    BOOST_CHECK_EQUAL(rake->doppler_speed(), -1.0f);
+
+    auto source = blocks::vector_source_c::make(
+        make_fading(fd, sample_rate, static_cast<size_t>(2 * sample_rate)), false);
+    auto sink = blocks::vector_sink_c::make();
+    auto tb = gr::make_top_block("test");
+    tb->connect(source, 0, rake, 0);
+    tb->connect(rake, 0, sink, 0);
+    tb->run();
+
+    BOOST_CHECK_CLOSE(rake->doppler_spread(), fd, 15.0);
+    BOOST_CHECK_CLOSE(rake->doppler_speed(), 100.0f, 15.0f);
+
+    // The estimate drove adaptation without any GPS fix
+    bool adapted = false;
+    for (const auto& tag : sink->tags()) {
+        adapted |= pmt::eq(tag.key, pmt::mp("rx_adapt"));
+    }
+    BOOST_CHECK(adapted);
+    BOOST_CHECK_EQUAL(rake->gps_speed(), -1.0f);
+}
+
+BOOST_AUTO_TEST_CASE(test_rake_receiver_cc_state_snapshot)
+{
+    std::vector<int> delays = {0, 10, 20, 30};
+    std::vector<float> gains = {1.0f, 0.8f, 0.6f, 0.4f};
+    auto rake = rake_receiver_cc::make(4, delays, gains, 8);
+    BOOST_REQUIRE(rake != nullptr);
+
+    std::vector<int> learned_delays = {0, 7, 25, 41};
+    std::vector<float> learned_gains = {0.9f, 0.5f, 0.3f, 0.1f};
+    rake->set_delays(learned_delays);
+    rake->set_gains(learned_gains);
+    rake->set_lock_threshold(0.8f);
+    rake->set_speed_filter(true);
+    rake->set_adaptive_mode(true);
+    rake->set_gps_speed(100.0f);
+
+    auto dir = std::filesystem::temp_directory_path();
+    std::string path = (dir / "qa_rake_receiver_state.bin").string();
+    rake->save_state(path);
+
+    auto restored = rake_receiver_cc::make(4, delays, gains, 8);
+    restored->set_speed_filter(true);
+    restored->load_state(path);
+    std::vector<int> restored_delays = restored->delays();
+    std::vector<float> restored_gains = restored->gains();
+    BOOST_CHECK_EQUAL_COLLECTIONS(restored_delays.begin(),
+                                  restored_delays.end(),
+                                  learned_delays.begin(),
+                                  learned_delays.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(restored_gains.begin(),
+                                  restored_gains.end(),
+                                  learned_gains.begin(),
+                                  learned_gains.end());
+    BOOST_CHECK_EQUAL(restored->num_fingers(), rake->num_fingers());
+    BOOST_CHECK_EQUAL(restored->path_search_rate(), rake->path_search_rate());
+    BOOST_CHECK_EQUAL(restored->lock_threshold(), 0.8f);
+    BOOST_CHECK_EQUAL(restored->gps_speed(), 100.0f);
+    // The filter resumes from its estimate instead of waiting for fixes
+    BOOST_CHECK_CLOSE(restored->filtered_speed(), 100.0f, 1.0f);
+
+    auto other = rake_receiver_cc::make(3, { 0, 10, 20 }, { 1.0f, 0.8f, 0.6f }, 8);
+    BOOST_CHECK_THROW(other->load_state(path), std::invalid_argument);
+
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << "RKST";
+    }
+    BOOST_CHECK_THROW(restored->load_state(path), std::runtime_error);
+    std::filesystem::remove(path);
+
+    // With a state file, stop() saves and a new block picks the state up
+    std::string state_file = (dir / "qa_rake_receiver_restart.bin").string();
+    std::filesystem::remove(state_file);
+    auto first = rake_receiver_cc::make(4, delays, gains, 8);
+    first->set_state_file(state_file);
+    first->set_delays(learned_delays);
+    auto source = blocks::vector_source_c::make(
+        std::vector<gr_complex>(1000, gr_complex(1.0f, 0.0f)), false);
+    auto sink = blocks::vector_sink_c::make();
+    auto tb = gr::make_top_block("test");
+    tb->connect(source, 0, first, 0);
+    tb->connect(first, 0, sink, 0);
+    tb->run();
+    BOOST_REQUIRE(std::filesystem::exists(state_file));
+
+    auto second = rake_receiver_cc::make(4, delays, gains, 8);
+    second->set_state_file(state_file);
+    restored_delays = second->delays();
+    BOOST_CHECK_EQUAL_COLLECTIONS(restored_delays.begin(),
+                                  restored_delays.end(),
+                                  learned_delays.begin(),
+                                  learned_delays.end());
+    std::filesystem::remove(state_file);
+}
+
+BOOST_AUTO_TEST_CASE(test_rake_receiver_cc_ring_delay_line)
+{
+    std::vector<int> delays = {0, 5, 12, 40};
+    std::vector<float> gains = {1.0f, 0.8f, 0.6f, 0.4f};
+    int pattern_length = 8;
+
+    // Longer than the ring, so work() wraps it several times
+    std::vector<gr_complex> input_data(20000);
+    for (size_t i = 0; i < input_data.size(); i++) {
+        input_data[i] = gr_complex(std::cos(0.37f * i) + 0.1f * (i % 7),
+                                   std::sin(0.11f * i) - 0.05f * (i % 5));
+    }
+    auto run = [&](rake_receiver_cc::sptr rake) {
+        auto source = blocks::vector_source_c::make(input_data, false);
+        auto sink = blocks::vector_sink_c::make();
+        auto tb = gr::make_top_block("test");
+        tb->connect(source, 0, rake, 0);
+        tb->connect(rake, 0, sink, 0);
+        tb->run();
+        return sink->data();
+    };
+
+    auto reference = run(rake_receiver_cc::make(4, delays, gains, pattern_length));
+
+    auto rake = rake_receiver_cc::make(4, delays, gains, pattern_length);
+    BOOST_CHECK_EQUAL(rake->delay_line_mode(), "history");
+    BOOST_CHECK_THROW(rake->set_delay_line_mode("ring", 30), std::invalid_argument);
+    BOOST_CHECK_THROW(rake->set_delay_line_mode("tape", 40), std::invalid_argument);
+    rake->set_delay_line_mode("ring", 40);
+    BOOST_CHECK_EQUAL(rake->delay_line_mode(), "ring");
+    BOOST_CHECK_EQUAL(rake->max_delay(), 40);
+    BOOST_CHECK_EQUAL(rake->history(), 1u);
+    auto ring_output = run(rake);
+    BOOST_REQUIRE_EQUAL(ring_output.size(), reference.size());
+    for (size_t i = 0; i < reference.size(); i++) {
+        BOOST_REQUIRE_SMALL(std::abs(ring_output[i] - reference[i]), 1e-4f);
+    }
+
+    // A larger maximum delays the output by the extra headroom, and delays
+    // move within it without touching the history
+    auto roomy = rake_receiver_cc::make(4, delays, gains, pattern_length);
+    roomy->set_delay_line_mode("ring", 60);
+    roomy->set_delays({ 0, 5, 12, 60 });
+    BOOST_CHECK_THROW(roomy->set_delays({ 0, 5, 12, 61 }), std::invalid_argument);
+    roomy->set_delays(delays);
+    BOOST_CHECK_EQUAL(roomy->history(), 1u);
+    auto roomy_output = run(roomy);
+    for (size_t i = 20; i < reference.size(); i++) {
+        BOOST_REQUIRE_SMALL(std::abs(roomy_output[i] - reference[i - 20]), 1e-4f);
+    }
+
+    roomy->set_delay_line_mode("history");
+    BOOST_CHECK_EQUAL(roomy->history(), static_cast<unsigned>(40 + pattern_length + 1));
+}
+
+BOOST_AUTO_TEST_CASE(test_rake_receiver_cc_sparse_delay_line)
+{
+    std::vector<int> delays = {0, 5, 12, 40};
+    std::vector<float> gains = {1.0f, 0.8f, 0.6f, 0.4f};
+    int pattern_length = 8;
+
+    std::vector<gr_complex> input_data(20000);
+    for (size_t i = 0; i < input_data.size(); i++) {
+        input_data[i] = gr_complex(std::cos(0.37f * i) + 0.1f * (i % 7),
+                                   std::sin(0.11f * i) - 0.05f * (i % 5));
+    }
+    auto run = [&](rake_receiver_cc::sptr rake) {
+        auto source = blocks::vector_source_c::make(input_data, false);
+        auto sink = blocks::vector_sink_c::make();
+        auto tb = gr::make_top_block("test");
+        tb->connect(source, 0, rake, 0);
+        tb->connect(rake, 0, sink, 0);
+        tb->run();
+        return sink->data();
+    };
+
+    auto reference = run(rake_receiver_cc::make(4, delays, gains, pattern_length));
+
+    auto rake = rake_receiver_cc::make(4, delays, gains, pattern_length);
+    BOOST_CHECK_THROW(rake->set_delay_line_mode("sparse", 30), std::invalid_argument);
+    rake->set_delay_line_mode("sparse", 40);
+    BOOST_CHECK_EQUAL(rake->delay_line_mode(), "sparse");
+    BOOST_CHECK_EQUAL(rake->max_delay(), 40);
+    BOOST_CHECK_EQUAL(rake->history(), 1u);
+    auto sparse_output = run(rake);
+    BOOST_REQUIRE_EQUAL(sparse_output.size(), reference.size());
+    for (size_t i = 0; i < reference.size(); i++) {
+        BOOST_REQUIRE_SMALL(std::abs(sparse_output[i] - reference[i]), 1e-4f);
+    }
+
+    // Delays far beyond the pattern length match the ring mode
+    std::vector<int> long_delays = { 0, 1500, 9000, 15000 };
+    auto ring = rake_receiver_cc::make(4, delays, gains, pattern_length);
+    ring->set_delay_line_mode("ring", 15000);
+    ring->set_delays(long_delays);
+    auto ring_output = run(ring);
+    auto sparse = rake_receiver_cc::make(4, delays, gains, pattern_length);
+    sparse->set_delay_line_mode("sparse", 15000);
+    sparse->set_delays(long_delays);
+    BOOST_CHECK_THROW(sparse->set_delays({ 0, 1500, 9000, 15001 }),
+                      std::invalid_argument);
+    auto long_output = run(sparse);
+    BOOST_REQUIRE_EQUAL(long_output.size(), ring_output.size());
+    for (size_t i = 0; i < ring_output.size(); i++) {
+        BOOST_REQUIRE_SMALL(std::abs(long_output[i] - ring_output[i]), 1e-4f);
+    }
+
+    // Per-finger SNR and lock state are estimated in sparse mode as well
+    auto stats_rake = rake_receiver_cc::make(4, delays, gains, pattern_length);
+    stats_rake->set_delay_line_mode("sparse", 40);
+    stats_rake->set_sample_rate(1000.0f);
+    stats_rake->set_stats_interval(1.0f);
+    auto source = blocks::vector_source_c::make(
+        std::vector<gr_complex>(4096, gr_complex(1.0f, 0.0f)), false);
+    auto sink = blocks::vector_sink_c::make();
+    auto debug = blocks::message_debug::make();
+    auto tb = gr::make_top_block("test");
+    tb->connect(source, 0, stats_rake, 0);
+    tb->connect(stats_rake, 0, sink, 0);
+    tb->msg_connect(stats_rake, "stats", debug, "store");
+    tb->run();
+
+    BOOST_REQUIRE_GE(debug->num_messages(), 1);
+    pmt::pmt_t stats = debug->get_message(0);
+    auto snr =
+        pmt::f32vector_elements(pmt::dict_ref(stats, pmt::mp("snr_db"), pmt::PMT_NIL));
+    pmt::pmt_t locked = pmt::dict_ref(stats, pmt::mp("locked"), pmt::PMT_NIL);
+    BOOST_REQUIRE_EQUAL(snr.size(), 4u);
+    for (size_t f = 0; f < snr.size(); f++) {
+        BOOST_CHECK_GT(snr[f], 30.0f);
+        BOOST_CHECK(pmt::to_bool(pmt::vector_ref(locked, f)));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_rake_receiver_cc_counters)
+{
+    std::vector<int> delays = {0, 10, 20, 30};
+    std::vector<float> gains = {1.0f, 0.8f, 0.6f, 0.4f};
+    int pattern_length = 8;
+    auto rake = rake_receiver_cc::make(4, delays, gains, pattern_length);
+    BOOST_CHECK_EQUAL(rake->work_calls(), 0u);
+
+    // A constant input makes every finger correlate to pattern_length
+    std::vector<gr_complex> input_data(4096, gr_complex(1.0f, 0.0f));
+    auto source = blocks::vector_source_c::make(input_data, false);
+    auto sink = blocks::vector_sink_c::make();
+    auto tb = gr::make_top_block("test");
+    tb->connect(source, 0, rake, 0);
+    tb->connect(rake, 0, sink, 0);
+    tb->run();
+
+    BOOST_CHECK_GT(rake->work_calls(), 0u);
+    BOOST_CHECK_EQUAL(rake->items_processed(), input_data.size());
+    BOOST_CHECK_GT(rake->work_time(), 0.0);
+    auto energy = rake->finger_energy();
+    BOOST_REQUIRE_EQUAL(energy.size(), delays.size());
+    for (float e : energy) {
+        BOOST_CHECK_CLOSE(e, 64.0f, 2.0f);
+    }
+
+    rake->set_adaptive_mode(true);
+    uint64_t reconfigurations = rake->reconfigurations();
+    BOOST_CHECK(rake->parse_nmea0183(
+        "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A"));
+    BOOST_CHECK(!rake->parse_nmea0183("$GPRMC,123519,V,,,,,,,230394,,*00"));
+    BOOST_CHECK(!rake->parse_gpsd("{\"class\":\"TPV\",\"mode\":1}"));
+    BOOST_CHECK_EQUAL(rake->gps_fixes_accepted(), 1u);
+    BOOST_CHECK_EQUAL(rake->gps_fixes_rejected(), 2u);
+    BOOST_CHECK_GT(rake->reconfigurations(), reconfigurations);
+
+    rake->reset_counters();
+    BOOST_CHECK_EQUAL(rake->work_calls(), 0u);
+    BOOST_CHECK_EQUAL(rake->items_processed(), 0u);
+    BOOST_CHECK_EQUAL(rake->gps_fixes_accepted(), 0u);
+    BOOST_CHECK_EQUAL(rake->work_time(), 0.0);
+    BOOST_CHECK_EQUAL(rake->finger_energy()[0], 0.0f);
+}
+
+BOOST_AUTO_TEST_CASE(test_rake_receiver_cc_stats_messages)
+{
+    std::vector<int> delays = {0, 10};
+    std::vector<float> gains = {1.0f, 0.5f};
+    auto rake = rake_receiver_cc::make(2, delays, gains, 8);
+    BOOST_CHECK_EQUAL(rake->stats_interval(), 0.0f);
+    BOOST_CHECK_THROW(rake->set_stats_interval(-1.0f), std::invalid_argument);
+
+    // One message per 1000 samples of stream time
+    rake->set_sample_rate(1000.0f);
+    rake->set_stats_interval(1.0f);
+    std::vector<gr_complex> input_data(4096, gr_complex(1.0f, 0.0f));
+    auto source = blocks::vector_source_c::make(input_data, false);
+    auto sink = blocks::vector_sink_c::make();
+    auto debug = blocks::message_debug::make();
+    auto tb = gr::make_top_block("test");
+    tb->connect(source, 0, rake, 0);
+    tb->connect(rake, 0, sink, 0);
+    tb->msg_connect(rake, "stats", debug, "store");
+    tb->run();
+
+    BOOST_REQUIRE_GE(debug->num_messages(), 1);
+    BOOST_CHECK_LE(debug->num_messages(), 4);
+    pmt::pmt_t stats = debug->get_message(0);
+    BOOST_REQUIRE(pmt::is_dict(stats));
+    BOOST_CHECK_EQUAL(
+        pmt::to_long(pmt::dict_ref(stats, pmt::mp("num_fingers"), pmt::PMT_NIL)), 2);
+    BOOST_CHECK_EQUAL(pmt::s32vector_elements(
+                          pmt::dict_ref(stats, pmt::mp("delays"), pmt::PMT_NIL))[1],
+                      10);
+    BOOST_CHECK_GE(pmt::to_uint64(pmt::dict_ref(stats, pmt::mp("items"), pmt::PMT_NIL)),
+                   1000u);
+    BOOST_CHECK_EQUAL(pmt::symbol_to_string(pmt::dict_ref(
+                          stats, pmt::mp("speed_category"), pmt::PMT_NIL)),
+                      "none");
+
+    // A noiseless input matching the pattern is a high SNR on every finger
+    auto snr =
+        pmt::f32vector_elements(pmt::dict_ref(stats, pmt::mp("snr_db"), pmt::PMT_NIL));
+    pmt::pmt_t locked = pmt::dict_ref(stats, pmt::mp("locked"), pmt::PMT_NIL);
+    BOOST_REQUIRE_EQUAL(snr.size(), 2u);
+    for (size_t f = 0; f < snr.size(); f++) {
+        BOOST_CHECK_GT(snr[f], 30.0f);
+        BOOST_CHECK(pmt::to_bool(pmt::vector_ref(locked, f)));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_rake_receiver_cc_latency_probe)
+{
+    std::vector<int> delays = {0, 10, 20};
+    std::vector<float> gains = {1.0f, 0.5f, 0.25f};
+    auto rake = rake_receiver_cc::make(3, delays, gains, 16);
+    BOOST_CHECK_EQUAL(rake->group_delay(), 20 + 16);
+    BOOST_CHECK(!rake->latency_probe());
+    BOOST_CHECK_THROW(rake->set_latency_probe(true, -1), std::invalid_argument);
+
+    // A pattern starting at sample 100 peaks group_delay() samples later
+    std::vector<gr_complex> input_data(400, gr_complex(0.0f, 0.0f));
+    for (int j = 0; j < 16; j++) {
+        input_data[100 + j] = gr_complex(1.0f, 0.0f);
+    }
+    // An upstream probe stamped one second ago
+    const uint64_t stamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::steady_clock::now().time_since_epoch())
+                               .count() -
+                           1000000000ull;
+    tag_t probe;
+    probe.offset = 50;
+    probe.key = pmt::mp("latency_probe");
+    probe.value = pmt::from_uint64(stamp);
+    probe.srcid = pmt::mp("source");
+    // Another on a sample the block would stamp itself
+    tag_t aligned_probe = probe;
+    aligned_probe.offset = 100;
+    auto source = blocks::vector_source_c::make(
+        input_data, false, 1, std::vector<tag_t>{ probe, aligned_probe });
+    auto sink = blocks::vector_sink_c::make();
+    auto debug = blocks::message_debug::make();
+    // Own probes every 100 samples, stats after every work() call
+    rake->set_latency_probe(true, 100);
+    rake->set_sample_rate(1000.0f);
+    rake->set_stats_interval(0.001f);
+    auto tb = gr::make_top_block("test");
+    tb->connect(source, 0, rake, 0);
+    tb->connect(rake, 0, sink, 0);
+    tb->msg_connect(rake, "stats", debug, "store");
+    tb->run();
+
+    auto output = sink->data();
+    BOOST_REQUIRE_EQUAL(output.size(), input_data.size());
+    size_t peak = 0;
+    for (size_t n = 0; n < output.size(); n++) {
+        if (std::abs(output[n]) > std::abs(output[peak])) {
+            peak = n;
+        }
+    }
+    BOOST_CHECK_EQUAL(peak, 100u + rake->group_delay());
+
+    // One probe per stamped sample; at 100 the upstream one stands in
+    int own_probes = 0;
+    std::map<uint64_t, int> probes_at;
+    for (const tag_t& tag : sink->tags()) {
+        if (pmt::eq(tag.key, pmt::mp("latency_probe"))) {
+            probes_at[tag.offset]++;
+            own_probes += pmt::eq(tag.srcid, pmt::mp(rake->alias()));
+        }
+    }
+    BOOST_CHECK_EQUAL(own_probes, 3);
+    BOOST_CHECK_EQUAL(probes_at.size(), 5u);
+    for (const auto& offset_count : probes_at) {
+        BOOST_CHECK_EQUAL(offset_count.second, 1);
+    }
+
+    // All five probes are matched; the upstream ones are a second old
+    uint64_t count = 0;
+    double max_us = 0.0;
+    for (size_t i = 0; i < debug->num_messages(); i++) {
+        pmt::pmt_t stats = debug->get_message(i);
+        count += pmt::to_uint64(
+            pmt::dict_ref(stats, pmt::mp("latency_count"), pmt::PMT_NIL));
+        pmt::pmt_t latency_max =
+            pmt::dict_ref(stats, pmt::mp("latency_max_us"), pmt::PMT_NIL);
+        max_us = std::max(max_us, pmt::to_double(latency_max));
+        BOOST_CHECK_EQUAL(
+            pmt::to_long(pmt::dict_ref(stats, pmt::mp("group_delay"), pmt::PMT_NIL)), 36);
+    }
+    BOOST_CHECK_EQUAL(count, 5u);
+    BOOST_CHECK_GE(max_us, 1e6);
+    BOOST_CHECK_LT(max_us, 1e6 + 10e6);
+
+    // Ring and sparse modes delay by the configured maximum
+    rake->set_delay_line_mode("ring", 100);
+    BOOST_CHECK_EQUAL(rake->group_delay(), 100 + 16);
+    rake->set_delay_line_mode("sparse", 50);
+    BOOST_CHECK_EQUAL(rake->group_delay(), 50 + 16);
+}
+
+BOOST_AUTO_TEST_CASE(test_rake_receiver_cc_kernel_autotune)
+{
+    const std::string profile =
+        (std::filesystem::temp_directory_path() / "qa_rake_receiver_kernels").string();
+    std::filesystem::remove(profile);
+
+    std::vector<int> delays = { 0, 10, 20 };
+    std::vector<float> gains = { 1.0f, 0.5f, 0.25f };
+    std::vector<gr_complex> input_data(2000);
+    for (size_t i = 0; i < input_data.size(); i++) {
+        input_data[i] = gr_complex(std::sin(0.1f * i), std::cos(0.3f * i));
+    }
+    auto run = [&](rake_receiver_cc::sptr rake) {
+        auto source = blocks::vector_source_c::make(input_data, false);
+        auto sink = blocks::vector_sink_c::make();
+        auto tb = gr::make_top_block("test");
+        tb->connect(source, 0, rake, 0);
+        tb->connect(rake, 0, sink, 0);
+        tb->run();
+        return sink->data();
+    };
+
+    // Timed at start() and written to the profile
+    auto tuned = rake_receiver_cc::make(3, delays, gains, 64);
+    tuned->set_kernel_profile(profile);
+    tuned->set_kernel("auto");
+    BOOST_CHECK(tuned->kernel_autotune());
+    auto output = run(tuned);
+    BOOST_CHECK(tuned->kernel() == "scalar" || tuned->kernel() == "volk");
+
+    std::ifstream in(profile);
+    std::string line, entry;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line[0] != '#') {
+            BOOST_CHECK(entry.empty());
+            entry = line;
+        }
+    }
+    BOOST_REQUIRE(!entry.empty());
+    BOOST_CHECK_NE(entry.find("\tcombine\t3\t64\t32\t"), std::string::npos);
+
+    // Later startups take the kernel from the profile without timing it
+    for (const char* kernel : { "scalar", "volk" }) {
+        std::ofstream(profile) << entry.substr(0, entry.rfind('\t') + 1) << kernel << "\n";
+        auto cached = rake_receiver_cc::make(3, delays, gains, 64);
+        cached->set_kernel_profile(profile);
+        cached->set_kernel("auto");
+        auto cached_output = run(cached);
+        BOOST_CHECK_EQUAL(cached->kernel(), kernel);
+        BOOST_REQUIRE_EQUAL(cached_output.size(), output.size());
+        for (size_t n = 0; n < output.size(); n++) {
+            BOOST_CHECK_SMALL(std::abs(cached_output[n] - output[n]), 1e-3f);
+        }
+    }
+
+    // Naming a kernel ends autotuning
+    tuned->set_kernel("scalar");
+    BOOST_CHECK(!tuned->kernel_autotune());
+    BOOST_CHECK_EQUAL(tuned->kernel(), "scalar");
+    BOOST_CHECK_THROW(tuned->set_kernel("fastest"), std::invalid_argument);
+    std::filesystem::remove(profile);
+}
+
 } /* namespace rake_receiver */
 } /* namespace gr */
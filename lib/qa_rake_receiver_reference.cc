@@ -0,0 +1,342 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+/*
+ * Differential tests: every correlation kernel and delay line mode against a
+ * double precision reference of the RAKE combiner, over random fingers,
+ * delays, gains, patterns and buffer boundaries.
+ *
+ * With RAKE_PERF_BASELINE=<file> set, test_rake_receiver_perf_baseline also
+ * times each kernel. The first run records the throughput in the file and
+ * later runs fail when a kernel is slower than RAKE_PERF_TOLERANCE (default
+ * 0.2) below it. Baselines only compare runs on the same machine.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/attributes.h>
+#include <gnuradio/rake_receiver/rake_receiver_cc.h>
+#include <gnuradio/blocks/vector_sink.h>
+#include <gnuradio/blocks/vector_source.h>
+#include <gnuradio/top_block.h>
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cfloat>
+#include <complex>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace gr {
+namespace rake_receiver {
+
+namespace {
+
+/*
+ * Allowed error of each kernel, as a multiple of the worst case error of
+ * summing every term in float one after the other. New kernels are added
+ * here; a kernel the library does not provide is skipped.
+ */
+struct kernel_tolerance {
+    const char* name;
+    double factor;
+};
+
+const kernel_tolerance kernel_tolerances[] = {
+    { "scalar", 1.0 },
+    { "volk", 1.0 },
+};
+
+struct rake_case {
+    std::vector<int> delays;
+    std::vector<float> gains;
+    std::vector<gr_complex> pattern;
+    std::vector<gr_complex> input;
+    std::string mode;
+    int max_delay;
+};
+
+/*
+ * The combiner by its definition:
+ *
+ *   out[n] = sum_f gains[f] * sum_j x[n - D - L + delays[f] + j] * conj(p[j])
+ *
+ * with x zero before the stream, L the pattern length and D the largest
+ * delay the delay line holds: the largest finger delay in history mode, the
+ * configured maximum in ring and sparse mode. Also returns the sum of the
+ * magnitudes of all terms, which scales the rounding error.
+ */
+void reference_rake(const rake_case& c,
+                    std::vector<std::complex<double>>& out,
+                    std::vector<double>& magnitude)
+{
+    const int length = static_cast<int>(c.pattern.size());
+    const int span =
+        (c.mode == "history" ? *std::max_element(c.delays.begin(), c.delays.end())
+                             : c.max_delay) +
+        length;
+    out.assign(c.input.size(), 0.0);
+    magnitude.assign(c.input.size(), 0.0);
+    for (int n = 0; n < static_cast<int>(c.input.size()); n++) {
+        for (size_t f = 0; f < c.delays.size(); f++) {
+            std::complex<double> sum = 0.0;
+            double finger_magnitude = 0.0;
+            for (int j = 0; j < length; j++) {
+                int k = n - span + c.delays[f] + j;
+                if (k < 0) {
+                    continue;
+                }
+                std::complex<double> x(c.input[k]);
+                std::complex<double> p(c.pattern[j]);
+                sum += x * std::conj(p);
+                finger_magnitude += std::abs(x) * std::abs(p);
+            }
+            out[n] += static_cast<double>(c.gains[f]) * sum;
+            magnitude[n] += std::abs(c.gains[f]) * finger_magnitude;
+        }
+    }
+}
+
+rake_case random_case(std::mt19937& rng, const std::string& mode)
+{
+    std::uniform_int_distribution<int> fingers(1, 5);
+    std::uniform_int_distribution<int> delay(0, 300);
+    std::uniform_int_distribution<int> pattern_length(1, 128);
+    std::uniform_int_distribution<int> input_length(1, 6000);
+    std::uniform_int_distribution<int> headroom(0, 64);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+
+    rake_case c;
+    c.mode = mode;
+    c.delays.resize(fingers(rng));
+    for (int& d : c.delays) {
+        d = delay(rng);
+    }
+    c.gains.resize(c.delays.size());
+    for (float& g : c.gains) {
+        g = noise(rng);
+    }
+    c.pattern.resize(pattern_length(rng));
+    for (auto& p : c.pattern) {
+        p = gr_complex(noise(rng), noise(rng));
+    }
+    c.input.resize(input_length(rng));
+    for (auto& x : c.input) {
+        x = gr_complex(noise(rng), noise(rng));
+    }
+    c.max_delay = *std::max_element(c.delays.begin(), c.delays.end()) + headroom(rng);
+    return c;
+}
+
+rake_receiver_cc::sptr make_rake(const rake_case& c, const std::string& kernel)
+{
+    auto rake = rake_receiver_cc::make(
+        c.delays.size(), c.delays, c.gains, static_cast<int>(c.pattern.size()));
+    rake->set_pattern(c.pattern);
+    rake->set_kernel(kernel);
+    if (c.mode != "history") {
+        rake->set_delay_line_mode(c.mode, c.max_delay);
+    }
+    return rake;
+}
+
+std::vector<gr_complex> run_rake(rake_receiver_cc::sptr rake,
+                                 const std::vector<gr_complex>& input,
+                                 int max_noutput_items)
+{
+    auto source = blocks::vector_source_c::make(input, false);
+    auto sink = blocks::vector_sink_c::make();
+    auto tb = gr::make_top_block("reference");
+    tb->connect(source, 0, rake, 0);
+    tb->connect(rake, 0, sink, 0);
+    if (max_noutput_items > 0) {
+        // Moves the work() boundaries around
+        rake->set_max_noutput_items(max_noutput_items);
+    }
+    tb->run();
+    return sink->data();
+}
+
+bool kernel_available(const std::string& name)
+{
+    auto rake = rake_receiver_cc::make(1, { 0 }, { 1.0f }, 1);
+    try {
+        rake->set_kernel(name);
+    } catch (const std::invalid_argument&) {
+        BOOST_TEST_MESSAGE("Kernel " << name << " not built, skipped");
+        return false;
+    }
+    return true;
+}
+
+void check_against_reference(const std::string& mode, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> max_items(1, 2048);
+    for (const kernel_tolerance& tolerance : kernel_tolerances) {
+        if (!kernel_available(tolerance.name)) {
+            continue;
+        }
+        for (int trial = 0; trial < 25; trial++) {
+            rake_case c = random_case(rng, mode);
+            std::vector<std::complex<double>> expected;
+            std::vector<double> magnitude;
+            reference_rake(c, expected, magnitude);
+
+            auto output = run_rake(make_rake(c, tolerance.name), c.input, max_items(rng));
+            BOOST_REQUIRE_EQUAL(output.size(), c.input.size());
+
+            const double terms = c.pattern.size() + c.delays.size() + 2;
+            int failures = 0;
+            for (size_t n = 0; n < output.size() && failures < 5; n++) {
+                double bound = tolerance.factor * terms * FLT_EPSILON * magnitude[n] +
+                               FLT_MIN;
+                double error = std::abs(std::complex<double>(output[n]) - expected[n]);
+                if (error > bound) {
+                    BOOST_ERROR(mode << "/" << tolerance.name << " trial " << trial
+                                     << " output " << n << ": error " << error
+                                     << " exceeds " << bound << " (fingers "
+                                     << c.delays.size() << ", pattern length "
+                                     << c.pattern.size() << ")");
+                    failures++;
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_rake_receiver_reference_history)
+{
+    check_against_reference("history", 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_rake_receiver_reference_ring)
+{
+    check_against_reference("ring", 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_rake_receiver_reference_sparse)
+{
+    check_against_reference("sparse", 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_rake_receiver_reference_modes_agree)
+{
+    // Same max_delay in all modes gives the same alignment, so any kernel in
+    // any mode must match the scalar kernel in history mode
+    std::mt19937 rng(4);
+    for (int trial = 0; trial < 10; trial++) {
+        rake_case c = random_case(rng, "ring");
+        c.max_delay = *std::max_element(c.delays.begin(), c.delays.end());
+        rake_case history = c;
+        history.mode = "history";
+        auto expected = run_rake(make_rake(history, "scalar"), c.input, 0);
+        for (const char* mode : { "ring", "sparse" }) {
+            c.mode = mode;
+            auto output = run_rake(make_rake(c, "scalar"), c.input, 0);
+            BOOST_REQUIRE_EQUAL(output.size(), expected.size());
+            for (size_t n = 0; n < output.size(); n++) {
+                BOOST_REQUIRE_SMALL(std::abs(output[n] - expected[n]),
+                                    1e-3f * (1.0f + std::abs(expected[n])));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_rake_receiver_perf_baseline)
+{
+    const char* baseline_path = std::getenv("RAKE_PERF_BASELINE");
+    if (!baseline_path) {
+        BOOST_TEST_MESSAGE("RAKE_PERF_BASELINE not set, performance check skipped");
+        return;
+    }
+    const char* tolerance_env = std::getenv("RAKE_PERF_TOLERANCE");
+    const double tolerance = tolerance_env ? std::atof(tolerance_env) : 0.2;
+
+    std::map<std::string, double> baseline;
+    {
+        std::ifstream file(baseline_path);
+        std::string key;
+        double samples_per_second;
+        while (file >> key >> samples_per_second) {
+            baseline[key] = samples_per_second;
+        }
+    }
+
+    // A typical configuration: four fingers, 256-chip pattern
+    rake_case c;
+    c.mode = "history";
+    c.delays = { 0, 12, 40, 90 };
+    c.gains = { 1.0f, 0.7f, 0.5f, 0.3f };
+    c.pattern.assign(256, gr_complex(1.0f, -1.0f));
+    c.input.resize(1 << 18);
+    std::mt19937 rng(5);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    for (auto& x : c.input) {
+        x = gr_complex(noise(rng), noise(rng));
+    }
+    c.max_delay = 90;
+
+    std::map<std::string, double> measured;
+    for (const kernel_tolerance& kernel : kernel_tolerances) {
+        if (!kernel_available(kernel.name)) {
+            continue;
+        }
+        // Best of three, to ride out other load on the machine
+        double best = 0.0;
+        for (int run = 0; run < 3; run++) {
+            auto rake = make_rake(c, kernel.name);
+            auto start = std::chrono::steady_clock::now();
+            run_rake(rake, c.input, 0);
+            double seconds =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                    .count();
+            best = std::max(best, c.input.size() / seconds);
+        }
+        std::ostringstream key;
+        key << kernel.name << "/f" << c.delays.size() << "/l" << c.pattern.size();
+        measured[key.str()] = best;
+        BOOST_TEST_MESSAGE(key.str() << ": " << best << " samples/s");
+
+        auto recorded = baseline.find(key.str());
+        if (recorded != baseline.end()) {
+            BOOST_CHECK_MESSAGE(best >= (1.0 - tolerance) * recorded->second,
+                                key.str() << " at " << best
+                                          << " samples/s, baseline "
+                                          << recorded->second);
+        }
+    }
+
+    // Record kernels that had no baseline yet; existing entries are kept so
+    // a slow run never lowers the bar
+    bool changed = false;
+    for (const auto& [key, samples_per_second] : measured) {
+        if (baseline.emplace(key, samples_per_second).second) {
+            changed = true;
+        }
+    }
+    if (changed) {
+        std::ofstream file(baseline_path);
+        for (const auto& [key, samples_per_second] : baseline) {
+            file << key << " " << samples_per_second << "\n";
+        }
+    }
+}
+
+} /* namespace rake_receiver */
+} /* namespace gr */
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef INCLUDED_RAKE_RECEIVER_RAKE_COUNTERS_H
+#define INCLUDED_RAKE_RECEIVER_RAKE_COUNTERS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace gr {
+namespace rake_receiver {
+
+constexpr size_t cache_line_size = 64;
+
+//! An atomic on a cache line of its own, so writers never false-share
+template <typename T>
+struct alignas(cache_line_size) padded_atomic {
+    std::atomic<T> value{ T() };
+
+    T load() const { return value.load(std::memory_order_relaxed); }
+};
+
+/*!
+ * \brief Performance counters of one rake_receiver_cc
+ *
+ * Written from work() and the GPS handlers, read by monitoring at any time
+ * without locks. All accesses are relaxed: each counter is exact, but a
+ * reader may see one counter updated before another.
+ */
+struct rake_counters {
+    static constexpr int max_fingers = 5;
+
+    padded_atomic<uint64_t> work_calls;
+    padded_atomic<uint64_t> work_time_ns;
+    padded_atomic<uint64_t> items;
+    padded_atomic<uint64_t> reconfigurations;
+    padded_atomic<uint64_t> gps_fixes_accepted;
+    padded_atomic<uint64_t> gps_fixes_rejected;
+    padded_atomic<uint64_t> estimator_time_ns;
+    padded_atomic<uint64_t> energy_samples;
+    std::array<padded_atomic<double>, max_fingers> finger_energy;
+
+    static void add(padded_atomic<uint64_t>& counter, uint64_t n)
+    {
+        counter.value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    // Only work() writes the energies, so a plain load and store suffices
+    static void accumulate(padded_atomic<double>& sum, double x)
+    {
+        sum.value.store(sum.load() + x, std::memory_order_relaxed);
+    }
+
+    void reset()
+    {
+        for (auto* counter : { &work_calls,
+                               &work_time_ns,
+                               &items,
+                               &reconfigurations,
+                               &gps_fixes_accepted,
+                               &gps_fixes_rejected,
+                               &estimator_time_ns,
+                               &energy_samples }) {
+            counter->value.store(0, std::memory_order_relaxed);
+        }
+        for (auto& energy : finger_energy) {
+            energy.value.store(0.0, std::memory_order_relaxed);
+        }
+    }
+};
+
+/*!
+ * \brief Adds the lifetime of the timer to a nanosecond counter
+ */
+class scoped_timer
+{
+public:
+    explicit scoped_timer(padded_atomic<uint64_t>& counter)
+        : d_counter(counter), d_start(std::chrono::steady_clock::now())
+    {
+    }
+    ~scoped_timer()
+    {
+        auto elapsed = std::chrono::steady_clock::now() - d_start;
+        rake_counters::add(
+            d_counter,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+    scoped_timer(const scoped_timer&) = delete;
+    scoped_timer& operator=(const scoped_timer&) = delete;
+
+private:
+    padded_atomic<uint64_t>& d_counter;
+    std::chrono::steady_clock::time_point d_start;
+};
+
+} // namespace rake_receiver
+} // namespace gr
+
+#endif /* INCLUDED_RAKE_RECEIVER_RAKE_COUNTERS_H */
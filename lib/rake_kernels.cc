@@ -0,0 +1,101 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "rake_kernels.h"
+#include <volk/volk.h>
+
+namespace gr {
+namespace rake_receiver {
+
+namespace {
+
+gr_complex correlate_scalar(const gr_complex* input,
+                            const gr_complex* pattern,
+                            int length)
+{
+    gr_complex sum = gr_complex(0.0f, 0.0f);
+    for (int j = 0; j < length; j++) {
+        sum += input[j] * std::conj(pattern[j]);
+    }
+    return sum;
+}
+
+gr_complex correlate_volk(const gr_complex* input,
+                          const gr_complex* pattern,
+                          int length)
+{
+    // Dispatches to the fastest machine for this CPU; windows start at any
+    // sample, so the unaligned variants are picked
+    gr_complex sum;
+    volk_32fc_x2_conjugate_dot_prod_32fc(
+        &sum, input, pattern, static_cast<unsigned int>(length));
+    return sum;
+}
+
+} // namespace
+
+const std::vector<rake_kernel>& rake_kernels()
+{
+    static const std::vector<rake_kernel> kernels = {
+        { "scalar", correlate_scalar },
+        { "volk", correlate_volk },
+    };
+    return kernels;
+}
+
+const rake_kernel* find_rake_kernel(const std::string& name)
+{
+    for (const rake_kernel& kernel : rake_kernels()) {
+        if (name == kernel.name) {
+            return &kernel;
+        }
+    }
+    return nullptr;
+}
+
+void rake_combine(const rake_kernel& kernel,
+                  const gr_complex* windows,
+                  const int* delays,
+                  const float* gains,
+                  int num_fingers,
+                  const gr_complex* pattern,
+                  int pattern_length,
+                  gr_complex* out,
+                  int count)
+{
+    const correlate_fn correlate = kernel.correlate;
+    for (int i = 0; i < count; i++) {
+        gr_complex combined = gr_complex(0.0f, 0.0f);
+        for (int finger = 0; finger < num_fingers; finger++) {
+            const gr_complex* delayed_input = &windows[i + delays[finger]];
+            combined += gains[finger] * correlate(delayed_input, pattern, pattern_length);
+        }
+        out[i] = combined;
+    }
+}
+
+void rake_correlate(const rake_kernel& kernel,
+                    const gr_complex* input,
+                    const gr_complex* pattern,
+                    int pattern_length,
+                    gr_complex* out,
+                    int count)
+{
+    const correlate_fn correlate = kernel.correlate;
+    for (int i = 0; i < count; i++) {
+        out[i] = correlate(input + i, pattern, pattern_length);
+    }
+}
+
+} // namespace rake_receiver
+} // namespace gr
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef INCLUDED_RAKE_RECEIVER_RAKE_KERNELS_H
+#define INCLUDED_RAKE_RECEIVER_RAKE_KERNELS_H
+
+#include <gnuradio/gr_complex.h>
+#include <string>
+#include <vector>
+
+namespace gr {
+namespace rake_receiver {
+
+//! sum over j < length of input[j] * conj(pattern[j])
+using correlate_fn = gr_complex (*)(const gr_complex* input,
+                                    const gr_complex* pattern,
+                                    int length);
+
+/*!
+ * \brief One implementation of the finger correlation
+ *
+ * All kernels compute the same sum; they differ only in summation order and
+ * therefore in rounding.
+ */
+struct rake_kernel {
+    const char* name;
+    correlate_fn correlate;
+};
+
+//! Available kernels, the scalar reference first
+const std::vector<rake_kernel>& rake_kernels();
+
+//! Kernel called \p name, or nullptr
+const rake_kernel* find_rake_kernel(const std::string& name);
+
+/*!
+ * \brief Combine the fingers for \p count outputs
+ *
+ * out[i] = sum over f of gains[f] * correlate(windows + i + delays[f]).
+ * \p windows must hold count + max(delays) + pattern_length - 1 samples.
+ */
+void rake_combine(const rake_kernel& kernel,
+                  const gr_complex* windows,
+                  const int* delays,
+                  const float* gains,
+                  int num_fingers,
+                  const gr_complex* pattern,
+                  int pattern_length,
+                  gr_complex* out,
+                  int count);
+
+//! out[i] = correlate(input + i) for \p count outputs
+void rake_correlate(const rake_kernel& kernel,
+                    const gr_complex* input,
+                    const gr_complex* pattern,
+                    int pattern_length,
+                    gr_complex* out,
+                    int count);
+
+} // namespace rake_receiver
+} // namespace gr
+
+#endif /* INCLUDED_RAKE_RECEIVER_RAKE_KERNELS_H */
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef INCLUDED_RAKE_RECEIVER_RAKE_PROBES_H
+#define INCLUDED_RAKE_RECEIVER_RAKE_PROBES_H
+
+/*
+ * USDT (SystemTap/DTrace style) static probes under the "rake_receiver"
+ * provider. Each probe is a single nop plus an ELF note until a tracer
+ * attaches, e.g.
+ *
+ *   bpftrace -e 'usdt:/usr/lib/libgnuradio-rake_receiver.so:rake_receiver:work__entry
+ *                { @items = hist(arg0); }'
+ *
+ * They compile to nothing unless the build found <sys/sdt.h> and defined
+ * RAKE_RECEIVER_HAVE_SDT. Probe arguments must be integers or pointers.
+ */
+
+#ifdef RAKE_RECEIVER_HAVE_SDT
+#include <sys/sdt.h>
+#define RAKE_PROBE0(name) DTRACE_PROBE(rake_receiver, name)
+#define RAKE_PROBE1(name, a) DTRACE_PROBE1(rake_receiver, name, a)
+#define RAKE_PROBE2(name, a, b) DTRACE_PROBE2(rake_receiver, name, a, b)
+#define RAKE_PROBE3(name, a, b, c) DTRACE_PROBE3(rake_receiver, name, a, b, c)
+#else
+#define RAKE_PROBE0(name) \
+    do {                  \
+    } while (0)
+#define RAKE_PROBE1(name, a) \
+    do {                     \
+    } while (0)
+#define RAKE_PROBE2(name, a, b) \
+    do {                        \
+    } while (0)
+#define RAKE_PROBE3(name, a, b, c) \
+    do {                           \
+    } while (0)
+#endif
+
+#endif /* INCLUDED_RAKE_RECEIVER_RAKE_PROBES_H */
@@ -15,10 +15,131 @@
 #include <gnuradio/gr_complex.h>
 #include <pmt/pmt.h>
 #include "rake_receiver_cc_impl.h"
+#include "rake_probes.h"
+#include "speed_message.h"
+#ifdef GR_CTRLPORT
+#include <gnuradio/rpcregisterhelpers.h>
+#endif
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <limits>
 
 namespace gr {
 namespace rake_receiver {
 
+namespace {
+
+// Time base for the speed filter and the adaptation schedule
+double monotonic_seconds()
+{
+    return std::chrono::duration<double>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+const pmt::pmt_t rx_time_key()
+{
+    static const pmt::pmt_t k = pmt::mp("rx_time");
+    return k;
+}
+
+const pmt::pmt_t gps_speed_key()
+{
+    static const pmt::pmt_t k = pmt::mp("gps_speed");
+    return k;
+}
+
+const pmt::pmt_t rx_adapt_key()
+{
+    static const pmt::pmt_t k = pmt::mp("rx_adapt");
+    return k;
+}
+
+const pmt::pmt_t speed_kmh_key()
+{
+    static const pmt::pmt_t k = pmt::mp("speed_kmh");
+    return k;
+}
+
+const pmt::pmt_t stats_port()
+{
+    static const pmt::pmt_t k = pmt::mp("stats");
+    return k;
+}
+
+const pmt::pmt_t latency_probe_key()
+{
+    static const pmt::pmt_t k = pmt::mp("latency_probe");
+    return k;
+}
+
+const pmt::pmt_t rake_delays_key()
+{
+    static const pmt::pmt_t k = pmt::mp("rake_delays");
+    return k;
+}
+
+const pmt::pmt_t rake_gains_key()
+{
+    static const pmt::pmt_t k = pmt::mp("rake_gains");
+    return k;
+}
+
+const pmt::pmt_t rake_pattern_key()
+{
+    static const pmt::pmt_t k = pmt::mp("rake_pattern");
+    return k;
+}
+
+bool is_finger_key(const pmt::pmt_t& key)
+{
+    return pmt::eq(key, rake_delays_key()) || pmt::eq(key, rake_gains_key()) ||
+           pmt::eq(key, rake_pattern_key());
+}
+
+// Integer or real PMT vector (or list) as numbers; false for anything else
+template <typename T>
+bool pmt_numbers(const pmt::pmt_t& value, std::vector<T>& numbers)
+{
+    numbers.clear();
+    size_t n = 0;
+    if (pmt::is_s32vector(value)) {
+        const int32_t* data = pmt::s32vector_elements(value, n);
+        numbers.assign(data, data + n);
+        return true;
+    }
+    if (pmt::is_f32vector(value)) {
+        const float* data = pmt::f32vector_elements(value, n);
+        numbers.assign(data, data + n);
+        return true;
+    }
+    if (pmt::is_vector(value)) {
+        for (size_t i = 0; i < pmt::length(value); i++) {
+            pmt::pmt_t element = pmt::vector_ref(value, i);
+            if (!pmt::is_number(element) || pmt::is_complex(element)) {
+                return false;
+            }
+            numbers.push_back(static_cast<T>(pmt::to_double(element)));
+        }
+        return true;
+    }
+    return false;
+}
+
+// Numeric speed_kmh member of a PMT dict
+bool dict_speed(const pmt::pmt_t& dict, float& speed_kmh)
+{
+    // GNU Radio dicts are lists of pairs; anything else is not a dict here
+    if (!pmt::is_dict(dict) || (pmt::is_pair(dict) && !pmt::is_pair(pmt::car(dict)))) {
+        return false;
+    }
+    return pmt_speed(pmt::dict_ref(dict, speed_kmh_key(), pmt::PMT_NIL), speed_kmh);
+}
+
+} // namespace
+
 rake_receiver_cc::sptr rake_receiver_cc::make(int num_fingers,
                                               const std::vector<int>& delays,
                                               const std::vector<float>& gains,
@@ -39,6 +160,9 @@ rake_receiver_cc_impl::rake_receiver_cc_impl(int num_fingers,
       d_pattern_length(pattern_length),
       d_delays(d_num_fingers),
       d_gains(d_num_fingers),
+      d_kernel(find_rake_kernel("volk")),
+      d_kernel_autotune(false),
+      d_kernel_profile(default_kernel_profile()),
       d_gps_speed_kmh(-1.0f),
       d_path_search_rate_hz(20.0f),
       d_tracking_bandwidth_hz(120.0f),
@@ -46,13 +170,51 @@ rake_receiver_cc_impl::rake_receiver_cc_impl(int num_fingers,
       d_lock_threshold(0.7f),
       d_reassignment_period_s(1.0f),
       d_adaptive_mode(false),
-      d_sample_rate(1.0f),
+      d_sample_rate(0.0f),
+      d_running(false),
+      d_params_pending(false),
+      d_pending_params{ 0.0f, 0.0f, 0.0f, 0 },
+      d_pending_speed_kmh(-1.0f),
+      d_have_rx_time(false),
+      d_rx_time_offset(0),
+      d_rx_time_seconds(0.0),
+      d_work_offset(0),
+      d_delay_storage(delay_storage::history),
+      d_max_delay(0),
+      d_recorrelate(false),
+      d_delay_cache_enabled(false),
+      d_have_tile(false),
+      d_current_tile(0),
+      d_seed_pending(false),
+      d_doppler_enabled(false),
+      d_carrier_freq_hz(0.0),
+      d_doppler_decimation(100),
+      d_doppler_interval_s(1.0f),
+      d_doppler_phase(0),
+      d_doppler_delay(-1),
+      d_doppler_samples(0),
+      d_doppler_spread_hz(-1.0f),
+      d_doppler_speed_kmh(-1.0f),
+      d_energy_phase(0),
+      d_stats_interval_s(0.0f),
+      d_stats_last_s(0.0),
+      d_stats_items(0),
+      d_stats_work_ns(0),
+      d_latency_enabled(false),
+      d_latency_interval(0),
+      d_latency_next(0),
+      d_state_current(false),
+      d_speed_filter(false),
+      d_adaptation_interval_s(1.0f),
+      d_last_adaptation_s(-std::numeric_limits<double>::infinity()),
       d_gps_source("none"),
       d_serial_device("/dev/ttyUSB0"),
       d_serial_baud_rate(4800),
       d_gpsd_host("localhost"),
       d_gpsd_port(2947),
-      d_gps_running(false)
+      d_gps_running(false),
+      d_gps_min_mode(2),
+      d_gps_max_speed_error_kmh(0.0f)
 {
     if (d_num_fingers < 1 || d_num_fingers > 5) {
         throw std::invalid_argument("Number of fingers must be between 1 and 5");
@@ -75,7 +237,7 @@ rake_receiver_cc_impl::rake_receiver_cc_impl(int num_fingers,
         }
     }
 
-    set_history(max_delay + d_pattern_length + 1);
+    resize_history(max_delay + d_pattern_length + 1);
     set_output_multiple(1);
 
     d_pattern.resize(d_pattern_length, gr_complex(1.0f, 0.0f));
@@ -89,16 +251,40 @@ rake_receiver_cc_impl::rake_receiver_cc_impl(int num_fingers,
     message_port_register_in(pmt::mp("gps"));
     set_msg_handler(pmt::mp("gps"),
                     [this](pmt::pmt_t msg) { this->handle_gps_message(msg); });
+    message_port_register_out(stats_port());
+    reset_stats_interval();
 }
 
 rake_receiver_cc_impl::~rake_receiver_cc_impl() {}
 
+void rake_receiver_cc_impl::resize_history(int samples)
+{
+    RAKE_PROBE2(set__history, history(), samples);
+    set_history(samples);
+}
+
 void rake_receiver_cc_impl::set_delays(const std::vector<int>& delays)
 {
+    RAKE_PROBE2(set__delays, delays.size(), static_cast<int>(d_delay_storage));
     if (delays.size() != static_cast<size_t>(d_num_fingers)) {
         throw std::invalid_argument("Number of delays must match number of fingers");
     }
 
+    if (d_delay_storage != delay_storage::history) {
+        // The delay line is sized once; delays move freely inside it
+        gr::thread::scoped_lock guard(d_setlock);
+        std::vector<int> new_delays = d_seed_pending ? d_seed_delays : d_delays;
+        for (int i = 0; i < d_num_fingers; i++) {
+            if (delays[i] < 0 || delays[i] > d_max_delay) {
+                throw std::invalid_argument(
+                    "Delays must be between 0 and the delay line's maximum delay");
+            }
+            new_delays[i] = delays[i];
+        }
+        apply_fingers(new_delays, d_seed_pending ? d_seed_gains : d_gains, true);
+        return;
+    }
+
     int max_delay = 0;
     for (int i = 0; i < d_num_fingers; i++) {
         d_delays[i] = delays[i];
@@ -107,7 +293,7 @@ void rake_receiver_cc_impl::set_delays(const std::vector<int>& delays)
         }
     }
 
-    set_history(max_delay + d_pattern_length + 1);
+    resize_history(max_delay + d_pattern_length + 1);
 }
 
 void rake_receiver_cc_impl::set_gains(const std::vector<float>& gains)
@@ -121,6 +307,10 @@ void rake_receiver_cc_impl::set_gains(const std::vector<float>& gains)
     }
 }
 
+std::vector<int> rake_receiver_cc_impl::delays() const { return d_delays; }
+
+std::vector<float> rake_receiver_cc_impl::gains() const { return d_gains; }
+
 int rake_receiver_cc_impl::num_fingers() const { return d_num_fingers; }
 
 void rake_receiver_cc_impl::set_pattern(const std::vector<gr_complex>& pattern)
@@ -128,259 +318,1767 @@ void rake_receiver_cc_impl::set_pattern(const std::vector<gr_complex>& pattern)
     if (pattern.size() != static_cast<size_t>(d_pattern_length)) {
         throw std::invalid_argument("Pattern length must match pattern_length parameter");
     }
+    gr::thread::scoped_lock guard(d_setlock);
     d_pattern = pattern;
+    // The next work() call redoes the correlations still waiting in the
+    // sparse delay line
+    d_recorrelate = true;
 }
 
-int rake_receiver_cc_impl::work(int noutput_items,
-                                 gr_vector_const_void_star& input_items,
-                                 gr_vector_void_star& output_items)
+bool rake_receiver_cc_impl::start()
 {
-    const gr_complex* in = (const gr_complex*)input_items[0];
-    gr_complex* out = (gr_complex*)output_items[0];
-
-    for (int i = 0; i < noutput_items; i++) {
-        gr_complex combined = gr_complex(0.0f, 0.0f);
+    gr::thread::scoped_lock guard(d_setlock);
+    // Another process may have left a newer state behind
+    if (!d_state_file.empty() && !d_state_current &&
+        std::filesystem::exists(d_state_file)) {
+        try {
+            // Buffers are allocated by now, so the history is fixed
+            restore_state(load_receiver_state(d_state_file), true);
+        } catch (const std::exception& e) {
+            d_logger->warn(
+                "Cannot restore receiver state from {}: {}", d_state_file, e.what());
+        }
+    }
+    d_state_current = false;
+    if (d_kernel_autotune) {
+        autotune_kernel();
+    }
+    // Like a fresh history, the delay line starts out zeroed
+    if (!d_ring.empty()) {
+        d_ring.clear();
+    }
+    if (!d_correlations.empty()) {
+        d_correlations.clear();
+    }
+    d_running = true;
+    return sync_block::start();
+}
 
-        for (int finger = 0; finger < d_num_fingers; finger++) {
-            int delay = d_delays[finger];
-            gr_complex finger_output = gr_complex(0.0f, 0.0f);
+bool rake_receiver_cc_impl::stop()
+{
+    receiver_state state;
+    std::string state_file;
+    {
+        gr::thread::scoped_lock guard(d_setlock);
+        d_running = false;
+        // Nothing is left to tag, so a queued change takes effect right away
+        if (d_params_pending) {
+            d_path_search_rate_hz = d_pending_params.path_search_rate;
+            d_tracking_bandwidth_hz = d_pending_params.tracking_bandwidth;
+            d_reassignment_period_s = d_pending_params.reassignment_period;
+            d_num_fingers = d_pending_params.num_fingers;
+            d_params_pending = false;
+        }
+        if (d_seed_pending) {
+            d_delays = d_seed_delays;
+            d_gains = d_seed_gains;
+            d_seed_pending = false;
+            rake_counters::add(d_counters.reconfigurations, 1);
+        }
+        state_file = d_state_file;
+        if (!state_file.empty()) {
+            state = capture_state();
+        }
+    }
 
-            if (static_cast<unsigned int>(i + delay + d_pattern_length) <= history() - 1) {
-                const gr_complex* delayed_input = &in[i + delay];
+    if (!state_file.empty()) {
+        try {
+            save_receiver_state(state_file, state);
+            d_state_current = true;
+        } catch (const std::exception& e) {
+            d_logger->warn("Cannot save receiver state to {}: {}", state_file, e.what());
+        }
+    }
+    return sync_block::stop();
+}
 
-                for (int j = 0; j < d_pattern_length; j++) {
-                    finger_output += delayed_input[j] * std::conj(d_pattern[j]);
-                }
-            }
+receiver_state rake_receiver_cc_impl::capture_state() const
+{
+    // Caller holds d_setlock
+    receiver_state state;
+    state.delays = d_delays;
+    state.gains = d_gains;
+    state.active_fingers = d_num_fingers;
+    state.pattern_length = d_pattern_length;
+    state.gps_speed_kmh = d_gps_speed_kmh;
+    state.path_search_rate_hz = d_path_search_rate_hz;
+    state.tracking_bandwidth_hz = d_tracking_bandwidth_hz;
+    state.path_detection_threshold = d_path_detection_threshold;
+    state.lock_threshold = d_lock_threshold;
+    state.reassignment_period_s = d_reassignment_period_s;
+    state.speed_filter_initialized = d_speed_kalman.initialized();
+    state.speed_filter = d_speed_kalman.snapshot();
+    state.doppler_spread_hz = d_doppler_spread_hz;
+    state.doppler_speed_kmh = d_doppler_speed_kmh;
+    return state;
+}
 
-            combined += d_gains[finger] * finger_output;
-        }
+void rake_receiver_cc_impl::restore_state(const receiver_state& state, bool history_fixed)
+{
+    // Caller holds d_setlock
+    if (state.delays.size() != d_delays.size() ||
+        state.pattern_length != d_pattern_length) {
+        throw std::invalid_argument(
+            "Receiver state was saved with a different finger configuration");
+    }
+    if (*std::min_element(state.delays.begin(), state.delays.end()) < 0) {
+        throw std::invalid_argument("Receiver state has negative delays");
+    }
 
-        out[i] = combined;
+    d_seed_pending = false;
+    apply_fingers(state.delays, state.gains, history_fixed);
+
+    d_num_fingers =
+        std::min(std::max(state.active_fingers, 1), static_cast<int>(d_delays.size()));
+    d_gps_speed_kmh = state.gps_speed_kmh;
+    d_path_search_rate_hz = state.path_search_rate_hz;
+    d_tracking_bandwidth_hz = state.tracking_bandwidth_hz;
+    d_path_detection_threshold = state.path_detection_threshold;
+    d_lock_threshold = state.lock_threshold;
+    d_reassignment_period_s = state.reassignment_period_s;
+    d_params_pending = false;
+
+    // The filter resumes on the current time base
+    if (state.speed_filter_initialized) {
+        d_speed_kalman.restore(state.speed_filter, current_seconds());
+    } else {
+        d_speed_kalman.reset();
     }
+    d_last_adaptation_s = -std::numeric_limits<double>::infinity();
 
-    return noutput_items;
+    d_doppler_spread_hz = state.doppler_spread_hz;
+    d_doppler_speed_kmh = state.doppler_speed_kmh;
 }
 
-void rake_receiver_cc_impl::set_gps_speed(float speed_kmh)
+void rake_receiver_cc_impl::set_state_file(const std::string& path)
 {
-    d_gps_speed_kmh = speed_kmh;
-    if (d_adaptive_mode && speed_kmh >= 0.0f) {
-        update_adaptive_parameters();
+    {
+        gr::thread::scoped_lock guard(d_setlock);
+        d_state_file = path;
+        d_state_current = false;
+    }
+    if (path.empty() || !std::filesystem::exists(path)) {
+        return;
+    }
+    try {
+        load_state(path);
+        d_state_current = true;
+    } catch (const std::exception& e) {
+        d_logger->warn("Cannot restore receiver state from {}: {}", path, e.what());
     }
 }
 
-float rake_receiver_cc_impl::gps_speed() const { return d_gps_speed_kmh; }
+std::string rake_receiver_cc_impl::state_file() const { return d_state_file; }
 
-void rake_receiver_cc_impl::set_path_search_rate(float rate_hz)
+void rake_receiver_cc_impl::save_state(const std::string& path)
 {
-    d_path_search_rate_hz = rate_hz;
+    receiver_state state;
+    {
+        gr::thread::scoped_lock guard(d_setlock);
+        state = capture_state();
+    }
+    save_receiver_state(path, state);
 }
 
-float rake_receiver_cc_impl::path_search_rate() const { return d_path_search_rate_hz; }
-
-void rake_receiver_cc_impl::set_tracking_bandwidth(float bandwidth_hz)
+void rake_receiver_cc_impl::load_state(const std::string& path)
 {
-    d_tracking_bandwidth_hz = bandwidth_hz;
-}
+    receiver_state state = load_receiver_state(path);
 
-float rake_receiver_cc_impl::tracking_bandwidth() const { return d_tracking_bandwidth_hz; }
+    gr::thread::scoped_lock guard(d_setlock);
+    restore_state(state, d_running);
+}
 
-void rake_receiver_cc_impl::set_path_detection_threshold(float threshold)
+void rake_receiver_cc_impl::combine_fingers(const gr_complex* windows,
+                                            gr_complex* out,
+                                            int count) const
 {
-    d_path_detection_threshold = threshold;
+    // Output i reads windows[i + delay + j]; the caller guarantees that the
+    // largest delay plus the pattern is inside the buffer
+    rake_combine(*d_kernel,
+                 windows,
+                 d_delays.data(),
+                 d_gains.data(),
+                 d_num_fingers,
+                 d_pattern.data(),
+                 d_pattern_length,
+                 out,
+                 count);
 }
 
-float rake_receiver_cc_impl::path_detection_threshold() const
+int rake_receiver_cc_impl::work(int noutput_items,
+                                 gr_vector_const_void_star& input_items,
+                                 gr_vector_void_star& output_items)
 {
-    return d_path_detection_threshold;
+    RAKE_PROBE2(work__entry, noutput_items, nitems_read(0));
+    scoped_timer timer(d_counters.work_time_ns);
+    rake_counters::add(d_counters.work_calls, 1);
+    rake_counters::add(d_counters.items, noutput_items);
+
+    const gr_complex* in = (const gr_complex*)input_items[0];
+    gr_complex* out = (gr_complex*)output_items[0];
+    const uint64_t first = nitems_read(0);
+
+    // Split the buffer at time, speed and finger tags so that tagged values
+    // take effect exactly at the tagged sample
+    get_tags_in_window(d_tags, 0, 0, noutput_items);
+
+    {
+        gr::thread::scoped_lock guard(d_setlock);
+        d_work_offset = nitems_written(0);
+        // Between fixes, the filtered speed keeps adapting on its schedule
+        if (d_speed_filter && d_adaptive_mode) {
+            run_adaptation_schedule(current_seconds());
+        }
+        // Changes queued since the last call take effect on its first output
+        if (d_seed_pending) {
+            d_delays = d_seed_delays;
+            d_gains = d_seed_gains;
+            d_seed_pending = false;
+        }
+        if (d_recorrelate) {
+            recorrelate();
+        }
+        commit_pending_params(d_work_offset);
+
+        // Replayed fixes due in this buffer are handled like gps_speed tags
+        if (d_gps_replay.loaded() && d_sample_rate > 0.0f) {
+            while (d_gps_replay.due_before(first + noutput_items, d_sample_rate)) {
+                size_t fix = d_gps_replay.next();
+                tag_t tag;
+                tag.offset = std::max(d_gps_replay.offset(fix, d_sample_rate), first);
+                tag.key = gps_speed_key();
+                tag.value = pmt::from_double(d_gps_replay.speed(fix));
+                tag.srcid = pmt::PMT_F;
+                d_tags.push_back(tag);
+                d_gps_replay.advance();
+            }
+        }
+    }
+    std::stable_sort(d_tags.begin(), d_tags.end(), [](const tag_t& a, const tag_t& b) {
+        return a.offset < b.offset;
+    });
+    if (d_latency_enabled) {
+        gr::thread::scoped_lock guard(d_setlock);
+        stamp_latency_probes(first, noutput_items);
+    }
+
+    int done = 0;
+    for (const tag_t& tag : d_tags) {
+        if (!pmt::eq(tag.key, rx_time_key()) && !pmt::eq(tag.key, gps_speed_key()) &&
+            !is_finger_key(tag.key)) {
+            continue;
+        }
+        int boundary = static_cast<int>(tag.offset - first);
+        process_span(in, out, done, boundary);
+        done = boundary;
+
+        gr::thread::scoped_lock guard(d_setlock);
+        if (is_finger_key(tag.key)) {
+            handle_finger_tag(tag);
+            continue;
+        }
+        handle_stream_tag(tag);
+        commit_pending_params(d_work_offset + boundary);
+    }
+    process_span(in, out, done, noutput_items);
+
+    if (d_doppler_enabled) {
+        publish_doppler(noutput_items);
+    }
+    if (d_latency_enabled) {
+        gr::thread::scoped_lock guard(d_setlock);
+        match_latency_probes(first + noutput_items);
+    }
+    if (d_stats_interval_s > 0.0f) {
+        publish_stats(noutput_items);
+    }
+
+    RAKE_PROBE1(work__return, noutput_items);
+    return noutput_items;
 }
 
-void rake_receiver_cc_impl::set_lock_threshold(float threshold)
+void rake_receiver_cc_impl::process_span(const gr_complex* in,
+                                         gr_complex* out,
+                                         int begin,
+                                         int end)
 {
-    d_lock_threshold = threshold;
+    if (d_delay_storage == delay_storage::history) {
+        // history() covers the largest delay plus the pattern
+        combine_fingers(in + begin, out + begin, end - begin);
+        sample_finger_energy(in + begin, nullptr, end - begin);
+        sample_doppler(in + begin, end - begin, false);
+        return;
+    }
+    if (d_delay_storage == delay_storage::sparse) {
+        process_sparse(in + begin, out + begin, end - begin);
+        return;
+    }
+
+    // Ring mode: every output reads the max_delay + pattern_length samples
+    // before it, which the ring keeps contiguous
+    const int span = d_max_delay + d_pattern_length;
+    const int chunk = static_cast<int>(d_ring.capacity()) - span;
+    for (int i = begin; i < end;) {
+        int count = std::min(chunk, end - i);
+        d_ring.push(in + i, count);
+        const gr_complex* windows = d_ring.last(count + span);
+        combine_fingers(windows, out + i, count);
+        sample_finger_energy(windows, nullptr, count);
+        sample_doppler(windows, count, false);
+        i += count;
+    }
 }
 
-float rake_receiver_cc_impl::lock_threshold() const { return d_lock_threshold; }
+void rake_receiver_cc_impl::process_sparse(const gr_complex* in, gr_complex* out, int count)
+{
+    // Finger f's output for sample n is the pattern correlation starting at
+    // n - max_delay - pattern_length + delay_f, so the correlation is
+    // computed once per sample and only its results are delayed. The
+    // correlation at correlations[k] starts at windows[k], as in ring mode
+    const int lookback = d_max_delay + 1;
+    const int span = d_max_delay + d_pattern_length;
+    const int chunk = std::min(static_cast<int>(d_correlations.capacity()) - lookback,
+                               static_cast<int>(d_ring.capacity()) - span);
+    std::vector<gr_complex>& fresh = d_sparse_scratch;
+
+    for (int i = 0; i < count;) {
+        int n = std::min(chunk, count - i);
+
+        // Correlations whose last input sample just arrived
+        d_ring.push(in + i, n);
+        const gr_complex* windows = d_ring.last(n + span);
+        fresh.resize(n);
+        rake_correlate(*d_kernel,
+                       windows + lookback,
+                       d_pattern.data(),
+                       d_pattern_length,
+                       fresh.data(),
+                       n);
+        d_correlations.push(fresh.data(), n);
+
+        const gr_complex* correlations = d_correlations.last(n + lookback);
+        combine_correlations(correlations, out + i, n);
+        sample_finger_energy(windows, correlations, n);
+        sample_doppler(correlations, n, true);
+        i += n;
+    }
+}
 
-void rake_receiver_cc_impl::set_reassignment_period(float period_s)
+void rake_receiver_cc_impl::recorrelate()
 {
-    d_reassignment_period_s = period_s;
+    // Caller holds d_setlock. Outputs still to come read the last
+    // max_delay + 1 correlations; pushing them again with the new pattern
+    // makes it take effect on the next output, as in the other modes
+    d_recorrelate = false;
+    if (d_delay_storage != delay_storage::sparse) {
+        return;
+    }
+    const int lookback = d_max_delay + 1;
+    std::vector<gr_complex>& fresh = d_sparse_scratch;
+    fresh.resize(lookback);
+    rake_correlate(*d_kernel,
+                   d_ring.last(lookback + d_pattern_length - 1),
+                   d_pattern.data(),
+                   d_pattern_length,
+                   fresh.data(),
+                   lookback);
+    d_correlations.push(fresh.data(), lookback);
 }
 
-float rake_receiver_cc_impl::reassignment_period() const { return d_reassignment_period_s; }
+void rake_receiver_cc_impl::combine_correlations(const gr_complex* correlations,
+                                                 gr_complex* out,
+                                                 int count) const
+{
+    // One read per finger instead of a pattern_length correlation
+    for (int i = 0; i < count; i++) {
+        gr_complex combined = gr_complex(0.0f, 0.0f);
+        for (int finger = 0; finger < d_num_fingers; finger++) {
+            combined += d_gains[finger] * correlations[i + d_delays[finger]];
+        }
+        out[i] = combined;
+    }
+}
 
-void rake_receiver_cc_impl::set_adaptive_mode(bool enable)
+void rake_receiver_cc_impl::sample_finger_energy(const gr_complex* windows,
+                                                 const gr_complex* correlations,
+                                                 int count)
 {
-    d_adaptive_mode = enable;
-    if (enable && d_gps_speed_kmh >= 0.0f) {
-        update_adaptive_parameters();
+    // One correlation per finger every 64 outputs, about 1.5% of the
+    // combiner's work; twice that with stats on. Sparse mode passes the
+    // finished correlations along with the windows
+    const int decimation = 64;
+    const bool stats = d_stats_interval_s > 0.0f;
+    float pattern_energy = 0.0f;
+    if (stats) {
+        for (const gr_complex& p : d_pattern) {
+            pattern_energy += std::norm(p);
+        }
+    }
+    int i = d_energy_phase;
+    uint64_t samples = 0;
+    for (; i < count; i += decimation, samples++) {
+        for (int finger = 0; finger < d_num_fingers; finger++) {
+            const gr_complex* delayed_input = &windows[i + d_delays[finger]];
+            gr_complex c = correlations ? correlations[i + d_delays[finger]]
+                                        : d_kernel->correlate(delayed_input,
+                                                              d_pattern.data(),
+                                                              d_pattern_length);
+            rake_counters::accumulate(d_counters.finger_energy[finger], std::norm(c));
+            if (!stats) {
+                continue;
+            }
+            // Normalised correlation: 1 for a noiseless copy of the pattern
+            float window_energy = 0.0f;
+            for (int j = 0; j < d_pattern_length; j++) {
+                window_energy += std::norm(delayed_input[j]);
+            }
+            float denominator = window_energy * pattern_energy;
+            if (denominator > 0.0f) {
+                d_stats_rho2[finger] += std::norm(c) / denominator;
+                d_stats_rho_count[finger]++;
+            }
+        }
     }
+    d_energy_phase = i - count;
+    rake_counters::add(d_counters.energy_samples, samples);
 }
 
-bool rake_receiver_cc_impl::adaptive_mode() const { return d_adaptive_mode; }
+void rake_receiver_cc_impl::sample_doppler(const gr_complex* windows,
+                                           int count,
+                                           bool correlated)
+{
+    if (!d_doppler_enabled) {
+        return;
+    }
+    scoped_timer timer(d_counters.estimator_time_ns);
+    // Setters reset the estimator under the lock
+    gr::thread::scoped_lock guard(d_setlock);
+    if (!(d_sample_rate > 0.0f) || !(d_carrier_freq_hz > 0.0)) {
+        return;
+    }
 
-void rake_receiver_cc_impl::update_adaptive_parameters()
+    // The strongest finger gives the cleanest channel estimate; start over
+    // whenever it moves so samples of different paths are never correlated
+    int strongest = 0;
+    for (int finger = 1; finger < d_num_fingers; finger++) {
+        if (std::fabs(d_gains[finger]) > std::fabs(d_gains[strongest])) {
+            strongest = finger;
+        }
+    }
+    if (d_delays[strongest] != d_doppler_delay) {
+        d_doppler_delay = d_delays[strongest];
+        d_doppler.reset();
+    }
+
+    // One pattern correlation per decimation period: a 1 / (fingers *
+    // decimation) fraction of the combiner's work
+    int i = d_doppler_phase;
+    for (; i < count; i += d_doppler_decimation) {
+        if (correlated) {
+            // Sparse mode hands over finished correlator outputs
+            d_doppler.update(windows[i + d_doppler_delay]);
+            continue;
+        }
+        const gr_complex* delayed_input = &windows[i + d_doppler_delay];
+        d_doppler.update(
+            d_kernel->correlate(delayed_input, d_pattern.data(), d_pattern_length));
+    }
+    d_doppler_phase = i - count;
+}
+
+void rake_receiver_cc_impl::publish_doppler(int noutput_items)
 {
-    if (!d_adaptive_mode || d_gps_speed_kmh < 0.0f) {
+    scoped_timer timer(d_counters.estimator_time_ns);
+    gr::thread::scoped_lock guard(d_setlock);
+    if (!(d_sample_rate > 0.0f) || !(d_carrier_freq_hz > 0.0)) {
         return;
     }
-    apply_speed_category(d_gps_speed_kmh);
+    d_doppler_samples += noutput_items;
+    if (d_doppler_samples < d_doppler_interval_s * d_sample_rate) {
+        return;
+    }
+    d_doppler_samples = 0;
+    double spread_hz = d_doppler.estimate(d_doppler_decimation / d_sample_rate);
+    if (spread_hz < 0.0) {
+        return;
+    }
+
+    // f_D = v f_c / c
+    const double speed_of_light = 299792458.0;
+    d_doppler_spread_hz = static_cast<float>(spread_hz);
+    d_doppler_speed_kmh =
+        static_cast<float>(spread_hz * speed_of_light / d_carrier_freq_hz * 3.6);
+    // A real GPS fix takes precedence
+    if (d_adaptive_mode && d_gps_speed_kmh < 0.0f) {
+        apply_speed_category(d_doppler_speed_kmh);
+    }
 }
 
-void rake_receiver_cc_impl::apply_speed_category(float speed_kmh)
+void rake_receiver_cc_impl::handle_stream_tag(const tag_t& tag)
 {
-    if (speed_kmh < 0.0f) {
+    // Caller holds d_setlock
+    if (pmt::eq(tag.key, rx_time_key())) {
+        // rx_time is (uint64 full seconds, double fractional seconds)
+        if (pmt::is_tuple(tag.value)) {
+            d_rx_time_seconds =
+                static_cast<double>(pmt::to_uint64(pmt::tuple_ref(tag.value, 0))) +
+                pmt::to_double(pmt::tuple_ref(tag.value, 1));
+            d_rx_time_offset = tag.offset;
+            d_have_rx_time = true;
+        }
         return;
     }
 
-    // Speed category boundaries
-    const float speed_stationary = 5.0f;
-    const float speed_pedestrian = 15.0f;
-    const float speed_low = 60.0f;
-    const float speed_high = 120.0f;
+    float speed_kmh;
+    if (!pmt_speed(tag.value, speed_kmh)) {
+        // A negative speed reports a lost fix; anything else is ignored
+        if ((pmt::is_real(tag.value) || pmt::is_integer(tag.value)) &&
+            pmt::to_double(tag.value) < 0.0) {
+            d_gps_speed_kmh = -1.0f;
+        }
+        return;
+    }
+    d_gps_speed_kmh = speed_kmh;
+    if (d_speed_filter) {
+        double now = d_sample_rate > 0.0f ? stream_seconds(tag.offset) : monotonic_seconds();
+        d_speed_kalman.update(now, speed_kmh);
+        run_adaptation_schedule(now);
+    } else if (d_adaptive_mode) {
+        apply_speed_category(speed_kmh);
+    }
+}
 
-    // Parameter values for each category
-    struct SpeedParams {
-        float path_search_rate;
-        float tracking_bandwidth;
-        float reassignment_period;
-        int num_fingers;
-    };
+void rake_receiver_cc_impl::handle_finger_tag(const tag_t& tag)
+{
+    // Caller holds d_setlock. A bad tag cannot be thrown back to anyone, so
+    // it is logged and dropped
+    if (pmt::eq(tag.key, rake_pattern_key())) {
+        size_t n = 0;
+        const gr_complex* pattern = pmt::is_c32vector(tag.value)
+                                        ? pmt::c32vector_elements(tag.value, n)
+                                        : nullptr;
+        if (!pattern || n != static_cast<size_t>(d_pattern_length)) {
+            d_logger->warn("Ignoring rake_pattern tag at {}: expected {} complex samples",
+                           tag.offset,
+                           d_pattern_length);
+            return;
+        }
+        d_pattern.assign(pattern, pattern + n);
+        recorrelate();
+        return;
+    }
 
-    SpeedParams stationary = {5.0f, 50.0f, 2.0f, 3};
-    SpeedParams pedestrian = {10.0f, 100.0f, 1.0f, 3};
-    SpeedParams low_speed = {20.0f, 120.0f, 1.0f, 4};
-    SpeedParams high_speed = {50.0f, 200.0f, 0.5f, 4};
-    SpeedParams very_high = {100.0f, 300.0f, 0.25f, 4};
-
-    SpeedParams lower, upper;
-    float lower_speed, upper_speed;
-    float alpha; // Interpolation factor (0.0 to 1.0)
-
-    // Determine which category range we're in and interpolate
-    if (speed_kmh <= speed_stationary) {
-        // Stationary (0-5 km/h) - no interpolation needed
-        d_path_search_rate_hz = stationary.path_search_rate;
-        d_tracking_bandwidth_hz = stationary.tracking_bandwidth;
-        d_reassignment_period_s = stationary.reassignment_period;
-        d_num_fingers = stationary.num_fingers;
-    } else if (speed_kmh <= speed_pedestrian) {
-        // Interpolate between Stationary and Pedestrian (5-15 km/h)
-        lower = stationary;
-        upper = pedestrian;
-        lower_speed = speed_stationary;
-        upper_speed = speed_pedestrian;
-        alpha = (speed_kmh - lower_speed) / (upper_speed - lower_speed);
-        d_path_search_rate_hz = lower.path_search_rate +
-                                alpha * (upper.path_search_rate - lower.path_search_rate);
-        d_tracking_bandwidth_hz = lower.tracking_bandwidth +
-                                  alpha * (upper.tracking_bandwidth - lower.tracking_bandwidth);
-        d_reassignment_period_s = lower.reassignment_period +
-                                  alpha * (upper.reassignment_period - lower.reassignment_period);
-        d_num_fingers = (speed_kmh < (lower_speed + upper_speed) / 2.0f) ? lower.num_fingers
-                                                                         : upper.num_fingers;
-    } else if (speed_kmh <= speed_low) {
-        // Interpolate between Pedestrian and Low-Speed (15-60 km/h)
-        lower = pedestrian;
-        upper = low_speed;
-        lower_speed = speed_pedestrian;
-        upper_speed = speed_low;
-        alpha = (speed_kmh - lower_speed) / (upper_speed - lower_speed);
-        d_path_search_rate_hz = lower.path_search_rate +
-                                alpha * (upper.path_search_rate - lower.path_search_rate);
-        d_tracking_bandwidth_hz = lower.tracking_bandwidth +
-                                  alpha * (upper.tracking_bandwidth - lower.tracking_bandwidth);
-        d_reassignment_period_s = lower.reassignment_period +
-                                  alpha * (upper.reassignment_period - lower.reassignment_period);
-        d_num_fingers = (speed_kmh < (lower_speed + upper_speed) / 2.0f) ? lower.num_fingers
-                                                                         : upper.num_fingers;
-    } else if (speed_kmh <= speed_high) {
-        // Interpolate between Low-Speed and High-Speed (60-120 km/h)
-        lower = low_speed;
-        upper = high_speed;
-        lower_speed = speed_low;
-        upper_speed = speed_high;
-        alpha = (speed_kmh - lower_speed) / (upper_speed - lower_speed);
-        d_path_search_rate_hz = lower.path_search_rate +
-                                alpha * (upper.path_search_rate - lower.path_search_rate);
-        d_tracking_bandwidth_hz = lower.tracking_bandwidth +
-                                  alpha * (upper.tracking_bandwidth - lower.tracking_bandwidth);
-        d_reassignment_period_s = lower.reassignment_period +
-                                  alpha * (upper.reassignment_period - lower.reassignment_period);
-        d_num_fingers = upper.num_fingers; // Both use 4 fingers
+    // Queued setter changes are overridden by the tag
+    std::vector<int> delays = d_seed_pending ? d_seed_delays : d_delays;
+    std::vector<float> gains = d_seed_pending ? d_seed_gains : d_gains;
+    if (pmt::eq(tag.key, rake_gains_key())) {
+        if (!pmt_numbers(tag.value, gains) || gains.size() != d_delays.size()) {
+            d_logger->warn("Ignoring rake_gains tag at {}: expected {} gains",
+                           tag.offset,
+                           d_delays.size());
+            return;
+        }
     } else {
-        // Interpolate between High-Speed and Very High-Speed (120+ km/h)
-        lower = high_speed;
-        upper = very_high;
-        lower_speed = speed_high;
-        upper_speed = 200.0f; // Cap interpolation at 200 km/h for very high speeds
-        float clamped_speed = (speed_kmh > upper_speed) ? upper_speed : speed_kmh;
-        alpha = (clamped_speed - lower_speed) / (upper_speed - lower_speed);
-        if (alpha > 1.0f)
-            alpha = 1.0f;
-        d_path_search_rate_hz = lower.path_search_rate +
-                                alpha * (upper.path_search_rate - lower.path_search_rate);
-        d_tracking_bandwidth_hz = lower.tracking_bandwidth +
-                                  alpha * (upper.tracking_bandwidth - lower.tracking_bandwidth);
-        d_reassignment_period_s = lower.reassignment_period +
-                                  alpha * (upper.reassignment_period - lower.reassignment_period);
-        d_num_fingers = upper.num_fingers; // Both use 4 fingers
+        bool ok = pmt_numbers(tag.value, delays) && delays.size() == d_delays.size();
+        for (size_t i = 0; ok && i < delays.size(); i++) {
+            ok = delays[i] >= 0 && delays[i] <= delay_capacity();
+        }
+        if (!ok) {
+            d_logger->warn("Ignoring rake_delays tag at {}: expected {} delays of "
+                           "at most {} samples",
+                           tag.offset,
+                           d_delays.size(),
+                           delay_capacity());
+            return;
+        }
     }
+    d_delays = delays;
+    d_gains = gains;
+    d_seed_pending = false;
+    rake_counters::add(d_counters.reconfigurations, 1);
 }
 
-bool rake_receiver_cc_impl::parse_gps_data(const std::string& gps_data)
+void rake_receiver_cc_impl::commit_pending_params(uint64_t offset)
 {
-    float speed = parse_gps_speed(gps_data);
-    if (speed >= 0.0f) {
-        set_gps_speed(speed);
-        return true;
+    // Caller holds d_setlock
+    if (!d_params_pending) {
+        return;
     }
-    return false;
+    d_params_pending = false;
+    rake_counters::add(d_counters.reconfigurations, 1);
+    d_path_search_rate_hz = d_pending_params.path_search_rate;
+    d_tracking_bandwidth_hz = d_pending_params.tracking_bandwidth;
+    d_reassignment_period_s = d_pending_params.reassignment_period;
+    d_num_fingers = d_pending_params.num_fingers;
+
+    pmt::pmt_t value = pmt::make_dict();
+    value = pmt::dict_add(
+        value, pmt::mp("speed_kmh"), pmt::from_double(d_pending_speed_kmh));
+    value = pmt::dict_add(value, pmt::mp("num_fingers"), pmt::from_long(d_num_fingers));
+    value = pmt::dict_add(
+        value, pmt::mp("path_search_rate"), pmt::from_double(d_path_search_rate_hz));
+    value = pmt::dict_add(value,
+                          pmt::mp("tracking_bandwidth"),
+                          pmt::from_double(d_tracking_bandwidth_hz));
+    value = pmt::dict_add(value,
+                          pmt::mp("reassignment_period"),
+                          pmt::from_double(d_reassignment_period_s));
+    add_item_tag(0, offset, rx_adapt_key(), value, pmt::mp(alias()));
 }
 
-bool rake_receiver_cc_impl::parse_nmea0183(const std::string& nmea_message)
+double rake_receiver_cc_impl::stream_seconds(uint64_t offset) const
 {
-    float speed = parse_nmea0183_speed(nmea_message);
-    if (speed >= 0.0f) {
-        set_gps_speed(speed);
-        return true;
+    double since_anchor =
+        (static_cast<double>(offset) - static_cast<double>(d_rx_time_offset)) /
+        d_sample_rate;
+    return (d_have_rx_time ? d_rx_time_seconds : 0.0) + since_anchor;
+}
+
+double rake_receiver_cc_impl::current_seconds() const
+{
+    // With a known sample rate, follow the stream rather than the host clock
+    if (d_sample_rate > 0.0f) {
+        return stream_seconds(d_work_offset);
     }
-    return false;
+    return monotonic_seconds();
 }
 
-bool rake_receiver_cc_impl::parse_gpsd(const std::string& gpsd_json)
+void rake_receiver_cc_impl::set_sample_rate(float sample_rate)
 {
-    float speed = parse_gpsd_speed(gpsd_json);
-    if (speed >= 0.0f) {
-        set_gps_speed(speed);
-        return true;
+    if (!(sample_rate > 0.0f)) {
+        throw std::invalid_argument("Sample rate must be positive");
     }
-    return false;
+    gr::thread::scoped_lock guard(d_setlock);
+    d_sample_rate = sample_rate;
+    // Filter state was kept on the previous time base
+    d_speed_kalman.reset();
+    d_last_adaptation_s = -std::numeric_limits<double>::infinity();
 }
 
-void rake_receiver_cc_impl::handle_gps_message(pmt::pmt_t msg)
+float rake_receiver_cc_impl::sample_rate() const { return d_sample_rate; }
+
+size_t rake_receiver_cc_impl::load_gps_replay(const std::string& path, double start_time)
 {
-    // Extract string from PMT message
-    if (pmt::is_symbol(msg)) {
-        std::string gps_data = pmt::symbol_to_string(msg);
-        parse_gps_data(gps_data);
-    } else if (pmt::is_u8vector(msg)) {
-        // Handle byte vector (common for serial data)
-        std::vector<uint8_t> vec = pmt::u8vector_elements(msg);
-        std::string gps_data(vec.begin(), vec.end());
-        parse_gps_data(gps_data);
-    } else {
-        // Try to convert to string
-        try {
-            std::string gps_data = pmt::symbol_to_string(msg);
-            parse_gps_data(gps_data);
-        } catch (...) {
-            // If conversion fails, try as string representation
-            std::string gps_data = pmt::write_string(msg);
-            parse_gps_data(gps_data);
-        }
+    if (!(d_sample_rate > 0.0f)) {
+        throw std::invalid_argument("Set the sample rate before loading a GPS replay");
+    }
+    gps_replay replay;
+    size_t fixes = replay.load(path, start_time);
+
+    gr::thread::scoped_lock guard(d_setlock);
+    d_gps_replay = std::move(replay);
+    return fixes;
+}
+
+void rake_receiver_cc_impl::clear_gps_replay()
+{
+    gr::thread::scoped_lock guard(d_setlock);
+    d_gps_replay.clear();
+}
+
+size_t rake_receiver_cc_impl::gps_replay_remaining() const
+{
+    return d_gps_replay.remaining();
+}
+
+void rake_receiver_cc_impl::set_delay_cache(bool enable)
+{
+    gr::thread::scoped_lock guard(d_setlock);
+    d_delay_cache_enabled = enable;
+    d_have_tile = false;
+}
+
+bool rake_receiver_cc_impl::delay_cache() const { return d_delay_cache_enabled; }
+
+void rake_receiver_cc_impl::set_delay_cache_tile_size(float tile_size_m)
+{
+    gr::thread::scoped_lock guard(d_setlock);
+    d_delay_cache.set_tile_size(tile_size_m);
+    d_have_tile = false;
+}
+
+float rake_receiver_cc_impl::delay_cache_tile_size() const
+{
+    return static_cast<float>(d_delay_cache.tile_size());
+}
+
+void rake_receiver_cc_impl::set_delay_cache_capacity(int capacity)
+{
+    if (capacity < 1) {
+        throw std::invalid_argument("Delay cache capacity must be positive");
+    }
+    gr::thread::scoped_lock guard(d_setlock);
+    d_delay_cache.set_capacity(static_cast<size_t>(capacity));
+}
+
+size_t rake_receiver_cc_impl::delay_cache_size() const { return d_delay_cache.size(); }
+
+size_t rake_receiver_cc_impl::load_delay_cache(const std::string& path)
+{
+    delay_profile_cache cache(d_delay_cache.tile_size(), d_delay_cache.capacity());
+    size_t tiles = cache.load(path);
+
+    gr::thread::scoped_lock guard(d_setlock);
+    if (cache.tile_size() != d_delay_cache.tile_size()) {
+        // The keys only hold for the tile size they were made with
+        d_logger->info("Delay cache tile size changed from {} m to {} m by {}",
+                       d_delay_cache.tile_size(),
+                       cache.tile_size(),
+                       path);
+    }
+    d_delay_cache = std::move(cache);
+    // The file may use a different tile size; re-enter on the next position
+    d_have_tile = false;
+    return tiles;
+}
+
+void rake_receiver_cc_impl::save_delay_cache(const std::string& path)
+{
+    delay_profile_cache snapshot;
+    {
+        gr::thread::scoped_lock guard(d_setlock);
+        if (d_delay_cache_enabled && d_have_tile) {
+            d_delay_cache.store(d_current_tile, d_delays, d_gains);
+        }
+        snapshot = d_delay_cache;
+    }
+    snapshot.save(path);
+}
+
+void rake_receiver_cc_impl::set_position(double latitude_deg, double longitude_deg)
+{
+    gr::thread::scoped_lock guard(d_setlock);
+    if (!d_delay_cache_enabled) {
+        return;
+    }
+    uint64_t tile;
+    if (!d_delay_cache.tile(latitude_deg, longitude_deg, tile)) {
+        return;
+    }
+    if (d_have_tile && tile == d_current_tile) {
+        return;
+    }
+    if (d_have_tile) {
+        // Remember where the fingers ended up in the tile being left
+        d_delay_cache.store(d_current_tile,
+                            d_seed_pending ? d_seed_delays : d_delays,
+                            d_seed_pending ? d_seed_gains : d_gains);
+    }
+    d_have_tile = true;
+    d_current_tile = tile;
+
+    if (const delay_profile_cache::profile* profile = d_delay_cache.find(tile)) {
+        seed_fingers(*profile);
+    }
+}
+
+void rake_receiver_cc_impl::seed_fingers(const delay_profile_cache::profile& profile)
+{
+    // Caller holds d_setlock
+    if (profile.delays.size() != d_delays.size() ||
+        *std::min_element(profile.delays.begin(), profile.delays.end()) < 0) {
+        // Stored with a different finger configuration
+        return;
+    }
+    apply_fingers(profile.delays, profile.gains, d_running);
+}
+
+int rake_receiver_cc_impl::delay_capacity() const
+{
+    if (d_delay_storage == delay_storage::history) {
+        return static_cast<int>(history()) - d_pattern_length - 1;
+    }
+    return d_max_delay;
+}
+
+bool rake_receiver_cc_impl::apply_fingers(const std::vector<int>& delays,
+                                          const std::vector<float>& gains,
+                                          bool history_fixed)
+{
+    // Caller holds d_setlock
+    int max_delay = *std::max_element(delays.begin(), delays.end());
+    if (d_delay_storage == delay_storage::history && !history_fixed) {
+        d_delays = delays;
+        d_gains = gains;
+        resize_history(max_delay + d_pattern_length + 1);
+        return true;
+    }
+
+    // The history cannot grow under a running flowgraph, nor the ring once
+    // it is sized
+    if (max_delay > delay_capacity()) {
+        return false;
+    }
+    if (d_running) {
+        // Applied at the start of the next work() call
+        d_seed_delays = delays;
+        d_seed_gains = gains;
+        d_seed_pending = true;
+        return true;
+    }
+    d_delays = delays;
+    d_gains = gains;
+    d_seed_pending = false;
+    return true;
+}
+
+void rake_receiver_cc_impl::set_delay_line_mode(const std::string& mode, int max_delay)
+{
+    gr::thread::scoped_lock guard(d_setlock);
+    if (d_running) {
+        throw std::runtime_error(
+            "Cannot change the delay line mode while the flowgraph is running");
+    }
+
+    int current_max = *std::max_element(d_delays.begin(), d_delays.end());
+    if (mode == "history") {
+        d_delay_storage = delay_storage::history;
+        d_max_delay = 0;
+        d_ring = mirrored_ring();
+        d_correlations = mirrored_ring();
+        resize_history(current_max + d_pattern_length + 1);
+    } else if (mode == "ring") {
+        if (max_delay < current_max) {
+            throw std::invalid_argument(
+                "Maximum delay must cover the current finger delays");
+        }
+        d_delay_storage = delay_storage::ring;
+        d_max_delay = max_delay;
+        d_correlations = mirrored_ring();
+        // Room for the delay span plus at least as many new samples, so
+        // work() is split into few chunks
+        const int min_ring = 4096;
+        d_ring.resize(std::max(2 * (max_delay + d_pattern_length), min_ring));
+        resize_history(1);
+    } else if (mode == "sparse") {
+        if (max_delay < current_max) {
+            throw std::invalid_argument(
+                "Maximum delay must cover the current finger delays");
+        }
+        d_delay_storage = delay_storage::sparse;
+        d_max_delay = max_delay;
+        // The delay applies to the correlator output; the input behind it
+        // is kept for recorrelating on a new pattern and for the stats
+        const int chunk = 4096;
+        d_ring.resize(max_delay + d_pattern_length + chunk);
+        d_correlations.resize(max_delay + 1 + chunk);
+        resize_history(1);
+    } else {
+        throw std::invalid_argument("Unknown delay line mode: " + mode);
+    }
+}
+
+void rake_receiver_cc_impl::set_kernel(const std::string& name)
+{
+    if (name == "auto") {
+        gr::thread::scoped_lock guard(d_setlock);
+        d_kernel_autotune = true;
+        d_autotune_key.clear();
+        // Otherwise start() tunes, once the profile and fingers are set
+        if (d_running) {
+            autotune_kernel();
+        }
+        return;
+    }
+    const rake_kernel* kernel = find_rake_kernel(name);
+    if (!kernel) {
+        throw std::invalid_argument("Unknown correlation kernel: " + name);
+    }
+    gr::thread::scoped_lock guard(d_setlock);
+    d_kernel = kernel;
+    d_kernel_autotune = false;
+}
+
+std::string rake_receiver_cc_impl::kernel() const { return d_kernel->name; }
+
+bool rake_receiver_cc_impl::kernel_autotune() const { return d_kernel_autotune; }
+
+void rake_receiver_cc_impl::set_kernel_profile(const std::string& path)
+{
+    gr::thread::scoped_lock guard(d_setlock);
+    d_kernel_profile = path;
+}
+
+std::string rake_receiver_cc_impl::kernel_profile() const { return d_kernel_profile; }
+
+void rake_receiver_cc_impl::autotune_kernel()
+{
+    // Caller holds d_setlock
+    const autotune_key key = make_autotune_key(d_delay_storage == delay_storage::sparse,
+                                               static_cast<int>(d_delays.size()),
+                                               d_pattern_length,
+                                               delay_capacity());
+    const std::string id = key.to_string();
+    if (id == d_autotune_key) {
+        return;
+    }
+    d_autotune_key = id;
+
+    const rake_kernel* cached = nullptr;
+    if (!d_kernel_profile.empty()) {
+        cached = lookup_kernel_profile(d_kernel_profile, key);
+    }
+    if (cached) {
+        d_kernel = cached;
+        d_logger->debug("Kernel {} from profile {}", d_kernel->name, d_kernel_profile);
+        return;
+    }
+
+    std::vector<kernel_timing> timings = time_kernels(key);
+    d_kernel = timings.front().kernel;
+    for (const kernel_timing& timing : timings) {
+        d_logger->info("Kernel {}: {:.1f} ns per output ({} fingers, pattern {}, "
+                       "spread {})",
+                       timing.kernel->name,
+                       timing.ns_per_output,
+                       key.fingers,
+                       key.pattern_length,
+                       key.spread);
+    }
+    if (d_kernel_profile.empty()) {
+        return;
+    }
+    try {
+        store_kernel_profile(d_kernel_profile, key, *d_kernel);
+    } catch (const std::exception& e) {
+        d_logger->warn("Cannot save kernel profile: {}", e.what());
+    }
+}
+
+double rake_receiver_cc_impl::work_time() const
+{
+    return d_counters.work_time_ns.load() * 1e-9;
+}
+
+uint64_t rake_receiver_cc_impl::work_calls() const
+{
+    return d_counters.work_calls.load();
+}
+
+uint64_t rake_receiver_cc_impl::items_processed() const
+{
+    return d_counters.items.load();
+}
+
+std::vector<float> rake_receiver_cc_impl::finger_energy() const
+{
+    std::vector<float> energy(d_delays.size(), 0.0f);
+    uint64_t samples = d_counters.energy_samples.load();
+    if (samples == 0) {
+        return energy;
+    }
+    for (size_t finger = 0; finger < energy.size(); finger++) {
+        energy[finger] = static_cast<float>(d_counters.finger_energy[finger].load() /
+                                            static_cast<double>(samples));
+    }
+    return energy;
+}
+
+uint64_t rake_receiver_cc_impl::reconfigurations() const
+{
+    return d_counters.reconfigurations.load();
+}
+
+uint64_t rake_receiver_cc_impl::gps_fixes_accepted() const
+{
+    return d_counters.gps_fixes_accepted.load();
+}
+
+uint64_t rake_receiver_cc_impl::gps_fixes_rejected() const
+{
+    return d_counters.gps_fixes_rejected.load();
+}
+
+double rake_receiver_cc_impl::estimator_time() const
+{
+    return d_counters.estimator_time_ns.load() * 1e-9;
+}
+
+void rake_receiver_cc_impl::reset_counters() { d_counters.reset(); }
+
+void rake_receiver_cc_impl::set_stats_interval(float interval_s)
+{
+    if (!(interval_s >= 0.0f)) {
+        throw std::invalid_argument("Stats interval must not be negative");
+    }
+    gr::thread::scoped_lock guard(d_setlock);
+    d_stats_interval_s = interval_s;
+    reset_stats_interval();
+}
+
+float rake_receiver_cc_impl::stats_interval() const { return d_stats_interval_s; }
+
+void rake_receiver_cc_impl::set_latency_probe(bool enabled, int stamp_interval)
+{
+    if (stamp_interval < 0) {
+        throw std::invalid_argument("Latency stamp interval must not be negative");
+    }
+    gr::thread::scoped_lock guard(d_setlock);
+    d_latency_enabled = enabled;
+    d_latency_interval = stamp_interval;
+    d_latency_next = nitems_read(0);
+    d_latency_pending.clear();
+}
+
+bool rake_receiver_cc_impl::latency_probe() const { return d_latency_enabled; }
+
+int rake_receiver_cc_impl::group_delay() const
+{
+    return delay_capacity() + d_pattern_length;
+}
+
+void rake_receiver_cc_impl::stamp_latency_probes(uint64_t first, int noutput_items)
+{
+    const uint64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now().time_since_epoch())
+                                .count();
+    const uint64_t delay = group_delay();
+    auto is_probe = [](const tag_t& tag) {
+        return pmt::eq(tag.key, latency_probe_key()) && pmt::is_uint64(tag.value);
+    };
+    for (const tag_t& tag : d_tags) {
+        if (is_probe(tag)) {
+            d_latency_pending.emplace_back(tag.offset + delay, pmt::to_uint64(tag.value));
+        }
+    }
+    if (d_latency_interval == 0) {
+        return;
+    }
+    // Upstream probes propagate to the output at the same offset. Where one
+    // already sits, it is matched instead of stamping a second probe there,
+    // so an output sample never carries two.
+    const pmt::pmt_t srcid = pmt::mp(alias());
+    for (; d_latency_next < first + noutput_items; d_latency_next += d_latency_interval) {
+        const uint64_t offset = std::max(d_latency_next, first);
+        if (std::any_of(d_tags.begin(), d_tags.end(), [&](const tag_t& tag) {
+                return tag.offset == offset && is_probe(tag);
+            })) {
+            continue;
+        }
+        d_latency_pending.emplace_back(offset + delay, now_ns);
+        add_item_tag(0, offset, latency_probe_key(), pmt::from_uint64(now_ns), srcid);
+    }
+}
+
+void rake_receiver_cc_impl::match_latency_probes(uint64_t end)
+{
+    const uint64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now().time_since_epoch())
+                                .count();
+    auto matched = std::remove_if(
+        d_latency_pending.begin(),
+        d_latency_pending.end(),
+        [&](const std::pair<uint64_t, uint64_t>& probe) {
+            if (probe.first >= end) {
+                return false;
+            }
+            // A stamp from another clock could lie ahead; count it as zero
+            d_latency.add(now_ns > probe.second ? now_ns - probe.second : 0);
+            return true;
+        });
+    d_latency_pending.erase(matched, d_latency_pending.end());
+}
+
+void rake_receiver_cc_impl::reset_stats_interval()
+{
+    d_stats_last_s = monotonic_seconds();
+    d_stats_items = 0;
+    d_stats_work_ns = d_counters.work_time_ns.load();
+    d_stats_rho2.fill(0.0);
+    d_stats_rho_count.fill(0);
+    d_latency.reset();
+}
+
+void rake_receiver_cc_impl::publish_stats(int noutput_items)
+{
+    d_stats_items += noutput_items;
+    const double now = monotonic_seconds();
+    const double elapsed = now - d_stats_last_s;
+    const bool due = d_sample_rate > 0.0f
+                         ? d_stats_items >= d_stats_interval_s * d_sample_rate
+                         : elapsed >= d_stats_interval_s;
+    if (!due) {
+        return;
+    }
+
+    gr::thread::scoped_lock guard(d_setlock);
+    const size_t fingers = d_delays.size();
+    std::vector<float> snr_db(fingers, std::numeric_limits<float>::quiet_NaN());
+    pmt::pmt_t locked = pmt::make_vector(fingers, pmt::PMT_F);
+    for (size_t f = 0; f < fingers; f++) {
+        if (d_stats_rho_count[f] == 0) {
+            continue;
+        }
+        double rho2 = std::min(d_stats_rho2[f] / d_stats_rho_count[f], 0.999999);
+        snr_db[f] = static_cast<float>(10.0 * std::log10(rho2 / (1.0 - rho2)));
+        pmt::vector_set(locked, f, pmt::from_bool(std::sqrt(rho2) >= d_lock_threshold));
+    }
+
+    // GPS (filtered if enabled) first, the Doppler estimate otherwise
+    float speed_kmh = filtered_speed();
+    if (speed_kmh < 0.0f) {
+        speed_kmh = d_doppler_speed_kmh;
+    }
+    std::string category = "none";
+    if (speed_kmh >= 0.0f) {
+        category = d_speed_profile.name(d_speed_profile.segment(speed_kmh));
+    }
+    const uint64_t work_ns = d_counters.work_time_ns.load() - d_stats_work_ns;
+
+    pmt::pmt_t stats = pmt::make_dict();
+    stats = pmt::dict_add(
+        stats, pmt::mp("delays"), pmt::init_s32vector(fingers, d_delays.data()));
+    stats = pmt::dict_add(
+        stats, pmt::mp("gains"), pmt::init_f32vector(fingers, d_gains.data()));
+    stats = pmt::dict_add(
+        stats, pmt::mp("snr_db"), pmt::init_f32vector(fingers, snr_db.data()));
+    stats = pmt::dict_add(stats, pmt::mp("locked"), locked);
+    stats = pmt::dict_add(stats, pmt::mp("num_fingers"), pmt::from_long(d_num_fingers));
+    stats = pmt::dict_add(stats, pmt::mp("speed_kmh"), pmt::from_double(speed_kmh));
+    stats = pmt::dict_add(stats, pmt::mp("speed_category"), pmt::mp(category));
+    stats = pmt::dict_add(
+        stats, pmt::mp("path_search_rate"), pmt::from_double(d_path_search_rate_hz));
+    stats = pmt::dict_add(stats,
+                          pmt::mp("tracking_bandwidth"),
+                          pmt::from_double(d_tracking_bandwidth_hz));
+    stats = pmt::dict_add(stats,
+                          pmt::mp("reassignment_period"),
+                          pmt::from_double(d_reassignment_period_s));
+    stats = pmt::dict_add(stats, pmt::mp("items"), pmt::from_uint64(d_stats_items));
+    stats = pmt::dict_add(stats, pmt::mp("group_delay"), pmt::from_long(group_delay()));
+    if (d_latency_enabled) {
+        stats = pmt::dict_add(
+            stats, pmt::mp("latency_count"), pmt::from_uint64(d_latency.count()));
+        stats = pmt::dict_add(stats,
+                              pmt::mp("latency_p50_us"),
+                              pmt::from_double(d_latency.quantile_ns(0.5) * 1e-3));
+        stats = pmt::dict_add(stats,
+                              pmt::mp("latency_p99_us"),
+                              pmt::from_double(d_latency.quantile_ns(0.99) * 1e-3));
+        stats = pmt::dict_add(stats,
+                              pmt::mp("latency_max_us"),
+                              pmt::from_double(d_latency.max_ns() * 1e-3));
+    }
+    const double rate = elapsed > 0.0 ? d_stats_items / elapsed : 0.0;
+    stats = pmt::dict_add(stats, pmt::mp("samples_per_second"), pmt::from_double(rate));
+    stats = pmt::dict_add(
+        stats,
+        pmt::mp("work_ns_per_item"),
+        pmt::from_double(static_cast<double>(work_ns) / d_stats_items));
+    message_port_pub(stats_port(), stats);
+    reset_stats_interval();
+}
+
+void rake_receiver_cc_impl::setup_rpc()
+{
+#ifdef GR_CTRLPORT
+    auto add_get = [this](const char* name,
+                          double (rake_receiver_cc_impl::*getter)() const,
+                          const char* units,
+                          const char* description,
+                          int display) {
+        add_rpc_variable(
+            rpcbasic_sptr(new rpcbasic_register_get<rake_receiver_cc_impl, double>(
+                alias(),
+                name,
+                getter,
+                pmt::mp(0.0),
+                pmt::mp(1.0e12),
+                pmt::mp(0.0),
+                units,
+                description,
+                RPC_PRIVLVL_MIN,
+                display)));
+    };
+    add_get("work_time",
+            &rake_receiver_cc_impl::work_time,
+            "s",
+            "Cumulative time in work()",
+            DISPTIME | DISPOPTSTRIP);
+    add_get("work_calls",
+            &rake_receiver_cc_impl::work_calls_rpc,
+            "calls",
+            "Number of work() calls",
+            DISPTIME | DISPOPTSTRIP);
+    add_get("items_processed",
+            &rake_receiver_cc_impl::items_processed_rpc,
+            "samples",
+            "Samples processed",
+            DISPTIME | DISPOPTSTRIP);
+    add_get("reconfigurations",
+            &rake_receiver_cc_impl::reconfigurations_rpc,
+            "changes",
+            "Adaptive retunes and finger updates",
+            DISPTIME | DISPOPTSTRIP);
+    add_get("gps_fixes_accepted",
+            &rake_receiver_cc_impl::gps_fixes_accepted_rpc,
+            "fixes",
+            "GPS messages that yielded a speed",
+            DISPTIME | DISPOPTSTRIP);
+    add_get("gps_fixes_rejected",
+            &rake_receiver_cc_impl::gps_fixes_rejected_rpc,
+            "fixes",
+            "GPS messages without a usable fix",
+            DISPTIME | DISPOPTSTRIP);
+    add_get("estimator_time",
+            &rake_receiver_cc_impl::estimator_time,
+            "s",
+            "Cumulative time estimating the channel",
+            DISPTIME | DISPOPTSTRIP);
+    add_rpc_variable(rpcbasic_sptr(
+        new rpcbasic_register_get<rake_receiver_cc_impl, std::vector<float>>(
+            alias(),
+            "finger_energy",
+            &rake_receiver_cc_impl::finger_energy,
+            pmt::make_f32vector(1, 0.0f),
+            pmt::make_f32vector(1, 1.0e12f),
+            pmt::make_f32vector(1, 0.0f),
+            "",
+            "Mean correlator output power per finger",
+            RPC_PRIVLVL_MIN,
+            DISPTIME | DISPOPTSTRIP)));
+#endif
+}
+
+std::string rake_receiver_cc_impl::delay_line_mode() const
+{
+    switch (d_delay_storage) {
+    case delay_storage::ring:
+        return "ring";
+    case delay_storage::sparse:
+        return "sparse";
+    default:
+        return "history";
+    }
+}
+
+int rake_receiver_cc_impl::max_delay() const
+{
+    if (d_delay_storage == delay_storage::history) {
+        return delay_capacity();
+    }
+    return d_max_delay;
+}
+
+void rake_receiver_cc_impl::update_position(const gps_fix& fix)
+{
+    // Callers decode the fix from what they already parsed for the speed
+    if (!fix.has(gps_fix::has_position)) {
+        return;
+    }
+    if (fix.has(gps_fix::has_mode) && fix.mode < d_gps_min_mode) {
+        return;
+    }
+    scoped_timer timer(d_counters.estimator_time_ns);
+    set_position(fix.latitude_deg, fix.longitude_deg);
+}
+
+void rake_receiver_cc_impl::set_doppler_estimation(bool enable)
+{
+    gr::thread::scoped_lock guard(d_setlock);
+    d_doppler_enabled = enable;
+    d_doppler.reset();
+    d_doppler_samples = 0;
+}
+
+bool rake_receiver_cc_impl::doppler_estimation() const { return d_doppler_enabled; }
+
+void rake_receiver_cc_impl::set_carrier_frequency(double frequency_hz)
+{
+    if (!(frequency_hz > 0.0)) {
+        throw std::invalid_argument("Carrier frequency must be positive");
+    }
+    d_carrier_freq_hz = frequency_hz;
+}
+
+double rake_receiver_cc_impl::carrier_frequency() const { return d_carrier_freq_hz; }
+
+void rake_receiver_cc_impl::set_doppler_decimation(int decimation)
+{
+    if (decimation < 1) {
+        throw std::invalid_argument("Doppler decimation must be at least 1");
+    }
+    gr::thread::scoped_lock guard(d_setlock);
+    d_doppler_decimation = decimation;
+    d_doppler_phase = 0;
+    // Samples at the old spacing would skew the correlation
+    d_doppler.reset();
+}
+
+int rake_receiver_cc_impl::doppler_decimation() const { return d_doppler_decimation; }
+
+void rake_receiver_cc_impl::set_doppler_update_interval(float interval_s)
+{
+    if (!(interval_s > 0.0f)) {
+        throw std::invalid_argument("Doppler update interval must be positive");
+    }
+    d_doppler_interval_s = interval_s;
+}
+
+float rake_receiver_cc_impl::doppler_update_interval() const
+{
+    return d_doppler_interval_s;
+}
+
+float rake_receiver_cc_impl::doppler_spread() const { return d_doppler_spread_hz; }
+
+float rake_receiver_cc_impl::doppler_speed() const { return d_doppler_speed_kmh; }
+
+void rake_receiver_cc_impl::set_gps_speed(float speed_kmh)
+{
+    if (d_speed_filter) {
+        gr::thread::scoped_lock guard(d_setlock);
+        d_gps_speed_kmh = speed_kmh;
+        if (speed_kmh >= 0.0f) {
+            double now = current_seconds();
+            d_speed_kalman.update(now, speed_kmh);
+            run_adaptation_schedule(now);
+        }
+        return;
+    }
+
+    gr::thread::scoped_lock guard(d_setlock);
+    d_gps_speed_kmh = speed_kmh;
+    if (d_adaptive_mode && speed_kmh >= 0.0f) {
+        update_adaptive_parameters();
+    }
+}
+
+float rake_receiver_cc_impl::gps_speed() const { return d_gps_speed_kmh; }
+
+void rake_receiver_cc_impl::set_path_search_rate(float rate_hz)
+{
+    d_path_search_rate_hz = rate_hz;
+}
+
+float rake_receiver_cc_impl::path_search_rate() const { return d_path_search_rate_hz; }
+
+void rake_receiver_cc_impl::set_tracking_bandwidth(float bandwidth_hz)
+{
+    d_tracking_bandwidth_hz = bandwidth_hz;
+}
+
+float rake_receiver_cc_impl::tracking_bandwidth() const { return d_tracking_bandwidth_hz; }
+
+void rake_receiver_cc_impl::set_path_detection_threshold(float threshold)
+{
+    d_path_detection_threshold = threshold;
+}
+
+float rake_receiver_cc_impl::path_detection_threshold() const
+{
+    return d_path_detection_threshold;
+}
+
+void rake_receiver_cc_impl::set_lock_threshold(float threshold)
+{
+    d_lock_threshold = threshold;
+}
+
+float rake_receiver_cc_impl::lock_threshold() const { return d_lock_threshold; }
+
+void rake_receiver_cc_impl::set_reassignment_period(float period_s)
+{
+    d_reassignment_period_s = period_s;
+}
+
+float rake_receiver_cc_impl::reassignment_period() const { return d_reassignment_period_s; }
+
+void rake_receiver_cc_impl::set_adaptive_mode(bool enable)
+{
+    gr::thread::scoped_lock guard(d_setlock);
+    d_adaptive_mode = enable;
+    if (enable && d_gps_speed_kmh >= 0.0f) {
+        update_adaptive_parameters();
+    }
+}
+
+bool rake_receiver_cc_impl::adaptive_mode() const { return d_adaptive_mode; }
+
+void rake_receiver_cc_impl::set_speed_filter(bool enable)
+{
+    gr::thread::scoped_lock guard(d_setlock);
+    d_speed_filter = enable;
+    d_speed_kalman.reset();
+    d_last_adaptation_s = -std::numeric_limits<double>::infinity();
+    if (enable && d_gps_speed_kmh >= 0.0f) {
+        // Start from the last raw fix rather than from nothing
+        d_speed_kalman.update(current_seconds(), d_gps_speed_kmh);
+    }
+}
+
+bool rake_receiver_cc_impl::speed_filter() const { return d_speed_filter; }
+
+void rake_receiver_cc_impl::set_speed_filter_noise(float accel_noise,
+                                                   float measurement_noise)
+{
+    if (accel_noise <= 0.0f || measurement_noise <= 0.0f) {
+        throw std::invalid_argument("Speed filter noise values must be positive");
+    }
+    gr::thread::scoped_lock guard(d_setlock);
+    d_speed_kalman.set_noise(accel_noise, measurement_noise);
+}
+
+void rake_receiver_cc_impl::set_adaptation_interval(float interval_s)
+{
+    if (interval_s < 0.0f) {
+        throw std::invalid_argument("Adaptation interval must not be negative");
+    }
+    d_adaptation_interval_s = interval_s;
+}
+
+float rake_receiver_cc_impl::adaptation_interval() const
+{
+    return d_adaptation_interval_s;
+}
+
+float rake_receiver_cc_impl::filtered_speed() const
+{
+    if (!d_speed_filter || !d_speed_kalman.initialized()) {
+        return d_gps_speed_kmh;
+    }
+    return static_cast<float>(d_speed_kalman.predict(current_seconds()));
+}
+
+void rake_receiver_cc_impl::update_adaptive_parameters()
+{
+    if (!d_adaptive_mode) {
+        return;
+    }
+    if (d_speed_filter) {
+        if (d_speed_kalman.initialized()) {
+            double now = current_seconds();
+            d_last_adaptation_s = now;
+            apply_speed_category(d_speed_kalman.predict(now));
+        }
+        return;
+    }
+    if (d_gps_speed_kmh < 0.0f) {
+        return;
+    }
+    apply_speed_category(d_gps_speed_kmh);
+}
+
+void rake_receiver_cc_impl::run_adaptation_schedule(double now)
+{
+    // Caller holds d_setlock
+    if (!d_adaptive_mode || !d_speed_kalman.initialized() ||
+        now - d_last_adaptation_s < d_adaptation_interval_s) {
+        return;
+    }
+    d_last_adaptation_s = now;
+    apply_speed_category(d_speed_kalman.predict(now));
+}
+
+void rake_receiver_cc_impl::apply_speed_category(float speed_kmh)
+{
+    if (speed_kmh < 0.0f) {
+        return;
+    }
+
+    int current_fingers = d_params_pending ? d_pending_params.num_fingers : d_num_fingers;
+    speed_params params = d_speed_profile.lookup(speed_kmh, current_fingers);
+    // Never use more fingers than there are configured delays
+    params.num_fingers = std::min(params.num_fingers, static_cast<int>(d_delays.size()));
+    // Probe arguments are integers: speed in m/h
+    RAKE_PROBE3(apply__speed__category,
+                static_cast<int>(speed_kmh * 1000.0f),
+                params.num_fingers,
+                d_running ? 1 : 0);
+
+    if (d_running) {
+        // Applied and tagged by work() at its next boundary
+        d_pending_params = params;
+        d_pending_speed_kmh = speed_kmh;
+        d_params_pending = true;
+        return;
+    }
+    d_path_search_rate_hz = params.path_search_rate;
+    d_tracking_bandwidth_hz = params.tracking_bandwidth;
+    d_reassignment_period_s = params.reassignment_period;
+    d_num_fingers = params.num_fingers;
+    rake_counters::add(d_counters.reconfigurations, 1);
+}
+
+void rake_receiver_cc_impl::set_speed_profile(
+    const std::vector<float>& speeds_kmh,
+    const std::vector<float>& path_search_rates,
+    const std::vector<float>& tracking_bandwidths,
+    const std::vector<float>& reassignment_periods,
+    const std::vector<int>& num_fingers)
+{
+    size_t n = speeds_kmh.size();
+    if (path_search_rates.size() != n || tracking_bandwidths.size() != n ||
+        reassignment_periods.size() != n || num_fingers.size() != n) {
+        throw std::invalid_argument("Speed profile columns must have the same length");
+    }
+    std::vector<speed_params> params(n);
+    for (size_t i = 0; i < n; i++) {
+        params[i] = { path_search_rates[i],
+                      tracking_bandwidths[i],
+                      reassignment_periods[i],
+                      num_fingers[i] };
+    }
+    speed_profile profile(speeds_kmh, params);
+
+    gr::thread::scoped_lock guard(d_setlock);
+    profile.set_hysteresis(d_speed_profile.hysteresis());
+    d_speed_profile = std::move(profile);
+    update_adaptive_parameters();
+}
+
+void rake_receiver_cc_impl::load_speed_profile(const std::string& path)
+{
+    speed_profile profile = speed_profile::load(path);
+
+    gr::thread::scoped_lock guard(d_setlock);
+    d_speed_profile = std::move(profile);
+    update_adaptive_parameters();
+}
+
+void rake_receiver_cc_impl::reset_speed_profile()
+{
+    gr::thread::scoped_lock guard(d_setlock);
+    float hysteresis = d_speed_profile.hysteresis();
+    d_speed_profile = speed_profile();
+    d_speed_profile.set_hysteresis(hysteresis);
+    update_adaptive_parameters();
+}
+
+std::vector<float> rake_receiver_cc_impl::speed_profile_breakpoints() const
+{
+    return d_speed_profile.speeds();
+}
+
+void rake_receiver_cc_impl::set_speed_hysteresis(float hysteresis_kmh)
+{
+    gr::thread::scoped_lock guard(d_setlock);
+    d_speed_profile.set_hysteresis(hysteresis_kmh);
+}
+
+float rake_receiver_cc_impl::speed_hysteresis() const
+{
+    return d_speed_profile.hysteresis();
+}
+
+bool rake_receiver_cc_impl::parse_gps_data(const std::string& gps_data)
+{
+    return parse_gps_text(gps_data);
+}
+
+bool rake_receiver_cc_impl::parse_gps_text(std::string_view gps_data)
+{
+    if (is_ubx(gps_data)) {
+        return count_fix(accept_ubx_frames(gps_data));
+    }
+
+    std::string_view trimmed = trim_gps_data(gps_data);
+    if (!trimmed.empty() && trimmed[0] == '{') {
+        return count_fix(accept_gpsd_report(trimmed));
+    }
+    if (!trimmed.empty() && trimmed[0] == '$') {
+        return count_fix(accept_nmea_sentence(trimmed));
+    }
+
+    float speed = parse_gps_speed(trimmed);
+    if (speed >= 0.0f) {
+        set_gps_speed(speed);
+        return count_fix(true);
+    }
+    return count_fix(false);
+}
+
+bool rake_receiver_cc_impl::parse_nmea0183(const std::string& nmea_message)
+{
+    return count_fix(accept_nmea_sentence(nmea_message));
+}
+
+bool rake_receiver_cc_impl::parse_gpsd(const std::string& gpsd_json)
+{
+    return count_fix(accept_gpsd_report(gpsd_json));
+}
+
+bool rake_receiver_cc_impl::parse_ubx(const std::string& ubx_data)
+{
+    return count_fix(accept_ubx_frames(ubx_data));
+}
+
+bool rake_receiver_cc_impl::count_fix(bool accepted)
+{
+    rake_counters::add(accepted ? d_counters.gps_fixes_accepted
+                                : d_counters.gps_fixes_rejected,
+                       1);
+    return accepted;
+}
+
+bool rake_receiver_cc_impl::accept_nmea_sentence(std::string_view sentence)
+{
+    float speed;
+    if (d_delay_cache_enabled) {
+        // One split for the position and the speed
+        gps_fix fix;
+        parse_nmea0183_fix(sentence, fix, speed);
+        update_position(fix);
+    } else {
+        speed = parse_nmea0183_speed(sentence);
+    }
+    if (speed < 0.0f) {
+        return false;
+    }
+    set_gps_speed(speed);
+    return true;
+}
+
+bool rake_receiver_cc_impl::accept_ubx_frames(std::string_view ubx_data)
+{
+    float speed_kmh = -1.0f;
+    size_t pos = 0;
+    std::string_view frame;
+    ubx_nav_pvt pvt;
+    while (next_ubx_frame(ubx_data, pos, frame)) {
+        if (!parse_ubx_nav_pvt(frame, pvt)) {
+            continue;
+        }
+        if (d_delay_cache_enabled) {
+            gps_fix fix;
+            fix_from_ubx_nav_pvt(pvt, fix);
+            update_position(fix);
+        }
+        // Same gate as gpsd: GNSS+DR counts as 3D, time-only and fixes
+        // without gnssFixOK as no fix
+        int mode = pvt.fix_type == 4 ? 3 : pvt.fix_type;
+        if (!pvt.fix_ok || pvt.fix_type == 0 || pvt.fix_type == 5) {
+            mode = 1;
+        }
+        if (mode < d_gps_min_mode) {
+            continue;
+        }
+        if (d_gps_max_speed_error_kmh > 0.0f &&
+            pvt.speed_accuracy_mps * 3.6 > d_gps_max_speed_error_kmh) {
+            continue;
+        }
+        // A bad gSpeed skips its frame only, as in parse_ubx_speed()
+        float frame_speed_kmh = checked_speed_kmh(pvt.ground_speed_mps * 3.6);
+        if (frame_speed_kmh >= 0.0f) {
+            speed_kmh = frame_speed_kmh;
+        }
+    }
+
+    if (speed_kmh < 0.0f) {
+        return false;
+    }
+    set_gps_speed(speed_kmh);
+    return true;
+}
+
+bool rake_receiver_cc_impl::accept_gpsd_report(std::string_view gpsd_json)
+{
+    gpsd_report report;
+    if (!parse_gpsd_report(gpsd_json, report, true)) {
+        return false;
+    }
+    gps_fix fix;
+    if (d_delay_cache_enabled && fix_from_gpsd_report(report, fix)) {
+        update_position(fix);
+    }
+    if (std::isnan(report.speed)) {
+        return false;
+    }
+
+    // Don't reconfigure on reports that have no usable fix or whose speed
+    // error estimate is too large
+    if (report.mode >= 0 && report.mode < d_gps_min_mode) {
+        return false;
+    }
+    if (d_gps_max_speed_error_kmh > 0.0f && !std::isnan(report.eps) &&
+        report.eps * 3.6 > d_gps_max_speed_error_kmh) {
+        return false;
+    }
+
+    // GPSD speed is in m/s; same check as parse_gpsd_speed()
+    float speed_kmh = checked_speed_kmh(report.speed * 3.6);
+    if (speed_kmh < 0.0f) {
+        return false;
+    }
+    set_gps_speed(speed_kmh);
+    return true;
+}
+
+void rake_receiver_cc_impl::set_gps_min_mode(int mode) { d_gps_min_mode = mode; }
+
+int rake_receiver_cc_impl::gps_min_mode() const { return d_gps_min_mode; }
+
+void rake_receiver_cc_impl::set_gps_max_speed_error(float error_kmh)
+{
+    d_gps_max_speed_error_kmh = error_kmh;
+}
+
+float rake_receiver_cc_impl::gps_max_speed_error() const
+{
+    return d_gps_max_speed_error_kmh;
+}
+
+void rake_receiver_cc_impl::handle_gps_message(pmt::pmt_t msg)
+{
+    RAKE_PROBE0(gps__message__entry);
+    dispatch_gps_message(msg);
+    RAKE_PROBE0(gps__message__return);
+}
+
+void rake_receiver_cc_impl::dispatch_gps_message(pmt::pmt_t msg)
+{
+    // Receiver output: NMEA/GPSD text or UBX frames, parsed in place
+    if (pmt::is_u8vector(msg)) {
+        size_t length = 0;
+        const uint8_t* bytes = pmt::u8vector_elements(msg, length);
+        parse_gps_text(std::string_view(reinterpret_cast<const char*>(bytes), length));
+        return;
+    }
+    if (pmt::is_symbol(msg)) {
+        parse_gps_text(pmt::symbol_to_string(msg));
+        return;
+    }
+
+    // Pre-parsed fixes in km/h
+    float speed_kmh;
+    if (pmt_speed(msg, speed_kmh)) {
+        set_gps_speed(speed_kmh);
+        return;
+    }
+    if (pmt::is_f32vector(msg)) {
+        // Several fixes at once, oldest first
+        size_t count = 0;
+        const float* speeds = pmt::f32vector_elements(msg, count);
+        for (size_t i = 0; i < count; i++) {
+            if (checked_speed_kmh(speeds[i]) >= 0.0f) {
+                set_gps_speed(speeds[i]);
+            }
+        }
+        return;
+    }
+    if (pmt::is_pair(msg)) {
+        pmt::pmt_t head = pmt::car(msg);
+        // (speed_kmh . value)
+        if (pmt::is_symbol(head)) {
+            if (pmt::eq(head, speed_kmh_key()) && pmt_speed(pmt::cdr(msg), speed_kmh)) {
+                set_gps_speed(speed_kmh);
+            }
+            return;
+        }
+        // PDU: speed_kmh in the metadata, otherwise receiver output as payload
+        if (pmt::is_u8vector(pmt::cdr(msg))) {
+            if (dict_speed(head, speed_kmh)) {
+                set_gps_speed(speed_kmh);
+            } else {
+                dispatch_gps_message(pmt::cdr(msg));
+            }
+            return;
+        }
+    }
+    if (dict_speed(msg, speed_kmh)) {
+        set_gps_speed(speed_kmh);
     }
+    // Anything else carries no GPS data
 }
 
 void rake_receiver_cc_impl::set_gps_source(const std::string& source_type)
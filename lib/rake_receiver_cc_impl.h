@@ -12,13 +12,33 @@
 
 #include <gnuradio/rake_receiver/rake_receiver_cc.h>
 #include <gnuradio/gr_complex.h>
+#include "delay_profile_cache.h"
+#include "doppler_spread_estimator.h"
 #include "gps_parser.h"
+#include "gps_replay.h"
+#include "kernel_autotune.h"
+#include "latency_histogram.h"
+#include "mirrored_ring.h"
+#include "rake_counters.h"
+#include "rake_kernels.h"
+#include "receiver_state.h"
+#include "speed_kalman.h"
+#include "speed_profile.h"
+#include <array>
 #include <vector>
 #include <string>
+#include <string_view>
 
 namespace gr {
 namespace rake_receiver {
 
+//! Where the samples behind the finger delays are kept
+enum class delay_storage {
+    history, //!< GNU Radio history sized for the largest delay
+    ring,    //!< Own mirrored ring sized once for a maximum delay
+    sparse,  //!< Ring of shared correlator outputs sized for a maximum delay
+};
+
 class rake_receiver_cc_impl : public rake_receiver_cc
 {
 private:
@@ -27,6 +47,12 @@ private:
     std::vector<int> d_delays;
     std::vector<float> d_gains;
     std::vector<gr_complex> d_pattern;
+    const rake_kernel* d_kernel;
+
+    // set_kernel("auto"): the profile line d_kernel was last tuned for
+    bool d_kernel_autotune;
+    std::string d_kernel_profile;
+    std::string d_autotune_key;
 
     // Adaptive parameters
     float d_gps_speed_kmh;
@@ -38,6 +64,89 @@ private:
     bool d_adaptive_mode;
     float d_sample_rate;
 
+    // Parameter changes made while running wait for the next work() boundary
+    bool d_running;
+    bool d_params_pending;
+    speed_params d_pending_params;
+    float d_pending_speed_kmh;
+
+    // Stream time base, anchored by the last rx_time tag
+    bool d_have_rx_time;
+    uint64_t d_rx_time_offset;
+    double d_rx_time_seconds;
+    uint64_t d_work_offset;
+    std::vector<tag_t> d_tags;
+
+    // Delay line; in ring and sparse mode history() is 1 and delays up to
+    // d_max_delay can change without touching the scheduler's buffers.
+    // Sparse mode correlates each sample once and delays the correlator
+    // output; the input behind it is kept to recorrelate on a new pattern
+    delay_storage d_delay_storage;
+    int d_max_delay;
+    mirrored_ring d_ring;
+    mirrored_ring d_correlations;
+    std::vector<gr_complex> d_sparse_scratch;
+    bool d_recorrelate;
+
+    // Recorded GPS fixes replayed against the sample stream
+    gps_replay d_gps_replay;
+
+    // Finger profiles remembered per position tile; seeds found while
+    // running wait for the next work() boundary
+    bool d_delay_cache_enabled;
+    delay_profile_cache d_delay_cache;
+    bool d_have_tile;
+    uint64_t d_current_tile;
+    bool d_seed_pending;
+    std::vector<int> d_seed_delays;
+    std::vector<float> d_seed_gains;
+
+    // Doppler spread of the strongest finger as a GPS-free speed source
+    bool d_doppler_enabled;
+    double d_carrier_freq_hz;
+    int d_doppler_decimation;
+    float d_doppler_interval_s;
+    doppler_spread_estimator d_doppler;
+    int d_doppler_phase;
+    int d_doppler_delay;
+    uint64_t d_doppler_samples;
+    float d_doppler_spread_hz;
+    float d_doppler_speed_kmh;
+
+    // Monitoring; d_energy_phase carries the finger energy decimation
+    // across work() calls
+    rake_counters d_counters;
+    int d_energy_phase;
+
+    // Periodic "stats" messages; the interval sums are only touched by
+    // work(), which also publishes
+    float d_stats_interval_s;
+    double d_stats_last_s;
+    uint64_t d_stats_items;
+    uint64_t d_stats_work_ns;
+    std::array<double, rake_counters::max_fingers> d_stats_rho2;
+    std::array<uint64_t, rake_counters::max_fingers> d_stats_rho_count;
+
+    // Latency probes waiting for their output sample: (output offset, stamp
+    // in steady_clock ns). Only work() touches them and the histogram
+    bool d_latency_enabled;
+    int d_latency_interval;
+    uint64_t d_latency_next;
+    std::vector<std::pair<uint64_t, uint64_t>> d_latency_pending;
+    latency_histogram d_latency;
+
+    // Receiver state kept across restarts; d_state_current is set while
+    // the in-memory state matches the file
+    std::string d_state_file;
+    bool d_state_current;
+
+    // GPS speed filtering and scheduled adaptation
+    bool d_speed_filter;
+    speed_kalman d_speed_kalman;
+    float d_adaptation_interval_s;
+    double d_last_adaptation_s;
+    speed_profile d_speed_profile;
+
     // GPS source configuration
     std::string d_gps_source;
     std::string d_serial_device;
@@ -46,10 +155,70 @@ private:
     int d_gpsd_port;
     bool d_gps_running;
 
+    // GPSD fix quality gate
+    int d_gps_min_mode;
+    float d_gps_max_speed_error_kmh;
+
     // Helper methods
     void update_adaptive_parameters();
     void apply_speed_category(float speed_kmh);
+    void run_adaptation_schedule(double now);
+    void commit_pending_params(uint64_t offset);
+    double stream_seconds(uint64_t offset) const;
+    double current_seconds() const;
+    void handle_stream_tag(const tag_t& tag);
+    void handle_finger_tag(const tag_t& tag);
+    void autotune_kernel();
+    void process_span(const gr_complex* in, gr_complex* out, int begin, int end);
+    void combine_fingers(const gr_complex* windows, gr_complex* out, int count) const;
+    void combine_correlations(const gr_complex* correlations,
+                              gr_complex* out,
+                              int count) const;
+    void process_sparse(const gr_complex* in, gr_complex* out, int count);
+    void recorrelate();
+    void sample_doppler(const gr_complex* windows, int count, bool correlated);
+    void publish_doppler(int noutput_items);
+    void sample_finger_energy(const gr_complex* windows,
+                              const gr_complex* correlations,
+                              int count);
+    bool count_fix(bool accepted);
+    void reset_stats_interval();
+    void publish_stats(int noutput_items);
+    void stamp_latency_probes(uint64_t first, int noutput_items);
+    void match_latency_probes(uint64_t end);
+    // ControlPort shows numbers as doubles
+    double work_calls_rpc() const { return static_cast<double>(work_calls()); }
+    double items_processed_rpc() const
+    {
+        return static_cast<double>(items_processed());
+    }
+    double reconfigurations_rpc() const
+    {
+        return static_cast<double>(reconfigurations());
+    }
+    double gps_fixes_accepted_rpc() const
+    {
+        return static_cast<double>(gps_fixes_accepted());
+    }
+    double gps_fixes_rejected_rpc() const
+    {
+        return static_cast<double>(gps_fixes_rejected());
+    }
+    int delay_capacity() const;
+    bool apply_fingers(const std::vector<int>& delays,
+                       const std::vector<float>& gains,
+                       bool history_fixed);
     void handle_gps_message(pmt::pmt_t msg);
+    void dispatch_gps_message(pmt::pmt_t msg);
+    void resize_history(int samples);
+    bool accept_nmea_sentence(std::string_view sentence);
+    bool accept_gpsd_report(std::string_view gpsd_json);
+    bool accept_ubx_frames(std::string_view ubx_data);
+    bool parse_gps_text(std::string_view gps_data);
+    void update_position(const gps_fix& fix);
+    void seed_fingers(const delay_profile_cache::profile& profile);
+    receiver_state capture_state() const;
+    void restore_state(const receiver_state& state, bool history_fixed);
 
 public:
     rake_receiver_cc_impl(int num_fingers,
@@ -60,6 +229,8 @@ public:
 
     void set_delays(const std::vector<int>& delays) override;
     void set_gains(const std::vector<float>& gains) override;
+    std::vector<int> delays() const override;
+    std::vector<float> gains() const override;
     int num_fingers() const override;
     void set_pattern(const std::vector<gr_complex>& pattern) override;
 
@@ -77,10 +248,81 @@ public:
     float reassignment_period() const override;
     void set_adaptive_mode(bool enable) override;
     bool adaptive_mode() const override;
+    void set_speed_filter(bool enable) override;
+    bool speed_filter() const override;
+    void set_speed_filter_noise(float accel_noise, float measurement_noise) override;
+    void set_adaptation_interval(float interval_s) override;
+    float adaptation_interval() const override;
+    float filtered_speed() const override;
+    void set_speed_profile(const std::vector<float>& speeds_kmh,
+                           const std::vector<float>& path_search_rates,
+                           const std::vector<float>& tracking_bandwidths,
+                           const std::vector<float>& reassignment_periods,
+                           const std::vector<int>& num_fingers) override;
+    void load_speed_profile(const std::string& path) override;
+    void reset_speed_profile() override;
+    std::vector<float> speed_profile_breakpoints() const override;
+    void set_speed_hysteresis(float hysteresis_kmh) override;
+    float speed_hysteresis() const override;
+    void set_sample_rate(float sample_rate) override;
+    float sample_rate() const override;
+    size_t load_gps_replay(const std::string& path, double start_time) override;
+    void clear_gps_replay() override;
+    size_t gps_replay_remaining() const override;
+    void set_delay_cache(bool enable) override;
+    bool delay_cache() const override;
+    void set_delay_cache_tile_size(float tile_size_m) override;
+    float delay_cache_tile_size() const override;
+    void set_delay_cache_capacity(int capacity) override;
+    size_t delay_cache_size() const override;
+    size_t load_delay_cache(const std::string& path) override;
+    void save_delay_cache(const std::string& path) override;
+    void set_position(double latitude_deg, double longitude_deg) override;
+    void set_doppler_estimation(bool enable) override;
+    bool doppler_estimation() const override;
+    void set_carrier_frequency(double frequency_hz) override;
+    double carrier_frequency() const override;
+    void set_doppler_decimation(int decimation) override;
+    int doppler_decimation() const override;
+    void set_doppler_update_interval(float interval_s) override;
+    float doppler_update_interval() const override;
+    float doppler_spread() const override;
+    float doppler_speed() const override;
+    void set_state_file(const std::string& path) override;
+    std::string state_file() const override;
+    void save_state(const std::string& path) override;
+    void load_state(const std::string& path) override;
+    void set_delay_line_mode(const std::string& mode, int max_delay) override;
+    std::string delay_line_mode() const override;
+    int max_delay() const override;
+    void set_kernel(const std::string& name) override;
+    std::string kernel() const override;
+    bool kernel_autotune() const override;
+    void set_kernel_profile(const std::string& path) override;
+    std::string kernel_profile() const override;
+    double work_time() const override;
+    uint64_t work_calls() const override;
+    uint64_t items_processed() const override;
+    std::vector<float> finger_energy() const override;
+    uint64_t reconfigurations() const override;
+    uint64_t gps_fixes_accepted() const override;
+    uint64_t gps_fixes_rejected() const override;
+    double estimator_time() const override;
+    void reset_counters() override;
+    void set_stats_interval(float interval_s) override;
+    float stats_interval() const override;
+    void set_latency_probe(bool enabled, int stamp_interval) override;
+    bool latency_probe() const override;
+    int group_delay() const override;
 
     bool parse_gps_data(const std::string& gps_data) override;
     bool parse_nmea0183(const std::string& nmea_message) override;
     bool parse_gpsd(const std::string& gpsd_json) override;
+    bool parse_ubx(const std::string& ubx_data) override;
+    void set_gps_min_mode(int mode) override;
+    int gps_min_mode() const override;
+    void set_gps_max_speed_error(float error_kmh) override;
+    float gps_max_speed_error() const override;
 
     void set_gps_source(const std::string& source_type) override;
     std::string gps_source() const override;
@@ -95,6 +337,10 @@ public:
     bool start_gps() override;
     void stop_gps() override;
 
+    bool start() override;
+    bool stop() override;
+    void setup_rpc() override;
+
     int work(int noutput_items,
              gr_vector_const_void_star& input_items,
              gr_vector_void_star& output_items) override;
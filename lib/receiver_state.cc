@@ -0,0 +1,156 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "receiver_state.h"
+#include "mapped_file.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace gr {
+namespace rake_receiver {
+
+namespace {
+
+constexpr char state_magic[4] = { 'R', 'K', 'S', 'T' };
+constexpr uint32_t state_version = 1;
+constexpr uint32_t flag_speed_filter = 1u << 0;
+
+struct state_header {
+    char magic[4];
+    uint32_t version;
+    uint32_t fingers;
+    uint32_t active_fingers;
+    uint32_t pattern_length;
+    uint32_t flags;
+    float gps_speed_kmh;
+    float path_search_rate_hz;
+    float tracking_bandwidth_hz;
+    float path_detection_threshold;
+    float lock_threshold;
+    float reassignment_period_s;
+    float doppler_spread_hz;
+    float doppler_speed_kmh;
+    double filter_speed;
+    double filter_accel;
+    double filter_p00;
+    double filter_p01;
+    double filter_p11;
+};
+
+// Largest finger count a snapshot may claim; guards the array reads
+constexpr uint32_t max_state_fingers = 64;
+
+} // namespace
+
+void save_receiver_state(const std::string& path, const receiver_state& state)
+{
+    if (state.delays.size() != state.gains.size()) {
+        throw std::invalid_argument("Receiver state needs one gain per delay");
+    }
+
+    state_header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, state_magic, sizeof(state_magic));
+    header.version = state_version;
+    header.fingers = static_cast<uint32_t>(state.delays.size());
+    header.active_fingers = static_cast<uint32_t>(state.active_fingers);
+    header.pattern_length = static_cast<uint32_t>(state.pattern_length);
+    header.flags = state.speed_filter_initialized ? flag_speed_filter : 0;
+    header.gps_speed_kmh = state.gps_speed_kmh;
+    header.path_search_rate_hz = state.path_search_rate_hz;
+    header.tracking_bandwidth_hz = state.tracking_bandwidth_hz;
+    header.path_detection_threshold = state.path_detection_threshold;
+    header.lock_threshold = state.lock_threshold;
+    header.reassignment_period_s = state.reassignment_period_s;
+    header.doppler_spread_hz = state.doppler_spread_hz;
+    header.doppler_speed_kmh = state.doppler_speed_kmh;
+    header.filter_speed = state.speed_filter.speed;
+    header.filter_accel = state.speed_filter.accel;
+    header.filter_p00 = state.speed_filter.p00;
+    header.filter_p01 = state.speed_filter.p01;
+    header.filter_p11 = state.speed_filter.p11;
+
+    std::vector<int32_t> delays(state.delays.begin(), state.delays.end());
+
+    // Write next to the target and rename, so a crash never leaves a
+    // truncated snapshot behind
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(delays.data()),
+                  sizeof(int32_t) * delays.size());
+        out.write(reinterpret_cast<const char*>(state.gains.data()),
+                  sizeof(float) * state.gains.size());
+        if (!out.flush()) {
+            throw std::runtime_error("Cannot write receiver state file: " + tmp_path);
+        }
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        throw std::runtime_error("Cannot replace receiver state file: " + path);
+    }
+}
+
+receiver_state load_receiver_state(const std::string& path)
+{
+    mapped_file file(path);
+    const std::runtime_error malformed("Malformed receiver state file: " + path);
+
+    state_header header;
+    if (file.size() < sizeof(header)) {
+        throw malformed;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, state_magic, sizeof(state_magic)) != 0 ||
+        header.version != state_version || header.fingers == 0 ||
+        header.fingers > max_state_fingers ||
+        file.size() !=
+            sizeof(header) + header.fingers * (sizeof(int32_t) + sizeof(float))) {
+        throw malformed;
+    }
+
+    receiver_state state;
+    std::vector<int32_t> delays(header.fingers);
+    state.gains.resize(header.fingers);
+    const char* arrays = file.data() + sizeof(header);
+    std::memcpy(delays.data(), arrays, sizeof(int32_t) * header.fingers);
+    std::memcpy(state.gains.data(),
+                arrays + sizeof(int32_t) * header.fingers,
+                sizeof(float) * header.fingers);
+    state.delays.assign(delays.begin(), delays.end());
+
+    state.active_fingers = static_cast<int>(header.active_fingers);
+    state.pattern_length = static_cast<int>(header.pattern_length);
+    state.gps_speed_kmh = header.gps_speed_kmh;
+    state.path_search_rate_hz = header.path_search_rate_hz;
+    state.tracking_bandwidth_hz = header.tracking_bandwidth_hz;
+    state.path_detection_threshold = header.path_detection_threshold;
+    state.lock_threshold = header.lock_threshold;
+    state.reassignment_period_s = header.reassignment_period_s;
+    state.speed_filter_initialized = (header.flags & flag_speed_filter) != 0;
+    state.speed_filter = { header.filter_speed,
+                           header.filter_accel,
+                           header.filter_p00,
+                           header.filter_p01,
+                           header.filter_p11 };
+    state.doppler_spread_hz = header.doppler_spread_hz;
+    state.doppler_speed_kmh = header.doppler_speed_kmh;
+    return state;
+}
+
+} // namespace rake_receiver
+} // namespace gr
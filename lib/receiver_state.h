@@ -0,0 +1,67 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef INCLUDED_RAKE_RECEIVER_RECEIVER_STATE_H
+#define INCLUDED_RAKE_RECEIVER_RECEIVER_STATE_H
+
+#include "speed_kalman.h"
+#include <string>
+#include <vector>
+
+namespace gr {
+namespace rake_receiver {
+
+/*!
+ * \brief Everything the receiver has learned at run time
+ *
+ * Saved as one fixed-size POD header followed by the finger arrays, so a
+ * snapshot is read straight out of a memory-mapped file:
+ *
+ * \code
+ * char magic[4] = "RKST", uint32 version = 1, uint32 fingers,
+ * uint32 active_fingers, uint32 pattern_length, uint32 flags,
+ * float32 gps_speed_kmh, path_search_rate_hz, tracking_bandwidth_hz,
+ *         path_detection_threshold, lock_threshold, reassignment_period_s,
+ *         doppler_spread_hz, doppler_speed_kmh,
+ * float64 speed, accel, p00, p01, p11 (speed filter),
+ * int32 delays[fingers], float32 gains[fingers]
+ * \endcode
+ *
+ * in host byte order.
+ */
+struct receiver_state {
+    std::vector<int> delays;
+    std::vector<float> gains;
+    int active_fingers;
+    int pattern_length;
+
+    float gps_speed_kmh;
+    float path_search_rate_hz;
+    float tracking_bandwidth_hz;
+    float path_detection_threshold;
+    float lock_threshold;
+    float reassignment_period_s;
+
+    bool speed_filter_initialized;
+    speed_kalman::state speed_filter;
+
+    float doppler_spread_hz;
+    float doppler_speed_kmh;
+};
+
+//! Write \p state to \p path atomically; throws std::runtime_error on failure
+void save_receiver_state(const std::string& path, const receiver_state& state);
+
+//! Read a snapshot; throws std::runtime_error if unreadable or malformed
+receiver_state load_receiver_state(const std::string& path);
+
+} // namespace rake_receiver
+} // namespace gr
+
+#endif /* INCLUDED_RAKE_RECEIVER_RECEIVER_STATE_H */
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "speed_kalman.h"
+#include <algorithm>
+
+namespace gr {
+namespace rake_receiver {
+
+speed_kalman::speed_kalman(double accel_noise, double measurement_noise)
+    : d_accel_noise(accel_noise), d_measurement_noise(measurement_noise)
+{
+    reset();
+}
+
+void speed_kalman::reset()
+{
+    d_initialized = false;
+    d_time = 0.0;
+    d_speed = 0.0;
+    d_accel = 0.0;
+    d_p00 = d_p01 = d_p11 = 0.0;
+}
+
+void speed_kalman::set_noise(double accel_noise, double measurement_noise)
+{
+    d_accel_noise = accel_noise;
+    d_measurement_noise = measurement_noise;
+}
+
+void speed_kalman::update(double t, double speed_kmh)
+{
+    const double r = d_measurement_noise * d_measurement_noise;
+
+    if (!d_initialized) {
+        // Start from the first fix with an unknown acceleration
+        d_initialized = true;
+        d_time = t;
+        d_speed = speed_kmh;
+        d_accel = 0.0;
+        d_p00 = r;
+        d_p01 = 0.0;
+        d_p11 = d_accel_noise * d_accel_noise;
+        return;
+    }
+
+    // Predict: x = F x, P = F P F' + Q with F = [1 dt; 0 1]
+    double dt = std::max(t - d_time, 0.0);
+    double q = d_accel_noise * d_accel_noise;
+    double speed = d_speed + dt * d_accel;
+    double p00 = d_p00 + dt * (2.0 * d_p01 + dt * d_p11) + q * dt * dt * dt / 3.0;
+    double p01 = d_p01 + dt * d_p11 + q * dt * dt / 2.0;
+    double p11 = d_p11 + q * dt;
+
+    // Correct with the speed measurement (H = [1 0])
+    double s = p00 + r;
+    double k0 = p00 / s;
+    double k1 = p01 / s;
+    double innovation = speed_kmh - speed;
+
+    d_time = std::max(t, d_time);
+    d_speed = speed + k0 * innovation;
+    d_accel = d_accel + k1 * innovation;
+    d_p00 = (1.0 - k0) * p00;
+    d_p01 = (1.0 - k0) * p01;
+    d_p11 = p11 - k1 * p01;
+}
+
+void speed_kalman::restore(const state& s, double t)
+{
+    d_initialized = true;
+    d_time = t;
+    d_speed = s.speed;
+    d_accel = s.accel;
+    d_p00 = s.p00;
+    d_p01 = s.p01;
+    d_p11 = s.p11;
+}
+
+double speed_kalman::predict(double t) const
+{
+    if (!d_initialized) {
+        return -1.0;
+    }
+    // Hold the speed once fixes stop coming instead of ramping it forever
+    const double max_horizon_s = 5.0;
+    double dt = std::min(std::max(t - d_time, 0.0), max_horizon_s);
+    return std::max(d_speed + dt * d_accel, 0.0);
+}
+
+} // namespace rake_receiver
+} // namespace gr
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef INCLUDED_RAKE_RECEIVER_SPEED_KALMAN_H
+#define INCLUDED_RAKE_RECEIVER_SPEED_KALMAN_H
+
+namespace gr {
+namespace rake_receiver {
+
+/*!
+ * \brief Two-state (speed, acceleration) Kalman filter for GPS speed fixes
+ *
+ * Constant-acceleration model with white acceleration noise. Speeds are in
+ * km/h, times in seconds on any monotonic time base.
+ */
+class speed_kalman
+{
+public:
+    /*!
+     * \param accel_noise Standard deviation of the acceleration change per
+     *        second (km/h/s); larger values follow speed changes faster
+     * \param measurement_noise Standard deviation of a GPS speed fix (km/h)
+     */
+    speed_kalman(double accel_noise = 5.0, double measurement_noise = 2.0);
+
+    //! Forget all fixes
+    void reset();
+
+    //! True once the first fix has been seen
+    bool initialized() const { return d_initialized; }
+
+    //! Predict to time \p t and correct with a speed fix
+    void update(double t, double speed_kmh);
+
+    //! Speed predicted at time \p t, never negative; the prediction is held
+    //! after a few seconds without fixes
+    double predict(double t) const;
+
+    //! Speed estimate at the time of the last fix
+    double speed() const { return d_speed; }
+
+    //! Acceleration estimate at the time of the last fix (km/h/s)
+    double acceleration() const { return d_accel; }
+
+    //! Estimate and covariance, for saving and restoring the filter
+    struct state {
+        double speed;
+        double accel;
+        double p00;
+        double p01;
+        double p11;
+    };
+
+    //! Current estimate; only meaningful once initialized()
+    state snapshot() const { return { d_speed, d_accel, d_p00, d_p01, d_p11 }; }
+
+    //! Resume from \p s as if its last fix had been taken at time \p t
+    void restore(const state& s, double t);
+
+    void set_noise(double accel_noise, double measurement_noise);
+    double accel_noise() const { return d_accel_noise; }
+    double measurement_noise() const { return d_measurement_noise; }
+
+private:
+    double d_accel_noise;
+    double d_measurement_noise;
+    bool d_initialized;
+    double d_time;
+    double d_speed;
+    double d_accel;
+    // Covariance, symmetric: [p00 p01; p01 p11]
+    double d_p00;
+    double d_p01;
+    double d_p11;
+};
+
+} // namespace rake_receiver
+} // namespace gr
+
+#endif /* INCLUDED_RAKE_RECEIVER_SPEED_KALMAN_H */
@@ -0,0 +1,35 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "speed_message.h"
+#include "gps_parser.h"
+
+namespace gr {
+namespace rake_receiver {
+
+bool pmt_speed(const pmt::pmt_t& value, float& speed_kmh)
+{
+    double speed;
+    if (pmt::is_uint64(value)) {
+        speed = static_cast<double>(pmt::to_uint64(value));
+    } else if (pmt::is_real(value) || pmt::is_integer(value)) {
+        speed = pmt::to_double(value);
+    } else {
+        return false;
+    }
+    speed_kmh = checked_speed_kmh(speed);
+    return speed_kmh >= 0.0f;
+}
+
+} // namespace rake_receiver
+} // namespace gr
@@ -0,0 +1,32 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef INCLUDED_RAKE_RECEIVER_SPEED_MESSAGE_H
+#define INCLUDED_RAKE_RECEIVER_SPEED_MESSAGE_H
+
+#include <pmt/pmt.h>
+
+namespace gr {
+namespace rake_receiver {
+
+/*!
+ * \brief Speed in km/h from a numeric PMT (real, integer or uint64)
+ *
+ * Shared by the blocks that take speeds as messages, so that they accept
+ * the same values.
+ *
+ * \return False for non-numeric PMTs and for speeds that checked_speed_kmh()
+ *         rejects: negative, NaN, infinite or out of float range
+ */
+bool pmt_speed(const pmt::pmt_t& value, float& speed_kmh);
+
+} // namespace rake_receiver
+} // namespace gr
+
+#endif /* INCLUDED_RAKE_RECEIVER_SPEED_MESSAGE_H */
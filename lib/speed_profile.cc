@@ -0,0 +1,263 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "speed_profile.h"
+#include "gps_parser.h"
+#include "json_scanner.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace gr {
+namespace rake_receiver {
+
+namespace {
+
+struct default_category {
+    const char* name;
+    float speed_kmh;
+    speed_params params;
+};
+
+// Interpolation is capped at 200 km/h for very high speeds
+constexpr default_category default_categories[] = {
+    { "stationary", 5.0f, { 5.0f, 50.0f, 2.0f, 3 } },
+    { "pedestrian", 15.0f, { 10.0f, 100.0f, 1.0f, 3 } },
+    { "low_speed", 60.0f, { 20.0f, 120.0f, 1.0f, 4 } },
+    { "high_speed", 120.0f, { 50.0f, 200.0f, 0.5f, 4 } },
+    { "very_high_speed", 200.0f, { 100.0f, 300.0f, 0.25f, 4 } },
+};
+
+} // namespace
+
+speed_profile::speed_profile() : d_hysteresis_kmh(0.0f)
+{
+    for (const auto& category : default_categories) {
+        d_speeds.push_back(category.speed_kmh);
+        d_path_search_rates.push_back(category.params.path_search_rate);
+        d_tracking_bandwidths.push_back(category.params.tracking_bandwidth);
+        d_reassignment_periods.push_back(category.params.reassignment_period);
+        d_num_fingers.push_back(category.params.num_fingers);
+        d_names.emplace_back(category.name);
+    }
+}
+
+speed_profile::speed_profile(const std::vector<float>& speeds_kmh,
+                             const std::vector<speed_params>& params,
+                             const std::vector<std::string>& names)
+    : d_hysteresis_kmh(0.0f), d_speeds(speeds_kmh)
+{
+    if (params.size() != speeds_kmh.size()) {
+        throw std::invalid_argument(
+            "Speed profile needs one parameter set per breakpoint");
+    }
+    if (!names.empty() && names.size() != speeds_kmh.size()) {
+        throw std::invalid_argument("Speed profile needs one name per breakpoint");
+    }
+
+    for (size_t i = 0; i < params.size(); i++) {
+        d_path_search_rates.push_back(params[i].path_search_rate);
+        d_tracking_bandwidths.push_back(params[i].tracking_bandwidth);
+        d_reassignment_periods.push_back(params[i].reassignment_period);
+        d_num_fingers.push_back(params[i].num_fingers);
+        d_names.push_back(names.empty() ? "category " + std::to_string(i) : names[i]);
+    }
+    validate();
+}
+
+void speed_profile::validate() const
+{
+    if (d_speeds.empty()) {
+        throw std::invalid_argument("Speed profile must have at least one breakpoint");
+    }
+    for (size_t i = 0; i < d_speeds.size(); i++) {
+        if (!(d_speeds[i] >= 0.0f) || (i > 0 && !(d_speeds[i] > d_speeds[i - 1]))) {
+            throw std::invalid_argument(
+                "Speed profile breakpoints must be non-negative and strictly ascending");
+        }
+        if (!(d_path_search_rates[i] > 0.0f) || !(d_tracking_bandwidths[i] > 0.0f) ||
+            !(d_reassignment_periods[i] > 0.0f)) {
+            throw std::invalid_argument("Speed profile rates and periods must be positive");
+        }
+        if (d_num_fingers[i] < 1 || d_num_fingers[i] > 5) {
+            throw std::invalid_argument("Speed profile finger counts must be 1-5");
+        }
+    }
+}
+
+speed_profile speed_profile::from_json(std::string_view json)
+{
+    struct entry {
+        float speed;
+        speed_params params;
+        std::string name;
+    };
+    std::vector<entry> entries;
+    float hysteresis = 0.0f;
+    bool have_hysteresis = false;
+    bool bad_category = false;
+
+    auto parse_category = [&](json_type type, std::string_view value) {
+        if (type != json_type::object) {
+            bad_category = true;
+            return false;
+        }
+        entry e{ -1.0f, { 0.0f, 0.0f, 0.0f, 0 }, std::string() };
+        bool have_speed = false;
+        bool ok = scan_json_object(
+            value, [&](std::string_view key, json_type t, std::string_view v) {
+                if (t == json_type::string && key == "name") {
+                    e.name = std::string(v);
+                    return true;
+                }
+                if (t != json_type::number) {
+                    return true;
+                }
+                float f;
+                if (!parse_float_field(v, f)) {
+                    return true;
+                }
+                if (key == "speed_kmh") {
+                    e.speed = f;
+                    have_speed = true;
+                } else if (key == "path_search_rate") {
+                    e.params.path_search_rate = f;
+                } else if (key == "tracking_bandwidth") {
+                    e.params.tracking_bandwidth = f;
+                } else if (key == "reassignment_period") {
+                    e.params.reassignment_period = f;
+                } else if (key == "num_fingers") {
+                    // Checked before the cast, which is undefined out of range
+                    if (!(f >= 1.0f && f <= 5.0f) || f != std::floor(f)) {
+                        throw std::invalid_argument(
+                            "Speed profile finger counts must be 1-5");
+                    }
+                    e.params.num_fingers = static_cast<int>(f);
+                }
+                return true;
+            });
+        if (!ok || !have_speed) {
+            bad_category = true;
+            return false;
+        }
+        entries.push_back(std::move(e));
+        return true;
+    };
+
+    bool have_categories = false;
+    bool well_formed = scan_json_object(
+        json, [&](std::string_view key, json_type type, std::string_view value) {
+            if (key == "categories" && type == json_type::array) {
+                have_categories = true;
+                return scan_json_array(value, parse_category) && !bad_category;
+            }
+            if (key == "hysteresis_kmh" && type == json_type::number) {
+                have_hysteresis = parse_float_field(value, hysteresis);
+            }
+            return true;
+        });
+    if (!well_formed || !have_categories || bad_category) {
+        throw std::invalid_argument("Malformed speed profile JSON");
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const entry& a, const entry& b) {
+        return a.speed < b.speed;
+    });
+    std::vector<float> speeds;
+    std::vector<speed_params> params;
+    std::vector<std::string> names;
+    for (auto& e : entries) {
+        speeds.push_back(e.speed);
+        params.push_back(e.params);
+        names.push_back(e.name.empty() ? "category " + std::to_string(names.size())
+                                       : std::move(e.name));
+    }
+
+    speed_profile profile(speeds, params, names);
+    if (have_hysteresis) {
+        profile.set_hysteresis(hysteresis);
+    }
+    return profile;
+}
+
+speed_profile speed_profile::load(const std::string& path)
+{
+    mapped_file file(path);
+    return from_json(std::string_view(file.data(), file.size()));
+}
+
+void speed_profile::set_hysteresis(float kmh)
+{
+    if (!(kmh >= 0.0f)) {
+        throw std::invalid_argument("Speed hysteresis must not be negative");
+    }
+    d_hysteresis_kmh = kmh;
+}
+
+size_t speed_profile::segment(float speed_kmh) const
+{
+    // Branch-free lower bound: the loop count depends only on the table size
+    // and the comparison compiles to a conditional move
+    const float* base = d_speeds.data();
+    size_t n = d_speeds.size();
+    while (n > 1) {
+        size_t half = n / 2;
+        base = (base[half] <= speed_kmh) ? base + half : base;
+        n -= half;
+    }
+    return static_cast<size_t>(base - d_speeds.data());
+}
+
+speed_params speed_profile::lookup(float speed_kmh, int current_fingers) const
+{
+    size_t i = segment(speed_kmh);
+    if (i + 1 >= d_speeds.size()) {
+        return { d_path_search_rates[i],
+                 d_tracking_bandwidths[i],
+                 d_reassignment_periods[i],
+                 d_num_fingers[i] };
+    }
+
+    const float lower_speed = d_speeds[i];
+    const float upper_speed = d_speeds[i + 1];
+    // Below the first breakpoint the first entry is held
+    float alpha = (speed_kmh - lower_speed) / (upper_speed - lower_speed);
+    alpha = std::min(std::max(alpha, 0.0f), 1.0f);
+
+    speed_params p;
+    p.path_search_rate = d_path_search_rates[i] +
+                         alpha * (d_path_search_rates[i + 1] - d_path_search_rates[i]);
+    p.tracking_bandwidth =
+        d_tracking_bandwidths[i] +
+        alpha * (d_tracking_bandwidths[i + 1] - d_tracking_bandwidths[i]);
+    p.reassignment_period =
+        d_reassignment_periods[i] +
+        alpha * (d_reassignment_periods[i + 1] - d_reassignment_periods[i]);
+
+    // Switch fingers at the midpoint, moved away from the current count by
+    // the hysteresis band
+    const int lower_fingers = d_num_fingers[i];
+    const int upper_fingers = d_num_fingers[i + 1];
+    float threshold = (lower_speed + upper_speed) / 2.0f;
+    if (current_fingers == upper_fingers) {
+        threshold -= d_hysteresis_kmh;
+    } else if (current_fingers == lower_fingers) {
+        threshold += d_hysteresis_kmh;
+    }
+    p.num_fingers = (speed_kmh < threshold) ? lower_fingers : upper_fingers;
+    return p;
+}
+
+} // namespace rake_receiver
+} // namespace gr
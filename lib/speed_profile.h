@@ -0,0 +1,112 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef INCLUDED_RAKE_RECEIVER_SPEED_PROFILE_H
+#define INCLUDED_RAKE_RECEIVER_SPEED_PROFILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace gr {
+namespace rake_receiver {
+
+/*!
+ * \brief RAKE tuning for one speed
+ */
+struct speed_params {
+    float path_search_rate;    //!< Hz
+    float tracking_bandwidth;  //!< Hz
+    float reassignment_period; //!< s
+    int num_fingers;
+};
+
+/*!
+ * \brief Breakpoint table mapping GPS speed to RAKE parameters
+ *
+ * Breakpoints are stored column-wise in ascending speed order. Below the first
+ * and above the last breakpoint the end values are held; in between the
+ * continuous parameters are interpolated linearly. The finger count switches
+ * from the lower to the upper breakpoint at the segment midpoint, optionally
+ * with a hysteresis band around it so speeds hovering at the midpoint do not
+ * toggle fingers on every fix.
+ *
+ * The default table reproduces the built-in stationary / pedestrian /
+ * low-speed / high-speed / very-high-speed categories.
+ */
+class speed_profile
+{
+public:
+    //! Default five-category table
+    speed_profile();
+
+    /*!
+     * \brief Build a table from breakpoints in ascending speed order
+     *
+     * Throws std::invalid_argument if the table is empty, the columns differ
+     * in length, speeds are not strictly ascending or a value is out of range.
+     */
+    speed_profile(const std::vector<float>& speeds_kmh,
+                  const std::vector<speed_params>& params,
+                  const std::vector<std::string>& names = {});
+
+    /*!
+     * \brief Parse a table from JSON
+     *
+     * \code
+     * {"hysteresis_kmh": 2.0,
+     *  "categories": [{"name": "stationary", "speed_kmh": 5, "path_search_rate": 5,
+     *                  "tracking_bandwidth": 50, "reassignment_period": 2,
+     *                  "num_fingers": 3}, ...]}
+     * \endcode
+     *
+     * Categories may be listed in any order. Throws std::invalid_argument on
+     * malformed input.
+     */
+    static speed_profile from_json(std::string_view json);
+
+    //! Load a JSON table from a file; throws std::runtime_error if unreadable
+    static speed_profile load(const std::string& path);
+
+    size_t size() const { return d_speeds.size(); }
+    const std::vector<float>& speeds() const { return d_speeds; }
+    const std::string& name(size_t index) const { return d_names[index]; }
+
+    //! Index of the last breakpoint at or below \p speed_kmh (0 below the first)
+    size_t segment(float speed_kmh) const;
+
+    /*!
+     * \brief Interpolated parameters for \p speed_kmh
+     *
+     * \param current_fingers Finger count currently in use, for hysteresis;
+     *        pass a negative value to switch exactly at the midpoint
+     */
+    speed_params lookup(float speed_kmh, int current_fingers = -1) const;
+
+    //! Width of the band on either side of a finger switch point (km/h)
+    void set_hysteresis(float kmh);
+    float hysteresis() const { return d_hysteresis_kmh; }
+
+private:
+    void validate() const;
+
+    float d_hysteresis_kmh;
+    std::vector<float> d_speeds;
+    std::vector<float> d_path_search_rates;
+    std::vector<float> d_tracking_bandwidths;
+    std::vector<float> d_reassignment_periods;
+    std::vector<int> d_num_fingers;
+    std::vector<std::string> d_names;
+};
+
+} // namespace rake_receiver
+} // namespace gr
+
+#endif /* INCLUDED_RAKE_RECEIVER_SPEED_PROFILE_H */
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#include <pybind11/pybind11.h>
+
+namespace py = pybind11;
+
+#include <gnuradio/rake_receiver/gps_fix.h>
+
+void bind_gps_fix(py::module& m)
+{
+    using gr::rake_receiver::gps_fix;
+
+    py::class_<gps_fix> fix(m, "gps_fix");
+    fix.def(py::init<>())
+        .def_readonly("valid", &gps_fix::valid)
+        .def_readonly("time", &gps_fix::time)
+        .def_readonly("latitude_deg", &gps_fix::latitude_deg)
+        .def_readonly("longitude_deg", &gps_fix::longitude_deg)
+        .def_readonly("altitude_m", &gps_fix::altitude_m)
+        .def_readonly("speed_kmh", &gps_fix::speed_kmh)
+        .def_readonly("course_deg", &gps_fix::course_deg)
+        .def_readonly("mode", &gps_fix::mode)
+        .def_readonly("satellites", &gps_fix::satellites)
+        .def_readonly("hdop", &gps_fix::hdop)
+        .def_readonly("speed_error_kmh", &gps_fix::speed_error_kmh)
+        .def("has", &gps_fix::has, py::arg("fields"));
+
+    fix.attr("has_time") = static_cast<uint32_t>(gps_fix::has_time);
+    fix.attr("has_date") = static_cast<uint32_t>(gps_fix::has_date);
+    fix.attr("has_position") = static_cast<uint32_t>(gps_fix::has_position);
+    fix.attr("has_altitude") = static_cast<uint32_t>(gps_fix::has_altitude);
+    fix.attr("has_speed") = static_cast<uint32_t>(gps_fix::has_speed);
+    fix.attr("has_course") = static_cast<uint32_t>(gps_fix::has_course);
+    fix.attr("has_mode") = static_cast<uint32_t>(gps_fix::has_mode);
+    fix.attr("has_satellites") = static_cast<uint32_t>(gps_fix::has_satellites);
+    fix.attr("has_hdop") = static_cast<uint32_t>(gps_fix::has_hdop);
+    fix.attr("has_speed_error") = static_cast<uint32_t>(gps_fix::has_speed_error);
+
+    m.def(
+        "parse_gps_fix",
+        [](py::bytes data) -> py::object {
+            std::string record = data;
+            gps_fix result;
+            if (!gr::rake_receiver::parse_gps_fix(record, result)) {
+                return py::none();
+            }
+            return py::cast(result);
+        },
+        py::arg("data"),
+        "Extract position, course, speed and time from one NMEA0183, GPSD or UBX "
+        "record.\nReturns a gps_fix, or None if the record is not supported");
+
+    m.def(
+        "parse_gps_fix",
+        [](const std::string& data) -> py::object {
+            gps_fix result;
+            if (!gr::rake_receiver::parse_gps_fix(data, result)) {
+                return py::none();
+            }
+            return py::cast(result);
+        },
+        py::arg("data"),
+        "Extract position, course, speed and time from one NMEA0183 or GPSD record "
+        "held in a string.\nReturns a gps_fix, or None if the record is not supported");
+}
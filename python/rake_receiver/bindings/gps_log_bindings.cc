@@ -0,0 +1,87 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+namespace py = pybind11;
+
+#include <gnuradio/rake_receiver/gps_log.h>
+
+namespace {
+
+// Hand a column over to numpy without copying; the capsule owns the vector
+template <typename T>
+py::array_t<T> to_array(std::vector<T>&& column)
+{
+    auto* owner = new std::vector<T>(std::move(column));
+    py::capsule free_owner(owner,
+                           [](void* p) { delete static_cast<std::vector<T>*>(p); });
+    return py::array_t<T>(owner->size(), owner->data(), free_owner);
+}
+
+py::tuple to_arrays(gr::rake_receiver::gps_log&& log)
+{
+    auto valid = to_array(std::move(log.valid)).attr("view")("bool");
+    return py::make_tuple(
+        to_array(std::move(log.timestamps)), to_array(std::move(log.speeds_kmh)), valid);
+}
+
+} // namespace
+
+void bind_gps_log(py::module& m)
+{
+    using gr::rake_receiver::gps_log;
+
+    m.def(
+        "parse_gps_log",
+        [](py::buffer data) {
+            py::buffer_info info = data.request();
+            gps_log log;
+            {
+                py::gil_scoped_release release;
+                log = gr::rake_receiver::parse_gps_log(
+                    static_cast<const char*>(info.ptr),
+                    static_cast<size_t>(info.size * info.itemsize));
+            }
+            return to_arrays(std::move(log));
+        },
+        py::arg("data"),
+        "Parse an NMEA0183/GPSD log held in a bytes-like object (bytes, mmap, ...).\n"
+        "Returns (timestamps, speeds_kmh, valid) as numpy arrays");
+
+    m.def(
+        "parse_gps_log",
+        [](const std::string& data) {
+            gps_log log;
+            {
+                py::gil_scoped_release release;
+                log = gr::rake_receiver::parse_gps_log(data);
+            }
+            return to_arrays(std::move(log));
+        },
+        py::arg("data"),
+        "Parse an NMEA0183/GPSD log held in a string.\n"
+        "Returns (timestamps, speeds_kmh, valid) as numpy arrays");
+
+    m.def(
+        "parse_gps_log_file",
+        [](const std::string& path) {
+            gps_log log;
+            {
+                py::gil_scoped_release release;
+                log = gr::rake_receiver::parse_gps_log_file(path);
+            }
+            return to_arrays(std::move(log));
+        },
+        py::arg("path"),
+        "Memory-map and parse an NMEA0183/GPSD log file.\n"
+        "Returns (timestamps, speeds_kmh, valid) as numpy arrays");
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2024
+ *
+ * This file is part of gr-rake_receiver
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#include <pybind11/complex.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+namespace py = pybind11;
+
+#include <gnuradio/rake_receiver/multipath_channel_cc.h>
+
+void bind_multipath_channel_cc(py::module& m)
+{
+    using multipath_channel_cc = gr::rake_receiver::multipath_channel_cc;
+
+    py::class_<multipath_channel_cc,
+               gr::sync_block,
+               gr::block,
+               gr::basic_block,
+               std::shared_ptr<multipath_channel_cc>>(m, "multipath_channel_cc")
+
+        .def(py::init(&multipath_channel_cc::make),
+             py::arg("delays"),
+             py::arg("gains_db"),
+             py::arg("k_factors"),
+             py::arg("sample_rate"),
+             py::arg("carrier_freq"),
+             py::arg("speed_kmh"),
+             py::arg("num_sinusoids") = 16,
+             py::arg("seed") = 0,
+             "Make a multipath fading channel block")
+
+        .def("set_speed",
+             &multipath_channel_cc::set_speed,
+             py::arg("speed_kmh"),
+             "Set the speed of the receiver (km/h)")
+
+        .def("speed", &multipath_channel_cc::speed, "Get the speed (km/h)")
+
+        .def("max_doppler",
+             &multipath_channel_cc::max_doppler,
+             "Get the maximum Doppler frequency at the current speed (Hz)")
+
+        .def("delays", &multipath_channel_cc::delays, "Get the tap delays")
+
+        .def("load_gps_replay",
+             &multipath_channel_cc::load_gps_replay,
+             py::arg("path"),
+             py::arg("start_time") = -1.0,
+             "Replay the speeds of a GPS log against the sample stream")
+
+        .def("clear_gps_replay",
+             &multipath_channel_cc::clear_gps_replay,
+             "Stop replaying a GPS log")
+
+        .def("gps_replay_remaining",
+             &multipath_channel_cc::gps_replay_remaining,
+             "Get the number of replayed fixes not yet applied");
+}
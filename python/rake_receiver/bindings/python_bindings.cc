@@ -24,6 +24,9 @@ namespace py = pybind11;
 // ) END BINDING_FUNCTION_PROTOTYPES
 
 void bind_rake_receiver_cc(py::module& m);
+void bind_gps_log(py::module& m);
+void bind_gps_fix(py::module& m);
+void bind_multipath_channel_cc(py::module& m);
 
 
 // We need this hack because import_array() returns NULL
@@ -54,4 +57,7 @@ PYBIND11_MODULE(rake_receiver_python, m)
     // ) END BINDING_FUNCTION_CALLS
 
     bind_rake_receiver_cc(m);
+    bind_gps_log(m);
+    bind_gps_fix(m);
+    bind_multipath_channel_cc(m);
 }
@@ -42,6 +42,10 @@ void bind_rake_receiver_cc(py::module& m)
              py::arg("gains"),
              "Set the gains for each finger")
 
+        .def("delays", &rake_receiver_cc::delays, "Get the current finger delays")
+
+        .def("gains", &rake_receiver_cc::gains, "Get the current finger gains")
+
         .def("num_fingers",
              &rake_receiver_cc::num_fingers,
              "Get the current number of fingers")
@@ -129,6 +133,312 @@ void bind_rake_receiver_cc(py::module& m)
              py::arg("gpsd_json"),
              "Parse GPSD JSON message and update GPS speed")
 
+        .def("parse_ubx",
+             &rake_receiver_cc::parse_ubx,
+             py::arg("ubx_data"),
+             "Parse u-blox UBX frames and update GPS speed from NAV-PVT")
+
+        .def("set_gps_min_mode",
+             &rake_receiver_cc::set_gps_min_mode,
+             py::arg("mode"),
+             "Set the minimum GPSD fix mode accepted for speed updates")
+
+        .def("gps_min_mode",
+             &rake_receiver_cc::gps_min_mode,
+             "Get the minimum GPSD fix mode accepted for speed updates")
+
+        .def("set_gps_max_speed_error",
+             &rake_receiver_cc::set_gps_max_speed_error,
+             py::arg("error_kmh"),
+             "Set the largest GPSD speed error estimate accepted (km/h, 0 disables)")
+
+        .def("gps_max_speed_error",
+             &rake_receiver_cc::gps_max_speed_error,
+             "Get the largest GPSD speed error estimate accepted")
+
+        .def("set_speed_filter",
+             &rake_receiver_cc::set_speed_filter,
+             py::arg("enable"),
+             "Enable or disable Kalman filtering of GPS speed fixes")
+
+        .def("speed_filter",
+             &rake_receiver_cc::speed_filter,
+             "Check if GPS speed filtering is enabled")
+
+        .def("set_speed_filter_noise",
+             &rake_receiver_cc::set_speed_filter_noise,
+             py::arg("accel_noise"),
+             py::arg("measurement_noise"),
+             "Set the speed filter noise model (km/h/s, km/h)")
+
+        .def("set_adaptation_interval",
+             &rake_receiver_cc::set_adaptation_interval,
+             py::arg("interval_s"),
+             "Set how often filtered speed updates the adaptive parameters")
+
+        .def("adaptation_interval",
+             &rake_receiver_cc::adaptation_interval,
+             "Get the adaptation interval in seconds")
+
+        .def("filtered_speed",
+             &rake_receiver_cc::filtered_speed,
+             "Get the filtered speed predicted for the current time")
+
+        .def("set_speed_profile",
+             &rake_receiver_cc::set_speed_profile,
+             py::arg("speeds_kmh"),
+             py::arg("path_search_rates"),
+             py::arg("tracking_bandwidths"),
+             py::arg("reassignment_periods"),
+             py::arg("num_fingers"),
+             "Replace the speed-to-parameter table used in adaptive mode")
+
+        .def("load_speed_profile",
+             &rake_receiver_cc::load_speed_profile,
+             py::arg("path"),
+             "Load the speed-to-parameter table from a JSON file")
+
+        .def("reset_speed_profile",
+             &rake_receiver_cc::reset_speed_profile,
+             "Restore the built-in five-category speed profile")
+
+        .def("speed_profile_breakpoints",
+             &rake_receiver_cc::speed_profile_breakpoints,
+             "Get the breakpoint speeds of the current speed profile")
+
+        .def("set_speed_hysteresis",
+             &rake_receiver_cc::set_speed_hysteresis,
+             py::arg("hysteresis_kmh"),
+             "Set the hysteresis band around finger count switch points (km/h)")
+
+        .def("speed_hysteresis",
+             &rake_receiver_cc::speed_hysteresis,
+             "Get the finger switch hysteresis")
+
+        .def("set_sample_rate",
+             &rake_receiver_cc::set_sample_rate,
+             py::arg("sample_rate"),
+             "Set the input sample rate used for stream time")
+
+        .def("sample_rate",
+             &rake_receiver_cc::sample_rate,
+             "Get the input sample rate (0 if not set)")
+
+        .def("load_gps_replay",
+             &rake_receiver_cc::load_gps_replay,
+             py::arg("path"),
+             py::arg("start_time") = -1.0,
+             "Replay a recorded GPS log in step with the sample stream")
+
+        .def("clear_gps_replay",
+             &rake_receiver_cc::clear_gps_replay,
+             "Stop replaying a GPS log")
+
+        .def("gps_replay_remaining",
+             &rake_receiver_cc::gps_replay_remaining,
+             "Get the number of replayed fixes not yet applied")
+
+        .def("set_delay_cache",
+             &rake_receiver_cc::set_delay_cache,
+             py::arg("enable"),
+             "Remember finger profiles per position tile and reuse them")
+
+        .def("delay_cache",
+             &rake_receiver_cc::delay_cache,
+             "Check whether the delay profile cache is enabled")
+
+        .def("set_delay_cache_tile_size",
+             &rake_receiver_cc::set_delay_cache_tile_size,
+             py::arg("tile_size_m"),
+             "Set the delay cache tile edge length in metres (clears the cache)")
+
+        .def("delay_cache_tile_size",
+             &rake_receiver_cc::delay_cache_tile_size,
+             "Get the delay cache tile edge length in metres")
+
+        .def("set_delay_cache_capacity",
+             &rake_receiver_cc::set_delay_cache_capacity,
+             py::arg("capacity"),
+             "Set how many tiles the delay cache keeps")
+
+        .def("delay_cache_size",
+             &rake_receiver_cc::delay_cache_size,
+             "Get the number of tiles in the delay cache")
+
+        .def("load_delay_cache",
+             &rake_receiver_cc::load_delay_cache,
+             py::arg("path"),
+             "Replace the delay cache with the profiles saved in a file")
+
+        .def("save_delay_cache",
+             &rake_receiver_cc::save_delay_cache,
+             py::arg("path"),
+             "Save the delay cache, including the current tile, to a file")
+
+        .def("set_position",
+             &rake_receiver_cc::set_position,
+             py::arg("latitude_deg"),
+             py::arg("longitude_deg"),
+             "Report the receiver position to the delay cache")
+
+        .def("set_doppler_estimation",
+             &rake_receiver_cc::set_doppler_estimation,
+             py::arg("enable"),
+             "Estimate speed from the Doppler spread of the strongest finger")
+
+        .def("doppler_estimation",
+             &rake_receiver_cc::doppler_estimation,
+             "Check whether the Doppler spread estimator is enabled")
+
+        .def("set_carrier_frequency",
+             &rake_receiver_cc::set_carrier_frequency,
+             py::arg("frequency_hz"),
+             "Set the carrier frequency used to convert Doppler to speed (Hz)")
+
+        .def("carrier_frequency",
+             &rake_receiver_cc::carrier_frequency,
+             "Get the carrier frequency (0 if not set)")
+
+        .def("set_doppler_decimation",
+             &rake_receiver_cc::set_doppler_decimation,
+             py::arg("decimation"),
+             "Set the samples between the estimator's channel estimates")
+
+        .def("doppler_decimation",
+             &rake_receiver_cc::doppler_decimation,
+             "Get the samples between the estimator's channel estimates")
+
+        .def("set_doppler_update_interval",
+             &rake_receiver_cc::set_doppler_update_interval,
+             py::arg("interval_s"),
+             "Set how often the Doppler speed is published (s)")
+
+        .def("doppler_update_interval",
+             &rake_receiver_cc::doppler_update_interval,
+             "Get the Doppler update interval (s)")
+
+        .def("doppler_spread",
+             &rake_receiver_cc::doppler_spread,
+             "Get the last Doppler spread estimate (Hz, -1 if none)")
+
+        .def("doppler_speed",
+             &rake_receiver_cc::doppler_speed,
+             "Get the speed equivalent to the last Doppler estimate (km/h, -1 if none)")
+
+        .def("set_state_file",
+             &rake_receiver_cc::set_state_file,
+             py::arg("path"),
+             "Keep the receiver state in a file across flowgraph restarts")
+
+        .def("state_file",
+             &rake_receiver_cc::state_file,
+             "Get the state file (empty if disabled)")
+
+        .def("save_state",
+             &rake_receiver_cc::save_state,
+             py::arg("path"),
+             "Save the receiver state to a file")
+
+        .def("load_state",
+             &rake_receiver_cc::load_state,
+             py::arg("path"),
+             "Restore the receiver state from a file written by save_state()")
+
+        .def("set_delay_line_mode",
+             &rake_receiver_cc::set_delay_line_mode,
+             py::arg("mode"),
+             py::arg("max_delay") = 0,
+             "Store finger delay samples in the GNU Radio history, an internal ring "
+             "or a sparse correlator ring")
+
+        .def("delay_line_mode",
+             &rake_receiver_cc::delay_line_mode,
+             "Get the delay line mode (history, ring or sparse)")
+
+        .def("max_delay",
+             &rake_receiver_cc::max_delay,
+             "Get the largest delay the delay line can serve without resizing")
+
+        .def("set_kernel",
+             &rake_receiver_cc::set_kernel,
+             py::arg("name"),
+             "Choose the finger correlation kernel (volk, scalar or auto)")
+
+        .def("kernel",
+             &rake_receiver_cc::kernel,
+             "Get the finger correlation kernel")
+
+        .def("kernel_autotune",
+             &rake_receiver_cc::kernel_autotune,
+             "Check whether the kernel is chosen by set_kernel(\"auto\")")
+
+        .def("set_kernel_profile",
+             &rake_receiver_cc::set_kernel_profile,
+             py::arg("path"),
+             "Set the per-host profile that caches autotuned kernels")
+
+        .def("kernel_profile",
+             &rake_receiver_cc::kernel_profile,
+             "Get the kernel profile path")
+
+        .def("work_time",
+             &rake_receiver_cc::work_time,
+             "Get the cumulative time spent in work() (s)")
+
+        .def("work_calls", &rake_receiver_cc::work_calls, "Get the number of work() calls")
+
+        .def("items_processed",
+             &rake_receiver_cc::items_processed,
+             "Get the number of samples processed")
+
+        .def("finger_energy",
+             &rake_receiver_cc::finger_energy,
+             "Get the mean correlator output power of each finger")
+
+        .def("reconfigurations",
+             &rake_receiver_cc::reconfigurations,
+             "Get the number of adaptive retunes and finger updates applied")
+
+        .def("gps_fixes_accepted",
+             &rake_receiver_cc::gps_fixes_accepted,
+             "Get the number of GPS messages that yielded a speed")
+
+        .def("gps_fixes_rejected",
+             &rake_receiver_cc::gps_fixes_rejected,
+             "Get the number of GPS messages without a usable fix")
+
+        .def("estimator_time",
+             &rake_receiver_cc::estimator_time,
+             "Get the cumulative time spent estimating the channel (s)")
+
+        .def("reset_counters",
+             &rake_receiver_cc::reset_counters,
+             "Zero all performance counters")
+
+        .def("set_stats_interval",
+             &rake_receiver_cc::set_stats_interval,
+             py::arg("interval_s"),
+             "Set the seconds between stats messages (0 disables them)")
+
+        .def("stats_interval",
+             &rake_receiver_cc::stats_interval,
+             "Get the seconds between stats messages")
+
+        .def("set_latency_probe",
+             &rake_receiver_cc::set_latency_probe,
+             py::arg("enabled"),
+             py::arg("stamp_interval") = 0,
+             "Match latency_probe tags at the output, stamping own ones every "
+             "stamp_interval samples")
+
+        .def("latency_probe",
+             &rake_receiver_cc::latency_probe,
+             "Get whether latency probes are matched")
+
+        .def("group_delay",
+             &rake_receiver_cc::group_delay,
+             "Get the algorithmic delay of the combiner (samples)")
+
         .def("set_gps_source",
              &rake_receiver_cc::set_gps_source,
              py::arg("source_type"),
@@ -0,0 +1,43 @@
+#!/usr/bin/env python3
+#
+# Copyright 2024
+#
+# This file is part of gr-rake_receiver
+#
+# SPDX-License-Identifier: GPL-3.0-or-later
+#
+
+from gnuradio import gr_unittest, rake_receiver
+
+
+class qa_gps_fix(gr_unittest.TestCase):  # noqa: N801
+    def test_001_nmea(self):
+        fix = rake_receiver.parse_gps_fix(
+            "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A"
+        )
+        gps_fix = rake_receiver.gps_fix
+        self.assertIsNotNone(fix)
+        self.assertTrue(fix.has(gps_fix.has_position | gps_fix.has_date))
+        self.assertFalse(fix.has(gps_fix.has_altitude))
+        self.assertAlmostEqual(fix.time, 764426119.0, places=3)
+        self.assertAlmostEqual(fix.latitude_deg, 48.1173, places=4)
+        self.assertAlmostEqual(fix.longitude_deg, 11.516667, places=4)
+        self.assertAlmostEqual(fix.speed_kmh, 41.4848, places=2)
+        self.assertAlmostEqual(fix.course_deg, 84.4, places=3)
+
+    def test_002_gpsd_bytes(self):
+        fix = rake_receiver.parse_gps_fix(
+            b'{"class":"TPV","mode":2,"lat":-33.85,"lon":151.2,"speed":1.0}'
+        )
+        self.assertEqual(fix.mode, 2)
+        self.assertAlmostEqual(fix.latitude_deg, -33.85)
+        self.assertAlmostEqual(fix.speed_kmh, 3.6, places=4)
+        self.assertFalse(fix.has(rake_receiver.gps_fix.has_time))
+
+    def test_003_unsupported(self):
+        self.assertIsNone(rake_receiver.parse_gps_fix("$GPGSV,3,1,11*74"))
+        self.assertIsNone(rake_receiver.parse_gps_fix(b""))
+
+
+if __name__ == "__main__":
+    gr_unittest.run(qa_gps_fix)
@@ -0,0 +1,40 @@
+#!/usr/bin/env python3
+#
+# Copyright 2024
+#
+# This file is part of gr-rake_receiver
+#
+# SPDX-License-Identifier: GPL-3.0-or-later
+#
+
+from gnuradio import gr_unittest, rake_receiver
+import numpy as np
+
+
+class qa_gps_log(gr_unittest.TestCase):  # noqa: N801
+    LOG = (
+        b"$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n"
+        b"$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48\r\n"
+        b'{"class":"TPV","mode":3,"time":"2024-01-01T12:00:00.000Z","speed":12.5}\n'
+    )
+
+    def test_001_parse_bytes(self):
+        timestamps, speeds, valid = rake_receiver.parse_gps_log(self.LOG)
+
+        self.assertEqual(timestamps.dtype, np.float64)
+        self.assertEqual(speeds.dtype, np.float32)
+        self.assertEqual(valid.dtype, np.bool_)
+        self.assertEqual(len(timestamps), 3)
+
+        self.assertAlmostEqual(timestamps[0], 764426119.0, places=3)
+        self.assertAlmostEqual(timestamps[2], 1704110400.0, places=3)
+        np.testing.assert_allclose(speeds, [41.4848, 10.2, 45.0], rtol=1e-3)
+        self.assertTrue(valid.all())
+
+    def test_002_parse_str(self):
+        timestamps, speeds, valid = rake_receiver.parse_gps_log(self.LOG.decode())
+        self.assertEqual(len(speeds), 3)
+
+
+if __name__ == "__main__":
+    gr_unittest.run(qa_gps_log)
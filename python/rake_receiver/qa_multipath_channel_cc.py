@@ -0,0 +1,45 @@
+#!/usr/bin/env python3
+#
+# Copyright 2024
+#
+# This file is part of gr-rake_receiver
+#
+# SPDX-License-Identifier: GPL-3.0-or-later
+#
+
+from gnuradio import gr, gr_unittest, blocks, rake_receiver
+import numpy as np
+import pmt
+
+
+class qa_multipath_channel_cc(gr_unittest.TestCase):  # noqa: N801
+    def test_001_make(self):
+        channel = rake_receiver.multipath_channel_cc(
+            [0, 5, 17], [0.0, -3.0, -6.0], [], 1.0e6, 2.0e9, 36.0
+        )
+        self.assertEqual(list(channel.delays()), [0, 5, 17])
+        self.assertAlmostEqual(channel.max_doppler(), 66.71, places=2)
+        channel.set_speed(72.0)
+        self.assertAlmostEqual(channel.speed(), 72.0)
+        with self.assertRaises(ValueError):
+            rake_receiver.multipath_channel_cc([0, 1], [0.0], [], 1.0e6, 2.0e9, 0.0)
+
+    def test_002_fading_power(self):
+        channel = rake_receiver.multipath_channel_cc(
+            [0], [0.0], [], 10000.0, 2.0e9, 100.0, 16, 7
+        )
+        src = blocks.vector_source_c([1.0 + 0.0j] * 200000, False)
+        dst = blocks.vector_sink_c()
+        tb = gr.top_block()
+        tb.connect(src, channel, dst)
+        tb.run()
+
+        power = np.abs(np.array(dst.data())) ** 2
+        self.assertAlmostEqual(power.mean(), 1.0, delta=0.15)
+        tags = [t for t in dst.tags() if pmt.symbol_to_string(t.key) == "gps_speed"]
+        self.assertEqual(len(tags), 1)
+        self.assertAlmostEqual(pmt.to_double(tags[0].value), 100.0)
+
+
+if __name__ == "__main__":
+    gr_unittest.run(qa_multipath_channel_cc)
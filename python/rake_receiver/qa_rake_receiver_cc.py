@@ -9,6 +9,11 @@
 
 from gnuradio import gr, gr_unittest, blocks, rake_receiver
 import numpy as np
+import pmt
+import os
+import struct
+import tempfile
+import time
 
 
 class qa_rake_receiver_cc(gr_unittest.TestCase):  # noqa: N801
@@ -288,6 +293,373 @@ class qa_rake_receiver_cc(gr_unittest.TestCase):  # noqa: N801
         # 10 m/s = 36 km/h
         self.assertAlmostEqual(rake.gps_speed(), 36.0, places=1)
 
+    def test_016_gpsd_quality_gate(self):
+        rake = rake_receiver.rake_receiver_cc(
+            4, [0, 10, 20, 30], [1.0, 0.8, 0.6, 0.4], 42
+        )
+        self.assertEqual(rake.gps_min_mode(), 2)
+
+        # SKY reports and TPV reports without a fix are ignored
+        self.assertFalse(rake.parse_gpsd('{"class":"SKY","hdop":1.2}'))
+        self.assertFalse(rake.parse_gpsd('{"class":"TPV","mode":1,"speed":10.0}'))
+        self.assertAlmostEqual(rake.gps_speed(), -1.0, places=5)
+
+        rake.set_gps_max_speed_error(5.0)
+        self.assertAlmostEqual(rake.gps_max_speed_error(), 5.0, places=5)
+        self.assertFalse(
+            rake.parse_gpsd('{"class":"TPV","mode":3,"speed":5.0,"eps":2.0}')
+        )
+        self.assertTrue(
+            rake.parse_gpsd('{"class":"TPV","mode":3,"speed":5.0,"eps":1.0}')
+        )
+        self.assertAlmostEqual(rake.gps_speed(), 18.0, places=1)
+
+    def test_017_speed_filter(self):
+        rake = rake_receiver.rake_receiver_cc(
+            4, [0, 10, 20, 30], [1.0, 0.8, 0.6, 0.4], 42
+        )
+        self.assertFalse(rake.speed_filter())
+        rake.set_adaptive_mode(True)
+        rake.set_speed_filter(True)
+        rake.set_adaptation_interval(0.0)
+        self.assertAlmostEqual(rake.adaptation_interval(), 0.0, places=5)
+
+        for _ in range(20):
+            rake.set_gps_speed(60.0)
+        rake.set_gps_speed(120.0)
+        self.assertAlmostEqual(rake.gps_speed(), 120.0, places=5)
+        self.assertLess(rake.filtered_speed(), 100.0)
+
+    def test_018_speed_profile(self):
+        rake = rake_receiver.rake_receiver_cc(
+            4, [0, 10, 20, 30], [1.0, 0.8, 0.6, 0.4], 42
+        )
+        self.assertEqual(
+            list(rake.speed_profile_breakpoints()), [5.0, 15.0, 60.0, 120.0, 200.0]
+        )
+        rake.set_adaptive_mode(True)
+        rake.set_speed_profile(
+            [0.0, 300.0], [10.0, 130.0], [100.0, 400.0], [1.0, 0.2], [2, 4]
+        )
+        rake.set_gps_speed(150.0)
+        self.assertAlmostEqual(rake.path_search_rate(), 70.0, places=3)
+        self.assertEqual(rake.num_fingers(), 4)
+
+        rake.set_speed_hysteresis(10.0)
+        rake.set_gps_speed(145.0)
+        self.assertEqual(rake.num_fingers(), 4)
+
+        with self.assertRaises(ValueError):
+            rake.set_speed_profile([10.0, 5.0], [1.0, 1.0], [1.0, 1.0], [1.0, 1.0], [3, 3])
+
+    def test_019_speed_tags(self):
+        rake = rake_receiver.rake_receiver_cc(
+            4, [0, 10, 20, 30], [1.0, 0.8, 0.6, 0.4], 8
+        )
+        rake.set_adaptive_mode(True)
+
+        tag = gr.tag_t()
+        tag.offset = 300
+        tag.key = pmt.intern("gps_speed")
+        tag.value = pmt.from_double(2.0)
+        src = blocks.vector_source_c([1.0 + 0.0j] * 1000, False, 1, [tag])
+        dst = blocks.vector_sink_c()
+        tb = gr.top_block()
+        tb.connect(src, rake, dst)
+        tb.run()
+
+        adapt = [t for t in dst.tags() if pmt.symbol_to_string(t.key) == "rx_adapt"]
+        self.assertEqual(len(adapt), 1)
+        self.assertEqual(adapt[0].offset, 300)
+        fingers = pmt.dict_ref(adapt[0].value, pmt.intern("num_fingers"), pmt.PMT_NIL)
+        self.assertEqual(pmt.to_long(fingers), 3)
+        self.assertEqual(rake.num_fingers(), 3)
+
+    def test_020_ubx_parsing(self):
+        rake = rake_receiver.rake_receiver_cc(
+            4, [0, 10, 20, 30], [1.0, 0.8, 0.6, 0.4], 42
+        )
+        payload = bytearray(92)
+        payload[20] = 3  # 3D fix
+        payload[21] = 0x01  # gnssFixOK
+        payload[60:64] = struct.pack("<i", 12500)  # ground speed, mm/s
+        body = bytes([0x01, 0x07]) + struct.pack("<H", len(payload)) + bytes(payload)
+        ck_a = ck_b = 0
+        for b in body:
+            ck_a = (ck_a + b) & 0xFF
+            ck_b = (ck_b + ck_a) & 0xFF
+        frame = b"\xb5\x62" + body + bytes([ck_a, ck_b])
+
+        self.assertTrue(rake.parse_ubx(frame))
+        self.assertAlmostEqual(rake.gps_speed(), 45.0, places=1)
+        self.assertFalse(rake.parse_ubx(frame[:-1] + b"\x00"))
+
+    def test_021_gps_message_types(self):
+        meta = pmt.dict_add(pmt.make_dict(), pmt.intern("speed_kmh"), pmt.from_long(20))
+        nmea = b"$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48\r\n"
+        cases = [
+            (pmt.init_u8vector(len(nmea), list(nmea)), 10.2),
+            (pmt.from_double(42.0), 42.0),
+            (pmt.cons(pmt.intern("speed_kmh"), pmt.from_double(30.0)), 30.0),
+            (meta, 20.0),
+            (pmt.cons(meta, pmt.init_u8vector(len(nmea), list(nmea))), 20.0),
+            (pmt.cons(pmt.make_dict(), pmt.init_u8vector(len(nmea), list(nmea))), 10.2),
+            (pmt.init_f32vector(3, [50.0, -1.0, 55.0]), 55.0),
+            (pmt.init_f32vector(2, [50.0, float("inf")]), 50.0),
+            (pmt.from_double(float("inf")), -1.0),
+            (pmt.cons(pmt.intern("speed_kmh"), pmt.from_double(1e300)), -1.0),
+            (pmt.make_tuple(pmt.from_double(80.0)), -1.0),
+        ]
+        for msg, expected in cases:
+            rake = rake_receiver.rake_receiver_cc(
+                4, [0, 10, 20, 30], [1.0, 0.8, 0.6, 0.4], 8
+            )
+            tb = gr.top_block()
+            tb.connect(
+                blocks.null_source(gr.sizeof_gr_complex),
+                rake,
+                blocks.null_sink(gr.sizeof_gr_complex),
+            )
+            rake.to_basic_block()._post(pmt.intern("gps"), msg)
+            tb.start()
+            time.sleep(0.1)
+            tb.stop()
+            tb.wait()
+            self.assertAlmostEqual(rake.gps_speed(), expected, places=3)
+
+    def test_022_delay_cache(self):
+        rake = rake_receiver.rake_receiver_cc(3, [0, 4, 9], [1.0, 0.5, 0.25], 8)
+        rake.set_delay_cache(True)
+        rake.set_position(48.1173, 11.5167)
+        rake.set_position(48.1263, 11.5167)
+        rake.set_delays([0, 2, 17])
+        rake.set_position(48.1173, 11.5167)
+        self.assertEqual(list(rake.delays()), [0, 4, 9])
+        self.assertEqual(rake.delay_cache_size(), 2)
+
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "delays.bin")
+            rake.save_delay_cache(path)
+            restarted = rake_receiver.rake_receiver_cc(3, [0, 4, 9], [1.0, 0.5, 0.25], 8)
+            restarted.set_delay_cache(True)
+            self.assertEqual(restarted.load_delay_cache(path), 2)
+        restarted.set_position(48.1263, 11.5167)
+        self.assertEqual(list(restarted.delays()), [0, 2, 17])
+
+    def test_023_doppler_speed(self):
+        # Clarke-model fading at 100 km/h on a 1 GHz carrier
+        sample_rate = 100e3
+        fd = 100.0 / 3.6 * 1e9 / 299792458.0
+        rays = 64
+        n = np.arange(int(2 * sample_rate))
+        angles = 2 * np.pi * (np.arange(rays) + 0.37) / rays
+        phases = 2 * np.pi * np.random.default_rng(7).random(rays)
+        fading = np.zeros(len(n), dtype=np.complex64)
+        for angle, phase in zip(angles, phases):
+            w = 2 * np.pi * fd * np.cos(angle) / sample_rate
+            fading += np.exp(1j * (w * n + phase)).astype(np.complex64)
+        fading /= np.sqrt(rays)
+
+        rake = rake_receiver.rake_receiver_cc(2, [0, 3], [1.0, 0.2], 1)
+        rake.set_sample_rate(sample_rate)
+        rake.set_carrier_frequency(1e9)
+        rake.set_doppler_decimation(50)
+        rake.set_doppler_estimation(True)
+        src = blocks.vector_source_c(fading.tolist(), False)
+        dst = blocks.vector_sink_c()
+        self.tb.connect(src, rake, dst)
+        self.tb.run()
+
+        self.assertAlmostEqual(rake.doppler_spread() / fd, 1.0, delta=0.15)
+        self.assertAlmostEqual(rake.doppler_speed() / 100.0, 1.0, delta=0.15)
+
+    def test_024_state_file(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "rake.state")
+            rake = rake_receiver.rake_receiver_cc(3, [0, 4, 9], [1.0, 0.5, 0.25], 8)
+            rake.set_state_file(path)
+            rake.set_delays([0, 6, 13])
+            rake.set_gains([0.9, 0.6, 0.2])
+            src = blocks.vector_source_c([1 + 0j] * 1000, False)
+            dst = blocks.vector_sink_c()
+            self.tb.connect(src, rake, dst)
+            self.tb.run()
+            self.assertTrue(os.path.exists(path))
+
+            restarted = rake_receiver.rake_receiver_cc(3, [0, 4, 9], [1.0, 0.5, 0.25], 8)
+            restarted.set_state_file(path)
+            self.assertEqual(list(restarted.delays()), [0, 6, 13])
+            self.assertAlmostEqual(restarted.gains()[1], 0.6, places=6)
+
+            other = rake_receiver.rake_receiver_cc(2, [0, 4], [1.0, 0.5], 8)
+            with self.assertRaises(ValueError):
+                other.load_state(path)
+
+    def test_025_ring_delay_line(self):
+        n = np.arange(10000)
+        data = (np.exp(1j * 0.3 * n) * (1 + 0.1 * (n % 3))).astype(np.complex64)
+        outputs = []
+        for mode in ("history", "ring"):
+            rake = rake_receiver.rake_receiver_cc(3, [0, 7, 30], [1.0, 0.5, 0.25], 8)
+            if mode == "ring":
+                rake.set_delay_line_mode("ring", 30)
+                self.assertEqual(rake.history(), 1)
+            tb = gr.top_block()
+            dst = blocks.vector_sink_c()
+            tb.connect(blocks.vector_source_c(data.tolist(), False), rake, dst)
+            tb.run()
+            outputs.append(np.array(dst.data()))
+        np.testing.assert_allclose(outputs[1], outputs[0], rtol=1e-5, atol=1e-4)
+
+        rake = rake_receiver.rake_receiver_cc(3, [0, 7, 30], [1.0, 0.5, 0.25], 8)
+        rake.set_delay_line_mode("ring", 100)
+        rake.set_delays([0, 50, 100])
+        self.assertEqual(rake.max_delay(), 100)
+        with self.assertRaises(ValueError):
+            rake.set_delays([0, 50, 101])
+
+    def test_026_sparse_delay_line(self):
+        n = np.arange(10000)
+        data = (np.exp(1j * 0.3 * n) * (1 + 0.1 * (n % 3))).astype(np.complex64)
+        outputs = []
+        for mode in ("ring", "sparse"):
+            rake = rake_receiver.rake_receiver_cc(3, [0, 7, 30], [1.0, 0.5, 0.25], 8)
+            rake.set_delay_line_mode(mode, 3000)
+            rake.set_delays([0, 700, 3000])
+            self.assertEqual(rake.delay_line_mode(), mode)
+            tb = gr.top_block()
+            dst = blocks.vector_sink_c()
+            tb.connect(blocks.vector_source_c(data.tolist(), False), rake, dst)
+            tb.run()
+            outputs.append(np.array(dst.data()))
+        np.testing.assert_allclose(outputs[1], outputs[0], rtol=1e-5, atol=1e-4)
+
+    def test_027_finger_tags(self):
+        rake = rake_receiver.rake_receiver_cc(
+            4, [0, 10, 20, 30], [1.0, 0.8, 0.6, 0.4], 8
+        )
+        self.assertEqual(rake.kernel(), "volk")
+        rake.set_kernel("scalar")
+        with self.assertRaises(ValueError):
+            rake.set_kernel("fft")
+
+        delays = gr.tag_t()
+        delays.offset = 300
+        delays.key = pmt.intern("rake_delays")
+        delays.value = pmt.init_s32vector(4, [5, 15, 25, 30])
+        gains = gr.tag_t()
+        gains.offset = 500
+        gains.key = pmt.intern("rake_gains")
+        gains.value = pmt.init_f32vector(4, [0.0, 0.0, 0.0, 1.0])
+        src = blocks.vector_source_c([1.0 + 0.0j] * 1000, False, 1, [delays, gains])
+        dst = blocks.vector_sink_c()
+        tb = gr.top_block()
+        tb.connect(src, rake, dst)
+        tb.run()
+
+        out = np.array(dst.data())
+        # A constant input correlates to pattern_length * sum(gains)
+        self.assertAlmostEqual(out[400].real, 8 * 2.8, places=4)
+        self.assertAlmostEqual(out[600].real, 8 * 1.0, places=4)
+        self.assertEqual(list(rake.delays()), [5, 15, 25, 30])
+
+    def test_028_counters(self):
+        rake = rake_receiver.rake_receiver_cc(
+            4, [0, 10, 20, 30], [1.0, 0.8, 0.6, 0.4], 8
+        )
+        src = blocks.vector_source_c([1.0 + 0.0j] * 4096, False)
+        dst = blocks.vector_sink_c()
+        tb = gr.top_block()
+        tb.connect(src, rake, dst)
+        tb.run()
+
+        self.assertEqual(rake.items_processed(), 4096)
+        self.assertGreater(rake.work_calls(), 0)
+        self.assertGreater(rake.work_time(), 0.0)
+        for energy in rake.finger_energy():
+            self.assertAlmostEqual(energy / 64.0, 1.0, delta=0.02)
+
+        self.assertFalse(rake.parse_nmea0183("$GPRMC,123519,V,,,,,,,230394,,*00"))
+        self.assertEqual(rake.gps_fixes_rejected(), 1)
+        rake.reset_counters()
+        self.assertEqual(rake.items_processed(), 0)
+        self.assertEqual(rake.gps_fixes_rejected(), 0)
+
+    def test_029_stats_messages(self):
+        rake = rake_receiver.rake_receiver_cc(2, [0, 10], [1.0, 0.5], 8)
+        rake.set_sample_rate(1000.0)
+        rake.set_stats_interval(1.0)
+        src = blocks.vector_source_c([1.0 + 0.0j] * 4096, False)
+        dst = blocks.vector_sink_c()
+        debug = blocks.message_debug()
+        tb = gr.top_block()
+        tb.connect(src, rake, dst)
+        tb.msg_connect(rake, "stats", debug, "store")
+        tb.run()
+
+        self.assertGreaterEqual(debug.num_messages(), 1)
+        stats = pmt.to_python(debug.get_message(0))
+        self.assertEqual(stats["num_fingers"], 2)
+        self.assertEqual(list(stats["delays"]), [0, 10])
+        self.assertEqual(stats["speed_category"], "none")
+        for snr in stats["snr_db"]:
+            self.assertGreater(snr, 30.0)
+        self.assertTrue(all(stats["locked"]))
+
+    def test_030_latency_probe(self):
+        rake = rake_receiver.rake_receiver_cc(3, [0, 10, 20], [1.0, 0.5, 0.25], 16)
+        self.assertEqual(rake.group_delay(), 36)
+        rake.set_latency_probe(True, 100)
+        rake.set_sample_rate(1000.0)
+        rake.set_stats_interval(0.001)
+        src = blocks.vector_source_c([0.0j] * 400, False)
+        dst = blocks.vector_sink_c()
+        debug = blocks.message_debug()
+        tb = gr.top_block()
+        tb.connect(src, rake, dst)
+        tb.msg_connect(rake, "stats", debug, "store")
+        tb.run()
+
+        probes = [t for t in dst.tags() if pmt.symbol_to_string(t.key) == "latency_probe"]
+        self.assertEqual(len(probes), 4)
+        count = 0
+        for i in range(debug.num_messages()):
+            stats = pmt.to_python(debug.get_message(i))
+            count += stats["latency_count"]
+            self.assertLessEqual(stats["latency_p50_us"], stats["latency_max_us"])
+        self.assertEqual(count, 4)
+
+        rake.set_delay_line_mode("ring", 100)
+        self.assertEqual(rake.group_delay(), 116)
+
+    def test_031_kernel_autotune(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            profile = os.path.join(tmp, "kernels")
+            rake = rake_receiver.rake_receiver_cc(3, [0, 10, 20], [1.0, 0.5, 0.25], 32)
+            rake.set_kernel_profile(profile)
+            self.assertEqual(rake.kernel_profile(), profile)
+            rake.set_kernel("auto")
+            self.assertTrue(rake.kernel_autotune())
+            tb = gr.top_block()
+            tb.connect(
+                blocks.vector_source_c([1.0 + 0.0j] * 500, False),
+                rake,
+                blocks.null_sink(gr.sizeof_gr_complex),
+            )
+            tb.run()
+            self.assertIn(rake.kernel(), ("scalar", "volk"))
+
+            with open(profile) as f:
+                lines = f.read().splitlines()
+            entries = [l for l in lines if l and not l.startswith("#")]
+            self.assertEqual(len(entries), 1)
+            self.assertEqual(
+                entries[0].split("\t")[1:], ["combine", "3", "32", "32", rake.kernel()]
+            )
+
+            rake.set_kernel("scalar")
+            self.assertFalse(rake.kernel_autotune())
+
 
 if __name__ == "__main__":
     gr_unittest.run(qa_rake_receiver_cc)